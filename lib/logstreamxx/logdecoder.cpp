@@ -0,0 +1,428 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logdecoder.h"
+#include "logrecorder.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+
+namespace logstreamxx {
+
+	/** decoded log entry argument */
+	struct logarg {
+		char tag;
+		int64_t i;
+		uint64_t u;
+		double f;
+		std::string s;
+	};
+
+
+	// append a single formatted value
+	template <typename T>
+	static void append( std::string &out, const std::string &spec, T v ) {
+
+		char buffer[128];
+		int n = snprintf( buffer, sizeof( buffer ), spec.c_str(), v );
+
+		if ( n < 0 ) {
+			return;
+		}
+
+		if ( n < (int) sizeof( buffer ) ) {
+			out.append( buffer, n );
+		} else {
+			std::vector<char> large( n + 1 );
+			snprintf( &large[0], large.size(), spec.c_str(), v );
+			out.append( &large[0], n );
+		}
+
+	}
+
+
+	// argument value helpers
+	static long long to_signed( const logarg &a ) {
+
+		switch ( a.tag ) {
+			case logargs::t_unsigned:
+			case logargs::t_pointer:
+				return a.u;
+			case logargs::t_double:
+				return (long long) a.f;
+			default:
+				return a.i;
+		}
+
+	}
+
+
+	static double to_double( const logarg &a ) {
+
+		switch ( a.tag ) {
+			case logargs::t_double:
+				return a.f;
+			case logargs::t_unsigned:
+			case logargs::t_pointer:
+				return (double) a.u;
+			default:
+				return (double) a.i;
+		}
+
+	}
+
+
+	// default rendering of an argument as text
+	static void to_string( std::string &out, const logarg &a ) {
+
+		switch ( a.tag ) {
+			case logargs::t_string:
+				out += a.s;
+				break;
+			case logargs::t_char:
+				out += (char) a.i;
+				break;
+			case logargs::t_double:
+				append( out, "%g", a.f );
+				break;
+			case logargs::t_pointer:
+				append( out, "%p", (void *) (uintptr_t) a.u );
+				break;
+			case logargs::t_unsigned:
+				append( out, "%llu", (unsigned long long) a.u );
+				break;
+			default:
+				append( out, "%lld", (long long) a.i );
+				break;
+		}
+
+	}
+
+
+	logdecoder::logdecoder() throw() : _session( false ) {
+
+	}
+
+
+	size_t logdecoder::decode( const char * data, size_t n, std::string &out ) throw( logexception ) {
+
+		size_t consumed = 0;
+
+		while ( ( n - consumed ) >= 3 ) {
+
+			const char * record = data + consumed;
+			uint16_t size;
+			memcpy( &size, record, 2 );
+
+			// sanity checks
+			if ( size < 3 ) {
+				throw logexception( "Invalid binary log record" );
+			}
+
+			// sanity check - records must start with a session
+			if ( (! _session ) && ( ( record[2] != logrecorder::r_session ) ||
+					( size != ( 3 + sizeof( logrecorder::magic ) ) ) ) ) {
+				throw logexception( "Not a binary log" );
+			}
+
+			if ( size > ( n - consumed ) ) {
+				break;
+			}
+
+			const char * payload = record + 3;
+			size_t payload_n = size - 3;
+
+			switch ( record[2] ) {
+
+				case logrecorder::r_session:
+
+					if ( ( payload_n != sizeof( logrecorder::magic ) ) ||
+							( memcmp( payload, logrecorder::magic, payload_n ) != 0 ) ) {
+						throw logexception( "Invalid binary log session" );
+					}
+
+					// new session
+					_sites.clear();
+					_prefix.clear();
+					_session = true;
+					break;
+
+				case logrecorder::r_site:
+					{
+						if ( payload_n < 4 ) {
+							throw logexception( "Invalid binary log site definition" );
+						}
+
+						uint32_t id;
+						memcpy( &id, payload, 4 );
+
+						_sites[id] = std::string( payload + 4, payload_n - 4 );
+					}
+					break;
+
+				case logrecorder::r_prefix:
+					_prefix.assign( payload, payload_n );
+					break;
+
+				case logrecorder::r_entry:
+					entry( record, size, out );
+					break;
+
+				default:
+					throw logexception( "Unknown binary log record" );
+
+			}
+
+			consumed += size;
+
+		}
+
+		return consumed;
+
+	}
+
+
+	void logdecoder::entry( const char * data, size_t n, std::string &out ) throw( logexception ) {
+
+		// sanity check
+		if ( n < logargs::header_size ) {
+			throw logexception( "Invalid binary log entry" );
+		}
+
+		uint32_t id;
+		int64_t  sec;
+		uint32_t usec;
+
+		memcpy( &id, data + 3, 4 );
+		memcpy( &sec, data + 7, 8 );
+		memcpy( &usec, data + 15, 4 );
+		priority::log_priority_t p = (priority::log_priority_t) ( data[19] & 7 );
+		size_t count = (unsigned char) data[20];
+
+		// log site
+		std::map<uint32_t, std::string>::const_iterator it = _sites.find( id );
+		if ( it == _sites.end() ) {
+			throw logexception( "Undefined binary log site" );
+		}
+
+		// decode arguments
+		std::vector<logarg> args( count );
+		size_t pos = logargs::header_size;
+
+		for ( size_t i = 0; i < count; i++ ) {
+
+			if ( pos >= n ) {
+				throw logexception( "Invalid binary log entry" );
+			}
+
+			logarg &a = args[i];
+			a.tag = data[pos++];
+			a.i = 0;
+			a.u = 0;
+			a.f = 0;
+
+			switch ( a.tag ) {
+
+				case logargs::t_signed:
+				case logargs::t_unsigned:
+				case logargs::t_pointer:
+				case logargs::t_double:
+
+					if ( ( pos + 8 ) > n ) {
+						throw logexception( "Invalid binary log entry" );
+					}
+
+					memcpy( &a.u, data + pos, 8 );
+					memcpy( &a.i, data + pos, 8 );
+					memcpy( &a.f, data + pos, 8 );
+					pos += 8;
+					break;
+
+				case logargs::t_char:
+
+					if ( ( pos + 1 ) > n ) {
+						throw logexception( "Invalid binary log entry" );
+					}
+
+					a.i = data[pos++];
+					break;
+
+				case logargs::t_string:
+					{
+						uint16_t len;
+
+						if ( ( pos + 2 ) > n ) {
+							throw logexception( "Invalid binary log entry" );
+						}
+
+						memcpy( &len, data + pos, 2 );
+						pos += 2;
+
+						if ( ( pos + len ) > n ) {
+							throw logexception( "Invalid binary log entry" );
+						}
+
+						a.s.assign( data + pos, len );
+						pos += len;
+					}
+					break;
+
+				default:
+					throw logexception( "Invalid binary log argument" );
+
+			}
+
+		}
+
+		// log line prefix ( "%b %e %T.usec [PRIO] prefix " )
+		char stamp[logstamp::size];
+		timeval tv;
+		tv.tv_sec  = sec;
+		tv.tv_usec = usec;
+
+		out.append( stamp, _stamp.format( stamp, tv ) );
+		out += " [";
+		out += priority::text( p );
+		out += "] ";
+
+		if ( _prefix.length() > 0 ) {
+			out += _prefix;
+			out += ' ';
+		}
+
+		// render the format string
+		const std::string &format = it->second;
+		size_t next = 0;
+
+		for ( size_t i = 0; i < format.length(); i++ ) {
+
+			if ( format[i] != '%' ) {
+				out += format[i];
+				continue;
+			}
+
+			// check - escaped '%'?
+			if ( ( i + 1 < format.length() ) && ( format[i + 1] == '%' ) ) {
+				out += '%';
+				i++;
+				continue;
+			}
+
+			// parse the conversion specification
+			size_t start = i++;
+			std::string spec = "%";
+
+			while ( ( i < format.length() ) && strchr( "-+ #0'", format[i] ) ) {
+				spec += format[i++];
+			}
+
+			// width and precision ( '*' takes an argument )
+			for ( int part = 0; part < 2; part++ ) {
+
+				if ( part == 1 ) {
+					if ( ( i < format.length() ) && ( format[i] == '.' ) ) {
+						spec += format[i++];
+					} else {
+						break;
+					}
+				}
+
+				if ( ( i < format.length() ) && ( format[i] == '*' ) ) {
+					i++;
+					append( spec, "%lld", ( next < count ) ? to_signed( args[next++] ) : 0 );
+				} else {
+					while ( ( i < format.length() ) && ( format[i] >= '0' ) && ( format[i] <= '9' ) ) {
+						spec += format[i++];
+					}
+				}
+
+			}
+
+			// length modifiers are implied by the argument types
+			while ( ( i < format.length() ) && strchr( "hlLqjzt", format[i] ) ) {
+				i++;
+			}
+
+			// check - incomplete specification or no more arguments?
+			if ( ( i >= format.length() ) || ( next >= count ) ) {
+				out.append( format, start, i - start + 1 );
+				continue;
+			}
+
+			const logarg &a = args[next++];
+
+			switch ( format[i] ) {
+
+				case 'd':
+				case 'i':
+					append( out, spec + "lld", to_signed( a ) );
+					break;
+
+				case 'u':
+				case 'o':
+				case 'x':
+				case 'X':
+					append( out, spec + "ll" + format[i], (unsigned long long) to_signed( a ) );
+					break;
+
+				case 'e':
+				case 'E':
+				case 'f':
+				case 'F':
+				case 'g':
+				case 'G':
+				case 'a':
+				case 'A':
+					append( out, spec + format[i], to_double( a ) );
+					break;
+
+				case 'c':
+					append( out, spec + 'c', (int) to_signed( a ) );
+					break;
+
+				case 'p':
+					append( out, spec + 'p', (void *) (uintptr_t) a.u );
+					break;
+
+				case 's':
+					{
+						std::string s;
+						to_string( s, a );
+						append( out, spec + 's', s.c_str() );
+					}
+					break;
+
+				default:
+					// unknown conversion, output as is
+					out.append( format, start, i - start + 1 );
+					next--;
+					break;
+
+			}
+
+		}
+
+		out += '\n';
+
+	}
+
+} /* end of namespace logstreamxx */
+
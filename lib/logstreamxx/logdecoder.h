@@ -0,0 +1,90 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTREAMXX_LOGDECODER_H
+#define LOGSTREAMXX_LOGDECODER_H
+
+#include <logstreamxx/priority.h>
+#include <logstreamxx/logexception.h>
+#include <logstreamxx/logstamp.h>
+
+#include <map>
+#include <string>
+#include <stdint.h>
+
+
+namespace logstreamxx {
+
+	/**
+	*   @brief Binary log decoder class
+	*
+	*   Renders binary records written by a logrecorder into text log
+	*   lines, in the same format as written out by logstreambuf
+	*   ( @c "%b %e %T.usec [PRIO] prefix message" ).
+	*
+	*/
+	class logdecoder {
+	public:
+
+		/**
+		*   @brief constructor
+		*/
+		logdecoder() throw();
+
+		/**
+		*   @brief decode binary records
+		*   @param data binary records
+		*   @param n number of characters pointed by @c data
+		*   @param out output string to append rendered log lines to
+		*   @return number of characters consumed
+		*
+		*   Decode all the complete binary records in @c data and append
+		*   the rendered log lines to @c out. A trailing partial record is
+		*   not consumed and should be passed in again with more data.
+		*
+		*   @note This will throw a logexception if the data is not
+		*         a valid binary log.
+		*
+		*/
+		size_t decode( const char * data, size_t n, std::string &out ) throw( logexception );
+
+
+	private:
+
+		/** log site definitions */
+		std::map<uint32_t, std::string> _sites;
+
+		/** current log prefix */
+		std::string _prefix;
+
+		/** log timestamp formatter */
+		logstamp _stamp;
+
+		/** flag to indicate a session start was seen */
+		bool _session;
+
+		/** render a log entry */
+		void entry( const char * data, size_t n, std::string &out ) throw( logexception );
+
+	};
+
+} /* end of namespace logstreamxx */
+
+#endif /* !LOGSTREAMXX_LOGDECODER_H */
+
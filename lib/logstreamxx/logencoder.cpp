@@ -0,0 +1,546 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logencoder.h"
+#include "lognumput.h"
+
+#include <cmath>
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define LOGENCODER_X86 1
+#include <immintrin.h>
+#endif
+
+
+namespace logstreamxx {
+
+	namespace {
+
+		/** hexadecimal digits */
+		const char hex[] = "0123456789abcdef";
+
+		/** escape table, 0 for characters copied as is, the escape
+		    character for short escapes or 'u' for @c "\u00XX" escapes */
+		const char escapes[256] = {
+			'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+			'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+			0,   0,   '"', 0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+			0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+			0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+			0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   '\\', 0,  0,   0,
+			0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+			0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   'u'
+		};
+
+		/** scanning kernel, returns the offset of the first match or @c n */
+		typedef size_t (*kernel_t)( const char * data, size_t n );
+
+
+		/** first character which isn't copied as is, byte at a time */
+		size_t scan_scalar( const char * data, size_t n ) {
+
+			for ( size_t i = 0; i < n; i++ ) {
+
+				unsigned char c = data[i];
+
+				if ( ( escapes[c] != 0 ) || ( c >= 0x80 ) ) {
+					return i;
+				}
+
+			}
+
+			return n;
+
+		}
+
+
+		/** first non-ASCII byte, byte at a time */
+		size_t ascii_scalar( const char * data, size_t n ) {
+
+			for ( size_t i = 0; i < n; i++ ) {
+				if ( (unsigned char) data[i] >= 0x80 ) {
+					return i;
+				}
+			}
+
+			return n;
+
+		}
+
+
+#ifdef LOGENCODER_X86
+		/** first character which isn't copied as is, 16 bytes at a time */
+		__attribute__(( target( "sse2" ) ))
+		size_t scan_sse2( const char * data, size_t n ) {
+
+			const __m128i space  = _mm_set1_epi8( 0x20 );
+			const __m128i quote  = _mm_set1_epi8( '"' );
+			const __m128i bslash = _mm_set1_epi8( '\\' );
+			const __m128i del    = _mm_set1_epi8( 0x7f );
+
+			size_t i = 0;
+
+			for ( ; ( i + 16 ) <= n; i += 16 ) {
+
+				__m128i v = _mm_loadu_si128( (const __m128i *) ( data + i ) );
+
+				// signed compare, bytes >= 0x80 are less than 0x20 as well
+				__m128i m = _mm_or_si128(
+						_mm_or_si128( _mm_cmplt_epi8( v, space ), _mm_cmpeq_epi8( v, quote ) ),
+						_mm_or_si128( _mm_cmpeq_epi8( v, bslash ), _mm_cmpeq_epi8( v, del ) ) );
+
+				int mask = _mm_movemask_epi8( m );
+				if ( mask != 0 ) {
+					return i + __builtin_ctz( mask );
+				}
+
+			}
+
+			// sanity check - anything left?
+			if ( i == n ) {
+				return n;
+			}
+
+			if ( n < 16 ) {
+				return scan_scalar( data, n );
+			}
+
+			// overlapping load for the tail, ignoring the bytes already checked
+			__m128i v = _mm_loadu_si128( (const __m128i *) ( data + n - 16 ) );
+			__m128i m = _mm_or_si128(
+					_mm_or_si128( _mm_cmplt_epi8( v, space ), _mm_cmpeq_epi8( v, quote ) ),
+					_mm_or_si128( _mm_cmpeq_epi8( v, bslash ), _mm_cmpeq_epi8( v, del ) ) );
+
+			int mask = _mm_movemask_epi8( m ) >> ( i - ( n - 16 ) );
+			if ( mask != 0 ) {
+				return i + __builtin_ctz( mask );
+			}
+
+			return n;
+
+		}
+
+
+		/** first non-ASCII byte, 16 bytes at a time */
+		__attribute__(( target( "sse2" ) ))
+		size_t ascii_sse2( const char * data, size_t n ) {
+
+			size_t i = 0;
+
+			for ( ; ( i + 16 ) <= n; i += 16 ) {
+
+				int mask = _mm_movemask_epi8( _mm_loadu_si128( (const __m128i *) ( data + i ) ) );
+				if ( mask != 0 ) {
+					return i + __builtin_ctz( mask );
+				}
+
+			}
+
+			// sanity check - anything left?
+			if ( i == n ) {
+				return n;
+			}
+
+			if ( n < 16 ) {
+				return ascii_scalar( data, n );
+			}
+
+			// overlapping load for the tail, ignoring the bytes already checked
+			int mask = _mm_movemask_epi8( _mm_loadu_si128( (const __m128i *) ( data + n - 16 ) ) ) >> ( i - ( n - 16 ) );
+			if ( mask != 0 ) {
+				return i + __builtin_ctz( mask );
+			}
+
+			return n;
+
+		}
+
+
+		/** first character which isn't copied as is, 32 bytes at a time */
+		__attribute__(( target( "avx2" ) ))
+		size_t scan_avx2( const char * data, size_t n ) {
+
+			const __m256i space  = _mm256_set1_epi8( 0x20 );
+			const __m256i quote  = _mm256_set1_epi8( '"' );
+			const __m256i bslash = _mm256_set1_epi8( '\\' );
+			const __m256i del    = _mm256_set1_epi8( 0x7f );
+
+			size_t i = 0;
+
+			for ( ; ( i + 32 ) <= n; i += 32 ) {
+
+				__m256i v = _mm256_loadu_si256( (const __m256i *) ( data + i ) );
+
+				// signed compare, bytes >= 0x80 are less than 0x20 as well
+				__m256i m = _mm256_or_si256(
+						_mm256_or_si256( _mm256_cmpgt_epi8( space, v ), _mm256_cmpeq_epi8( v, quote ) ),
+						_mm256_or_si256( _mm256_cmpeq_epi8( v, bslash ), _mm256_cmpeq_epi8( v, del ) ) );
+
+				unsigned int mask = _mm256_movemask_epi8( m );
+				if ( mask != 0 ) {
+					return i + __builtin_ctz( mask );
+				}
+
+			}
+
+			// sanity check - anything left?
+			if ( i == n ) {
+				return n;
+			}
+
+			if ( n < 32 ) {
+				return scan_sse2( data, n );
+			}
+
+			// overlapping load for the tail, ignoring the bytes already checked
+			__m256i v = _mm256_loadu_si256( (const __m256i *) ( data + n - 32 ) );
+			__m256i m = _mm256_or_si256(
+					_mm256_or_si256( _mm256_cmpgt_epi8( space, v ), _mm256_cmpeq_epi8( v, quote ) ),
+					_mm256_or_si256( _mm256_cmpeq_epi8( v, bslash ), _mm256_cmpeq_epi8( v, del ) ) );
+
+			unsigned int mask = (unsigned int) _mm256_movemask_epi8( m ) >> ( i - ( n - 32 ) );
+			if ( mask != 0 ) {
+				return i + __builtin_ctz( mask );
+			}
+
+			return n;
+
+		}
+
+
+		/** first non-ASCII byte, 32 bytes at a time */
+		__attribute__(( target( "avx2" ) ))
+		size_t ascii_avx2( const char * data, size_t n ) {
+
+			size_t i = 0;
+
+			for ( ; ( i + 32 ) <= n; i += 32 ) {
+
+				unsigned int mask = _mm256_movemask_epi8( _mm256_loadu_si256( (const __m256i *) ( data + i ) ) );
+				if ( mask != 0 ) {
+					return i + __builtin_ctz( mask );
+				}
+
+			}
+
+			// sanity check - anything left?
+			if ( i == n ) {
+				return n;
+			}
+
+			if ( n < 32 ) {
+				return ascii_sse2( data, n );
+			}
+
+			// overlapping load for the tail, ignoring the bytes already checked
+			unsigned int mask = (unsigned int) _mm256_movemask_epi8(
+					_mm256_loadu_si256( (const __m256i *) ( data + n - 32 ) ) ) >> ( i - ( n - 32 ) );
+			if ( mask != 0 ) {
+				return i + __builtin_ctz( mask );
+			}
+
+			return n;
+
+		}
+#endif /* LOGENCODER_X86 */
+
+
+		/** scanning kernels, indexed by logencoder::isa_t */
+		const kernel_t scan_kernels[] = {
+#ifdef LOGENCODER_X86
+			scan_scalar, scan_sse2, scan_avx2
+#else
+			scan_scalar, scan_scalar, scan_scalar
+#endif
+		};
+
+		const kernel_t ascii_kernels[] = {
+#ifdef LOGENCODER_X86
+			ascii_scalar, ascii_sse2, ascii_avx2
+#else
+			ascii_scalar, ascii_scalar, ascii_scalar
+#endif
+		};
+
+
+		/** length of the valid UTF-8 sequence at @c data, @c 0 if invalid */
+		size_t sequence( const char * data, size_t n ) {
+
+			const unsigned char * p = (const unsigned char *) data;
+
+			// second byte range, depends on the lead byte
+			unsigned char lo = 0x80;
+			unsigned char hi = 0xbf;
+			size_t len;
+
+			if ( p[0] < 0x80 ) {
+				return 1;
+			} else if ( ( p[0] >= 0xc2 ) && ( p[0] <= 0xdf ) ) {
+				len = 2;
+			} else if ( ( p[0] >= 0xe0 ) && ( p[0] <= 0xef ) ) {
+				len = 3;
+				if ( p[0] == 0xe0 ) {
+					lo = 0xa0;      // overlong
+				} else if ( p[0] == 0xed ) {
+					hi = 0x9f;      // surrogates
+				}
+			} else if ( ( p[0] >= 0xf0 ) && ( p[0] <= 0xf4 ) ) {
+				len = 4;
+				if ( p[0] == 0xf0 ) {
+					lo = 0x90;      // overlong
+				} else if ( p[0] == 0xf4 ) {
+					hi = 0x8f;      // above U+10FFFF
+				}
+			} else {
+				return 0;
+			}
+
+			// sanity check
+			if ( n < len ) {
+				return 0;
+			}
+
+			if ( ( p[1] < lo ) || ( p[1] > hi ) ) {
+				return 0;
+			}
+
+			for ( size_t i = 2; i < len; i++ ) {
+				if ( ( p[i] & 0xc0 ) != 0x80 ) {
+					return 0;
+				}
+			}
+
+			return len;
+
+		}
+
+	} /* end of anonymous namespace */
+
+
+	logencoder::isa_t logencoder::isa() throw() {
+
+		static int detected = -1;
+		int d = __atomic_load_n( &detected, __ATOMIC_RELAXED );
+
+		// check - already detected?
+		if ( d >= 0 ) {
+			return (isa_t) d;
+		}
+
+		d = scalar;
+
+#ifdef LOGENCODER_X86
+		__builtin_cpu_init();
+
+		if ( __builtin_cpu_supports( "avx2" ) ) {
+			d = avx2;
+		} else if ( __builtin_cpu_supports( "sse2" ) ) {
+			d = sse2;
+		}
+#endif
+
+		__atomic_store_n( &detected, d, __ATOMIC_RELAXED );
+
+		return (isa_t) d;
+
+	}
+
+
+	size_t logencoder::scan( const char * data, size_t n, const isa_t &isa ) throw() {
+
+		isa_t best = logencoder::isa();
+		return scan_kernels[( isa < best ) ? isa : best]( data, n );
+
+	}
+
+
+	size_t logencoder::utf8( const char * data, size_t n, const isa_t &isa ) throw() {
+
+		isa_t best = logencoder::isa();
+		kernel_t ascii = ascii_kernels[( isa < best ) ? isa : best];
+
+		size_t i = 0;
+
+		// skip ASCII runs in bulk, validate multi-byte sequences one at a time
+		while ( ( i += ascii( data + i, n - i ) ) < n ) {
+
+			size_t len = sequence( data + i, n - i );
+			if ( len == 0 ) {
+				return i;
+			}
+
+			i += len;
+
+		}
+
+		return n;
+
+	}
+
+
+	size_t logencoder::utf8( const char * data, size_t n ) throw() {
+		return utf8( data, n, isa() );
+	}
+
+
+	size_t logencoder::incomplete( const char * data, size_t n ) throw() {
+
+		for ( size_t k = 1; ( k <= 3 ) && ( k <= n ); k++ ) {
+
+			unsigned char c = data[n - k];
+
+			// continuation byte, keep looking for the lead byte
+			if ( ( c & 0xc0 ) == 0x80 ) {
+				continue;
+			}
+
+			// check - lead byte of a sequence longer than what we have?
+			if ( c >= 0xc0 ) {
+
+				size_t len = ( c >= 0xf0 ) ? 4 : ( ( c >= 0xe0 ) ? 3 : 2 );
+				if ( len > k ) {
+					return k;
+				}
+
+			}
+
+			return 0;
+
+		}
+
+		return 0;
+
+	}
+
+
+	void logencoder::escape( std::string &out, const char * data, size_t n ) throw() {
+
+		kernel_t scan = scan_kernels[isa()];
+
+		size_t start = 0;
+		size_t i = 0;
+
+		// copy runs of characters which don't need escaping at once
+		while ( ( i += scan( data + i, n - i ) ) < n ) {
+
+			// check - multi-byte UTF-8 sequence?
+			if ( (unsigned char) data[i] >= 0x80 ) {
+
+				size_t len = sequence( data + i, n - i );
+				if ( len > 0 ) {
+					i += len;
+					continue;
+				}
+
+				// invalid UTF-8, replace the byte
+				out.append( data + start, i - start );
+				out.append( "\\ufffd", 6 );
+				start = ++i;
+
+				continue;
+
+			}
+
+			char e = escapes[(unsigned char) data[i]];
+
+			// copy the run of characters so far
+			out.append( data + start, i - start );
+			start = i + 1;
+
+			char buffer[6] = { '\\', e, '0', '0', 0, 0 };
+
+			if ( e == 'u' ) {
+				buffer[4] = hex[(unsigned char) data[i] >> 4];
+				buffer[5] = hex[(unsigned char) data[i] & 0xf];
+				out.append( buffer, 6 );
+			} else {
+				out.append( buffer, 2 );
+			}
+
+			i++;
+
+		}
+
+		out.append( data + start, n - start );
+
+	}
+
+
+	bool logencoder::quote( const char * data, size_t n ) throw() {
+
+		// sanity check
+		if ( n == 0 ) {
+			return true;
+		}
+
+		for ( size_t i = 0; i < n; i++ ) {
+
+			unsigned char c = data[i];
+
+			if ( ( c <= ' ' ) || ( c == '=' ) || ( c == '"' ) || ( c == '\\' ) || ( c == 0x7f ) ) {
+				return true;
+			}
+
+		}
+
+		return false;
+
+	}
+
+
+	void logencoder::integer( std::string &out, long long v ) throw() {
+
+		if ( v < 0 ) {
+			out += '-';
+			integer( out, (unsigned long long) 0 - (unsigned long long) v );
+		} else {
+			integer( out, (unsigned long long) v );
+		}
+
+	}
+
+
+	void logencoder::integer( std::string &out, unsigned long long v ) throw() {
+
+		char buffer[24];
+		char * end = buffer + sizeof( buffer );
+		char * p   = lognumput::utoa( end, v );
+
+		out.append( p, end - p );
+
+	}
+
+
+	void logencoder::real( std::string &out, double v ) throw() {
+
+		// sanity check
+		if (! std::isfinite( v ) ) {
+			out.append( "null", 4 );
+			return;
+		}
+
+		char buffer[32];
+		size_t n = lognumput::dtoa( buffer, v, 17 );
+
+		out.append( buffer, n );
+
+	}
+
+} /* end of namespace logstreamxx */
+
@@ -0,0 +1,165 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTREAMXX_LOGENCODER_H
+#define LOGSTREAMXX_LOGENCODER_H
+
+#include <cstddef>
+#include <string>
+
+
+namespace logstreamxx {
+
+	/**
+	*   @brief Structured log encoder class
+	*
+	*   Helper methods to encode structured log record fields as JSON or
+	*   logfmt, appending straight to an output string without going
+	*   through string streams.
+	*
+	*   String escaping copies runs of characters which don't need
+	*   escaping at once, so large payloads with few special characters
+	*   cost little more than a copy. The runs are found with SSE2 or
+	*   AVX2 kernels where the CPU supports them ( see isa() ) and a
+	*   byte at a time otherwise.
+	*
+	*/
+	class logencoder {
+	public:
+
+		/**
+		*   @brief instruction set type for the scanning kernels
+		*/
+		enum isa_t {
+			scalar  = 0,    //!< byte at a time
+			sse2    = 1,    //!< 16 bytes at a time
+			avx2    = 2     //!< 32 bytes at a time
+		};
+
+		/**
+		*   @brief escape characters for a quoted string
+		*   @param out output string to append to
+		*   @param data characters to escape
+		*   @param n number of characters
+		*
+		*   Append @c n characters pointed by @c data to @c out, escaping
+		*   @c '"', @c '\\' and control characters the JSON way ( e.g.
+		*   @c "\\n", @c "\\u001b" ). This is used for both JSON strings
+		*   and logfmt quoted values. Valid UTF-8 sequences are copied as
+		*   is and any invalid bytes are replaced with @c "\\ufffd".
+		*
+		*   @sa scan()
+		*
+		*/
+		static void escape( std::string &out, const char * data, size_t n ) throw();
+
+		/**
+		*   @brief find the first character which isn't copied as is
+		*   @param data characters to scan
+		*   @param n number of characters
+		*   @param isa instruction set to use, capped to what the CPU
+		*              supports
+		*
+		*   @return offset of the first control character, @c '"',
+		*           @c '\\', DEL or non-ASCII byte, or @c n if there
+		*           are none
+		*
+		*/
+		static size_t scan( const char * data, size_t n, const isa_t &isa ) throw();
+
+		/**
+		*   @brief validate UTF-8
+		*   @param data characters to validate
+		*   @param n number of characters
+		*   @param isa instruction set to use, capped to what the CPU
+		*              supports
+		*
+		*   @return length of the valid UTF-8 prefix, @c n if all of
+		*           @c data is valid UTF-8
+		*
+		*   Overlong encodings, surrogates and code points above
+		*   U+10FFFF are rejected. ASCII runs are skipped in bulk.
+		*
+		*/
+		static size_t utf8( const char * data, size_t n, const isa_t &isa ) throw();
+
+		/**
+		*   @brief validate UTF-8 with the best supported instruction set
+		*   @param data characters to validate
+		*   @param n number of characters
+		*   @return length of the valid UTF-8 prefix
+		*/
+		static size_t utf8( const char * data, size_t n ) throw();
+
+		/**
+		*   @brief size of an incomplete UTF-8 sequence at the end
+		*   @param data characters
+		*   @param n number of characters
+		*   @return number of trailing bytes which start a multi-byte
+		*           sequence without completing it, @c 0 if none
+		*/
+		static size_t incomplete( const char * data, size_t n ) throw();
+
+		/**
+		*   @brief get the best instruction set supported by the CPU
+		*   @return instruction set, detected once at the first call
+		*/
+		static isa_t isa() throw();
+
+		/**
+		*   @brief check whether a logfmt value needs quoting
+		*   @param data value
+		*   @param n value size
+		*   @return boolean @c true if the value is empty or contains
+		*           spaces, @c '=', @c '"' or control characters
+		*/
+		static bool quote( const char * data, size_t n ) throw();
+
+		/**
+		*   @brief append a signed integer
+		*   @param out output string to append to
+		*   @param v value
+		*/
+		static void integer( std::string &out, long long v ) throw();
+
+		/**
+		*   @brief append an unsigned integer
+		*   @param out output string to append to
+		*   @param v value
+		*/
+		static void integer( std::string &out, unsigned long long v ) throw();
+
+		/**
+		*   @brief append a floating point number
+		*   @param out output string to append to
+		*   @param v value
+		*
+		*   Appends the shortest representation which reads back as
+		*   @c v ( see lognumput::dtoa() ). Non-finite values are appended as
+		*   @c null since JSON has no representation for them.
+		*
+		*/
+		static void real( std::string &out, double v ) throw();
+
+	};
+
+} /* end of namespace logstreamxx */
+
+#endif /* !LOGSTREAMXX_LOGENCODER_H */
+
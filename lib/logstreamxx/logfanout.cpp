@@ -0,0 +1,86 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logfanout.h"
+
+#include <algorithm>
+
+
+namespace logstreamxx {
+
+	logfanout::logfanout() throw() {
+		pthread_rwlock_init( &_lock, 0 );
+	}
+
+
+	logfanout::~logfanout() throw() {
+		pthread_rwlock_destroy( &_lock );
+	}
+
+
+	bool logfanout::write( const priority::log_priority_t &p, const iovec * iov, int iovcnt ) throw() {
+
+		bool ret = true;
+
+		pthread_rwlock_rdlock( &_lock );
+
+		for ( size_t i = 0; i < _sinks.size(); i++ ) {
+
+			// check - log priority enabled for the sink?
+			if ( _sinks[i]->enabled( p ) ) {
+				ret = _sinks[i]->write( p, iov, iovcnt ) && ret;
+			}
+
+		}
+
+		pthread_rwlock_unlock( &_lock );
+
+		return ret;
+
+	}
+
+
+	void logfanout::attach( logsink * sink ) throw() {
+
+		// sanity check
+		if ( ( sink == 0 ) || ( sink == this ) ) {
+			return;
+		}
+
+		pthread_rwlock_wrlock( &_lock );
+
+		if ( std::find( _sinks.begin(), _sinks.end(), sink ) == _sinks.end() ) {
+			_sinks.push_back( sink );
+		}
+
+		pthread_rwlock_unlock( &_lock );
+
+	}
+
+
+	void logfanout::detach( logsink * sink ) throw() {
+
+		pthread_rwlock_wrlock( &_lock );
+		_sinks.erase( std::remove( _sinks.begin(), _sinks.end(), sink ), _sinks.end() );
+		pthread_rwlock_unlock( &_lock );
+
+	}
+
+} /* end of namespace logstreamxx */
+
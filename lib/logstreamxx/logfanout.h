@@ -0,0 +1,92 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTREAMXX_LOGFANOUT_H
+#define LOGSTREAMXX_LOGFANOUT_H
+
+#include <logstreamxx/logsink.h>
+
+#include <vector>
+#include <pthread.h>
+
+
+namespace logstreamxx {
+
+	/**
+	*   @brief Fan-out log sink class
+	*
+	*   Hands each log record over to all the attached log sinks whose
+	*   log-mask enables the log record priority. The log record is
+	*   formatted once and the same parts are passed to every log sink.
+	*
+	*/
+	class logfanout : public logsink {
+	public:
+
+		/**
+		*   @brief constructor
+		*/
+		logfanout() throw();
+
+		/**
+		*   @brief destructor
+		*/
+		virtual ~logfanout() throw();
+
+		/**
+		*   @brief write a log record to all the attached log sinks
+		*   @return boolean @c true if all the log sinks succeeded or
+		*           @c false otherwise
+		*
+		*   @sa logsink::write()
+		*
+		*/
+		virtual bool write( const priority::log_priority_t &p, const iovec * iov, int iovcnt ) throw();
+
+		/**
+		*   @brief attach a log sink
+		*   @param sink log sink
+		*
+		*   @note The log sink is not owned by the fan-out log sink and
+		*         must be detached before it is destroyed.
+		*
+		*/
+		void attach( logsink * sink ) throw();
+
+		/**
+		*   @brief detach a log sink
+		*   @param sink log sink
+		*/
+		void detach( logsink * sink ) throw();
+
+
+	private:
+
+		/** attached log sinks */
+		std::vector<logsink *> _sinks;
+
+		/** lock to guard the attached log sinks */
+		pthread_rwlock_t _lock;
+
+	};
+
+} /* end of namespace logstreamxx */
+
+#endif /* !LOGSTREAMXX_LOGFANOUT_H */
+
@@ -0,0 +1,286 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logfdsink.h"
+#include "logflusher.h"
+
+#include <cerrno>
+#include <vector>
+#include <unistd.h>
+
+
+namespace logstreamxx {
+
+	logfdsink::logfdsink( int fd ) throw( logexception ) : _fd( fd ), _rotator( 0 ) {
+
+		// sanity check
+		if ( _fd < 0 ) {
+			throw logexception( "Invalid file descriptor" );
+		}
+
+		init();
+
+	}
+
+
+	logfdsink::logfdsink( logrotator * rotator ) throw( logexception ) : _fd( -1 ), _rotator( rotator ) {
+
+		// sanity check
+		if ( _rotator == 0 ) {
+			throw logexception( "Invalid log rotator" );
+		}
+
+		_fd = _rotator->fd();
+		init();
+
+	}
+
+
+	logfdsink::~logfdsink() throw() {
+
+		// stop syncing, derived classes closing the file descriptor
+		// must do this first
+		durability( durability_t() );
+
+		pthread_cond_destroy( &_sync_cond );
+		pthread_mutex_destroy( &_sync_mutex );
+
+	}
+
+
+	void logfdsink::init() throw() {
+
+		_threshold = -1;
+		_wseq      = 0;
+		_synced    = 0;
+		_syncing   = false;
+		_syncs     = 0;
+
+		pthread_mutex_init( &_sync_mutex, 0 );
+		pthread_cond_init( &_sync_cond, 0 );
+
+	}
+
+
+	int logfdsink::fd() const throw() {
+		return _fd;
+	}
+
+
+	bool logfdsink::write( const priority::log_priority_t &p, const iovec * iov, int iovcnt ) throw() {
+
+		size_t total = 0;
+		for ( int i = 0; i < iovcnt; i++ ) {
+			total += iov[i].iov_len;
+		}
+
+		// copy of the parts, only needed after a partial write
+		std::vector<iovec> remaining;
+
+		while ( iovcnt > 0 ) {
+
+			ssize_t w = writev( _fd, iov, iovcnt );
+
+			if ( w < 0 ) {
+
+				// retry if interrupted
+				if ( errno == EINTR ) {
+					continue;
+				}
+
+				return false;
+
+			}
+
+			// skip over the parts written out completely
+			while ( ( iovcnt > 0 ) && ( (size_t) w >= iov->iov_len ) ) {
+				w -= iov->iov_len;
+				iov++;
+				iovcnt--;
+			}
+
+			// partial write, adjust the remaining part
+			if ( iovcnt > 0 ) {
+
+				// the parts can't be modified in place, copy them once
+				if ( remaining.empty() ) {
+					remaining.assign( iov, iov + iovcnt );
+					iov = &remaining[0];
+				}
+
+				iovec * part = &remaining[iov - &remaining[0]];
+				part->iov_base = (char *) part->iov_base + w;
+				part->iov_len -= w;
+
+			}
+
+		}
+
+		// check - durable write? ( before accounting for the written
+		// out data, a rotation would swap in a new log file )
+		__atomic_add_fetch( &_wseq, 1, __ATOMIC_RELEASE );
+
+		bool ret = true;
+		if ( (int) p <= __atomic_load_n( &_threshold, __ATOMIC_ACQUIRE ) ) {
+			ret = commit();
+		}
+
+		// account for the written out data, this may rotate the log file
+		if ( _rotator != 0 ) {
+			_rotator->written( total );
+		}
+
+		return ret;
+
+	}
+
+
+	logfdsink::durability_t logfdsink::durability( const durability_t &policy ) throw() {
+
+		// a periodic policy without an interval would never sync,
+		// sync every log record instead
+		durability_t next = policy;
+		if ( ( next.level == durability_t::periodic ) && ( next.interval == 0 ) ) {
+			next.level     = durability_t::group;
+			next.threshold = priority::debug;
+		}
+
+		// backup the current policy
+		pthread_mutex_lock( &_sync_mutex );
+		durability_t prev_policy = _durability;
+		pthread_mutex_unlock( &_sync_mutex );
+
+		// stop the timer thread from syncing and sync once more
+		if ( prev_policy.level != durability_t::none ) {
+
+			if ( prev_policy.interval > 0 ) {
+				logflusher::detach( this );
+			}
+
+			__atomic_store_n( &_threshold, -1, __ATOMIC_RELEASE );
+			commit();
+
+		}
+
+		// update
+		pthread_mutex_lock( &_sync_mutex );
+		_durability = next;
+		pthread_mutex_unlock( &_sync_mutex );
+
+		if ( next.level == durability_t::group ) {
+			__atomic_store_n( &_threshold, (int) next.threshold, __ATOMIC_RELEASE );
+		}
+
+		if ( ( next.level != durability_t::none ) && ( next.interval > 0 ) ) {
+			logflusher::attach( &logfdsink::tsync, this );
+		}
+
+		return prev_policy;
+
+	}
+
+
+	bool logfdsink::commit() throw() {
+
+		// writes to be synced
+		uint64_t target = __atomic_load_n( &_wseq, __ATOMIC_ACQUIRE );
+		bool ret = true;
+
+		pthread_mutex_lock( &_sync_mutex );
+
+		while ( _synced < target ) {
+
+			// check - sync in progress?
+			if ( _syncing ) {
+				pthread_cond_wait( &_sync_cond, &_sync_mutex );
+				continue;
+			}
+
+			// sync everything written out so far, on behalf of all
+			// the callers waiting
+			_syncing = true;
+			uint64_t wseq = __atomic_load_n( &_wseq, __ATOMIC_ACQUIRE );
+			pthread_mutex_unlock( &_sync_mutex );
+
+			int r;
+			do {
+				r = fdatasync( _fd );
+			} while ( ( r != 0 ) && ( errno == EINTR ) );
+
+			pthread_mutex_lock( &_sync_mutex );
+
+			_syncing = false;
+			_syncs++;
+
+			if ( r == 0 ) {
+				if ( wseq > _synced ) {
+					_synced = wseq;
+				}
+			} else {
+				// give up, other waiters retry
+				ret = false;
+				pthread_cond_broadcast( &_sync_cond );
+				break;
+			}
+
+			pthread_cond_broadcast( &_sync_cond );
+
+		}
+
+		pthread_mutex_unlock( &_sync_mutex );
+
+		return ret;
+
+	}
+
+
+	long long logfdsink::tsync( void * arg, long long now ) throw() {
+
+		// log sink instance
+		logfdsink * sink = (logfdsink *) arg;
+
+		// check - anything written out since the last sync?
+		pthread_mutex_lock( &sink->_sync_mutex );
+		bool due = ( sink->_synced < __atomic_load_n( &sink->_wseq, __ATOMIC_ACQUIRE ) ) && (! sink->_syncing );
+		unsigned int interval = sink->_durability.interval;
+		pthread_mutex_unlock( &sink->_sync_mutex );
+
+		// this runs without the timer lock held, a slow sync only
+		// delays the timer thread and not the attach() / detach() calls
+		if ( due ) {
+			sink->commit();
+		}
+
+		return now + interval;
+
+	}
+
+
+	size_t logfdsink::syncs() const throw() {
+
+		pthread_mutex_lock( &_sync_mutex );
+		size_t syncs = _syncs;
+		pthread_mutex_unlock( &_sync_mutex );
+
+		return syncs;
+
+	}
+
+} /* end of namespace logstreamxx */
+
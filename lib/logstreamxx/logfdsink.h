@@ -0,0 +1,213 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTREAMXX_LOGFDSINK_H
+#define LOGSTREAMXX_LOGFDSINK_H
+
+#include <logstreamxx/logsink.h>
+#include <logstreamxx/logexception.h>
+#include <logstreamxx/logrotator.h>
+
+#include <pthread.h>
+#include <stdint.h>
+
+
+namespace logstreamxx {
+
+	/**
+	*   @brief File descriptor log sink class
+	*
+	*   Writes log records out to a file descriptor ( e.g. a file, a pipe
+	*   or a connected socket ) with a single @c writev() system call per
+	*   log record. The file descriptor is not owned by the log sink.
+	*
+	*   Log records can be made durable ( synced to disk with
+	*   @c fdatasync() ) periodically and/or before the write returns,
+	*   see durability().
+	*
+	*/
+	class logfdsink : public logsink {
+	public:
+
+		/**
+		*   @brief durability policy type
+		*/
+		struct durability_t {
+
+			/**
+			*   @brief durability level type
+			*/
+			enum level_t {
+				none      = 0,      //!< leave syncing to the operating system
+				periodic  = 1,      //!< sync every @c interval milliseconds
+				group     = 2       //!< as periodic, and log records with the
+				                    //!< @c threshold priority or higher are
+				                    //!< synced before the write returns
+			};
+
+			/**
+			*   @brief constructor
+			*   @param level durability level
+			*   @param interval sync interval in milliseconds ( 0 to disable )
+			*   @param threshold log priority to sync before returning at
+			*/
+			explicit durability_t( const level_t &level = none, unsigned int interval = 1000,
+					const priority::log_priority_t &threshold = priority::crit ) throw() :
+					level( level ), interval( interval ), threshold( threshold ) { }
+
+			/** durability level */
+			level_t level;
+
+			/** sync interval in milliseconds ( 0 to disable ) */
+			unsigned int interval;
+
+			/** log priority to sync before returning at ( or higher ) */
+			priority::log_priority_t threshold;
+
+		};
+
+		/**
+		*   @brief constructor
+		*   @param fd log output file descriptor
+		*/
+		logfdsink( int fd ) throw( logexception );
+
+		/**
+		*   @brief overloaded constructor
+		*   @param rotator log file rotator
+		*
+		*   Write out to the log file owned by @c rotator, which is
+		*   rotated in between the log records.
+		*
+		*   @note The log rotator is not owned by the log sink and must
+		*         outlive it.
+		*
+		*/
+		logfdsink( logrotator * rotator ) throw( logexception );
+
+		/**
+		*   @brief destructor
+		*/
+		virtual ~logfdsink() throw();
+
+		/**
+		*   @brief write a log record
+		*   @sa logsink::write()
+		*/
+		virtual bool write( const priority::log_priority_t &p, const iovec * iov, int iovcnt ) throw();
+
+		/**
+		*   @brief get the log output file descriptor
+		*   @return log output file descriptor
+		*/
+		int fd() const throw();
+
+		/**
+		*   @brief change the durability policy
+		*   @param policy durability policy
+		*   @return previous durability policy
+		*
+		*   With the periodic level, a process-wide timer thread syncs
+		*   the log output every @c interval milliseconds if anything
+		*   was written out since the last sync. With the group level,
+		*   writing a log record with the @c threshold priority or higher
+		*   also waits until it is synced (see commit()), so only those
+		*   log records pay for the sync.
+		*
+		*   Leaving the periodic or group level syncs the log output
+		*   once more.
+		*
+		*   A periodic policy with a 0 @c interval syncs every log record
+		*   before the write returns, the same as a group policy with
+		*   the priority::debug threshold.
+		*
+		*   @note The durability level defaults to none on initialisation.
+		*
+		*/
+		durability_t durability( const durability_t &policy ) throw();
+
+		/**
+		*   @brief make the log records written so far durable
+		*   @return boolean @c true on success or @c false otherwise
+		*
+		*   Block the caller until all the log records written out so far
+		*   are synced to disk. Concurrent callers share a single
+		*   @c fdatasync() ( group commit ), a caller waiting for a sync
+		*   in progress which started after its log records were written
+		*   out doesn't start another.
+		*
+		*/
+		bool commit() throw();
+
+		/**
+		*   @brief get the number of syncs
+		*   @return number of @c fdatasync() calls
+		*/
+		size_t syncs() const throw();
+
+
+	protected:
+
+		/** log output file descriptor */
+		int _fd;
+
+		/** log file rotator (if any) */
+		logrotator * _rotator;
+
+
+	private:
+
+		/** durability policy, guarded by the sync mutex */
+		durability_t _durability;
+
+		/** log priority to sync before returning at ( or higher ), -1 if
+		    none, read by the writers without the sync mutex */
+		int _threshold;
+
+		/** number of writes so far */
+		uint64_t _wseq;
+
+		/** number of writes synced so far */
+		uint64_t _synced;
+
+		/** flag to indicate whether a sync is in progress */
+		bool _syncing;
+
+		/** number of syncs */
+		size_t _syncs;
+
+		/** mutex to guard the sync state */
+		mutable pthread_mutex_t _sync_mutex;
+
+		/** condition to signal a completed sync */
+		pthread_cond_t _sync_cond;
+
+		/** initialise the sync state */
+		void init() throw();
+
+		/** flush timer callback, sync if anything was written out since
+		    the last sync and return the next due time */
+		static long long tsync( void * arg, long long now ) throw();
+
+	};
+
+} /* end of namespace logstreamxx */
+
+#endif /* !LOGSTREAMXX_LOGFDSINK_H */
+
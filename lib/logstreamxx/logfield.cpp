@@ -0,0 +1,100 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logfield.h"
+#include "logstreambuf.h"
+
+#include <cstring>
+
+
+namespace logstreamxx {
+
+	logfield::logfield( const char * key, int v ) throw() : key( key ), type( t_signed ), str( 0 ), len( 0 ) {
+		value.i = v;
+	}
+
+
+	logfield::logfield( const char * key, long v ) throw() : key( key ), type( t_signed ), str( 0 ), len( 0 ) {
+		value.i = v;
+	}
+
+
+	logfield::logfield( const char * key, long long v ) throw() : key( key ), type( t_signed ), str( 0 ), len( 0 ) {
+		value.i = v;
+	}
+
+
+	logfield::logfield( const char * key, unsigned int v ) throw() : key( key ), type( t_unsigned ), str( 0 ), len( 0 ) {
+		value.u = v;
+	}
+
+
+	logfield::logfield( const char * key, unsigned long v ) throw() : key( key ), type( t_unsigned ), str( 0 ), len( 0 ) {
+		value.u = v;
+	}
+
+
+	logfield::logfield( const char * key, unsigned long long v ) throw() : key( key ), type( t_unsigned ), str( 0 ), len( 0 ) {
+		value.u = v;
+	}
+
+
+	logfield::logfield( const char * key, double v ) throw() : key( key ), type( t_double ), str( 0 ), len( 0 ) {
+		value.d = v;
+	}
+
+
+	logfield::logfield( const char * key, bool v ) throw() : key( key ), type( t_bool ), str( 0 ), len( 0 ) {
+		value.b = v;
+	}
+
+
+	logfield::logfield( const char * key, const char * v ) throw() : key( key ), type( t_string ),
+			str( ( v != 0 ) ? v : "" ), len( ( v != 0 ) ? strlen( v ) : 0 ) {
+		value.u = 0;
+	}
+
+
+	logfield::logfield( const char * key, const std::string &v ) throw() : key( key ), type( t_string ),
+			str( v.data() ), len( v.length() ) {
+		value.u = 0;
+	}
+
+
+	std::ostream &operator <<( std::ostream &os, const logfield &field ) {
+
+		// check - writing to a log stream buffer?
+		logstreambuf * sb = dynamic_cast<logstreambuf *>( os.rdbuf() );
+
+		if ( sb != 0 ) {
+			sb->lfield( field );
+			return os;
+		}
+
+		// plain output stream, insert as text
+		std::string s;
+		logstreambuf::encode( s, logstreambuf::text, field );
+		os.write( s.data(), s.length() );
+
+		return os;
+
+	}
+
+} /* end of namespace logstreamxx */
+
@@ -0,0 +1,117 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTREAMXX_LOGFIELD_H
+#define LOGSTREAMXX_LOGFIELD_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+
+namespace logstreamxx {
+
+	/**
+	*   @brief Structured log record field class
+	*
+	*   A typed key-value pair attached to the current log record when
+	*   inserted into a log stream, e.g.
+	*
+	*   @code
+	*   logger << priority::info << logfield( "user", name ) << logfield( "ms", 3.25 )
+	*           << "request completed" << std::endl;
+	*   @endcode
+	*
+	*   Fields are encoded according to the log stream buffer format
+	*   ( see logstreambuf::lformat() ) and added after the log message.
+	*
+	*   @note String values are not copied, a field must not outlive
+	*         the value it refers to. Fields are meant to be used as
+	*         temporaries within a single log statement.
+	*
+	*/
+	class logfield {
+	public:
+
+		/**
+		*   @brief field value type
+		*/
+		enum type_t {
+			t_signed    = 0,     //!< signed integer
+			t_unsigned  = 1,     //!< unsigned integer
+			t_double    = 2,     //!< floating point number
+			t_bool      = 3,     //!< boolean
+			t_string    = 4      //!< string
+		};
+
+		/**
+		*   @brief constructors
+		*   @param key field name
+		*   @param v field value
+		*/
+		logfield( const char * key, int v ) throw();
+		logfield( const char * key, long v ) throw();
+		logfield( const char * key, long long v ) throw();
+		logfield( const char * key, unsigned int v ) throw();
+		logfield( const char * key, unsigned long v ) throw();
+		logfield( const char * key, unsigned long long v ) throw();
+		logfield( const char * key, double v ) throw();
+		logfield( const char * key, bool v ) throw();
+		logfield( const char * key, const char * v ) throw();
+		logfield( const char * key, const std::string &v ) throw();
+
+		/** field name */
+		const char * key;
+
+		/** field value type */
+		type_t type;
+
+		/** field value */
+		union {
+			long long i;
+			unsigned long long u;
+			double d;
+			bool b;
+		} value;
+
+		/** string field value */
+		const char * str;
+
+		/** string field value size */
+		size_t len;
+
+	};
+
+
+	/**
+	*   @brief insert a structured log record field
+	*   @param os output stream
+	*   @param field field to insert
+	*   @return @c os
+	*
+	*   Attaches @c field to the current log record if @c os writes
+	*   to a log stream buffer, otherwise @c " key=value" is inserted.
+	*
+	*/
+	std::ostream &operator <<( std::ostream &os, const logfield &field );
+
+} /* end of namespace logstreamxx */
+
+#endif /* !LOGSTREAMXX_LOGFIELD_H */
+
@@ -0,0 +1,80 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logfilesink.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+
+namespace logstreamxx {
+
+	logfilesink::logfilesink( const char * filename, bool append, mode_t mode ) throw( logexception ) :
+			logfdsink( lopen( filename, append, mode ) ) {
+
+	}
+
+
+	logfilesink::logfilesink( const char * filename, const logrotator::policy_t &rotation,
+			bool append, mode_t mode ) throw( logexception ) :
+			logfdsink( new logrotator( filename, rotation, append, mode ) ) {
+
+	}
+
+
+	logfilesink::~logfilesink() throw() {
+
+		// stop syncing before closing the log file
+		durability( durability_t() );
+
+		// close the log file
+		if ( _rotator != 0 ) {
+			delete _rotator;
+		} else {
+			::close( _fd );
+		}
+
+	}
+
+
+	int logfilesink::lopen( const char * filename, bool append, mode_t mode ) throw( logexception ) {
+
+		// set file open flags
+		int flags = O_WRONLY | O_CREAT | O_APPEND;
+
+		// truncate file?
+		if (! append ) {
+			flags |= O_TRUNC;
+		}
+
+		// open file
+		int fd = ::open( filename, flags, mode );
+
+		// check - was the open file successful?
+		if ( fd == -1 ) {
+			// throw a log exception with system message
+			throw logexception();
+		}
+
+		return fd;
+
+	}
+
+} /* end of namespace logstreamxx */
+
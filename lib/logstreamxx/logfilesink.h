@@ -0,0 +1,90 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTREAMXX_LOGFILESINK_H
+#define LOGSTREAMXX_LOGFILESINK_H
+
+#include <logstreamxx/logfdsink.h>
+
+#include <sys/types.h>
+
+
+namespace logstreamxx {
+
+	/**
+	*   @brief File log sink class
+	*
+	*   Opens and owns a log file, optionally rotated, and writes log
+	*   records out to it.
+	*
+	*/
+	class logfilesink : public logfdsink {
+	public:
+
+		/**
+		*   @brief constructor
+		*   @param filename log file name
+		*   @param append boolean flag to indicate whether to append to
+		*                 the log file or truncate the file if already
+		*                 exists
+		*
+		*   @param mode file mode to open the log file with
+		*
+		*   Open @c filename for writing. The file will be created if it
+		*   doesn't exist.
+		*
+		*/
+		logfilesink( const char * filename, bool append = true, mode_t mode = 00644 ) throw( logexception );
+
+		/**
+		*   @brief overloaded constructor (log rotation)
+		*   @param filename log file name
+		*   @param rotation log file rotation policy
+		*   @param append boolean flag to indicate whether to append to
+		*                 the log file or truncate the file if already
+		*                 exists
+		*
+		*   @param mode file mode to open the log files with
+		*
+		*   @sa logrotator
+		*
+		*/
+		logfilesink( const char * filename, const logrotator::policy_t &rotation,
+				bool append = true, mode_t mode = 00644 ) throw( logexception );
+
+		/**
+		*   @brief destructor
+		*
+		*   Close the log file.
+		*
+		*/
+		virtual ~logfilesink() throw();
+
+
+	private:
+
+		/** open the log file */
+		static int lopen( const char * filename, bool append, mode_t mode ) throw( logexception );
+
+	};
+
+} /* end of namespace logstreamxx */
+
+#endif /* !LOGSTREAMXX_LOGFILESINK_H */
+
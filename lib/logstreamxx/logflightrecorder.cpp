@@ -0,0 +1,231 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logflightrecorder.h"
+
+#include <cstring>
+#include <stdint.h>
+
+
+namespace logstreamxx {
+
+	logflightrecorder::logflightrecorder( logsink * sink, size_t capacity,
+			const priority::log_priority_t &trigger ) throw( logexception ) :
+			_sink( sink ), _trigger( trigger ), _ring( 0 ), _capacity( capacity ), _head( 0 ), _used( 0 ) {
+
+		// sanity checks
+		if ( _sink == 0 ) {
+			throw logexception( "Invalid log sink" );
+		}
+
+		if ( _capacity <= header_size ) {
+			throw logexception( "Invalid ring capacity" );
+		}
+
+		_ring = new char[_capacity];
+		pthread_mutex_init( &_mutex, 0 );
+
+	}
+
+
+	logflightrecorder::~logflightrecorder() throw() {
+
+		pthread_mutex_destroy( &_mutex );
+		delete [] _ring;
+
+	}
+
+
+	bool logflightrecorder::write( const priority::log_priority_t &p, const iovec * iov, int iovcnt ) throw() {
+
+		bool ret = true;
+
+		// check - trigger priority?
+		if ( p <= _trigger ) {
+
+			pthread_mutex_lock( &_mutex );
+			ret = wdump();
+			pthread_mutex_unlock( &_mutex );
+
+			return _sink->write( p, iov, iovcnt ) && ret;
+
+		}
+
+		// check - enabled for the target log sink?
+		if ( _sink->enabled( p ) ) {
+			return _sink->write( p, iov, iovcnt );
+		}
+
+		// log record size
+		size_t n = 0;
+		for ( int i = 0; i < iovcnt; i++ ) {
+			n += iov[i].iov_len;
+		}
+
+		// sanity check - will this ever fit into the ring?
+		if ( ( n == 0 ) || ( ( n + header_size ) > _capacity ) ) {
+			return true;
+		}
+
+		pthread_mutex_lock( &_mutex );
+		record( p, iov, iovcnt, n );
+		pthread_mutex_unlock( &_mutex );
+
+		return ret;
+
+	}
+
+
+	void logflightrecorder::record( const priority::log_priority_t &p, const iovec * iov, int iovcnt, size_t n ) throw() {
+
+		// discard the oldest log records to make space
+		while ( ( _used + header_size + n ) > _capacity ) {
+
+			uint32_t len;
+			rget( ( _head + 1 ) % _capacity, &len, 4 );
+
+			_head  = ( _head + header_size + len ) % _capacity;
+			_used -= header_size + len;
+
+		}
+
+		// header ( priority and length )
+		size_t pos = ( _head + _used ) % _capacity;
+
+		char prio = p;
+		uint32_t len = n;
+
+		rput( pos, &prio, 1 );
+		rput( ( pos + 1 ) % _capacity, &len, 4 );
+		pos = ( pos + header_size ) % _capacity;
+
+		// log record parts
+		for ( int i = 0; i < iovcnt; i++ ) {
+			rput( pos, iov[i].iov_base, iov[i].iov_len );
+			pos = ( pos + iov[i].iov_len ) % _capacity;
+		}
+
+		_used += header_size + n;
+
+	}
+
+
+	bool logflightrecorder::wdump() throw() {
+
+		bool ret = true;
+
+		while ( _used > 0 ) {
+
+			char prio;
+			uint32_t len;
+
+			rget( _head, &prio, 1 );
+			rget( ( _head + 1 ) % _capacity, &len, 4 );
+
+			// log record, in two parts if it wraps around
+			size_t pos = ( _head + header_size ) % _capacity;
+
+			iovec iov[2];
+			int iovcnt = 1;
+
+			iov[0].iov_base = _ring + pos;
+			iov[0].iov_len  = len;
+
+			if ( ( pos + len ) > _capacity ) {
+				iov[0].iov_len  = _capacity - pos;
+				iov[1].iov_base = _ring;
+				iov[1].iov_len  = len - iov[0].iov_len;
+				iovcnt = 2;
+			}
+
+			if (! _sink->write( (priority::log_priority_t) prio, iov, iovcnt ) ) {
+				ret = false;
+			}
+
+			_head  = ( _head + header_size + len ) % _capacity;
+			_used -= header_size + len;
+
+		}
+
+		_head = 0;
+
+		return ret;
+
+	}
+
+
+	void logflightrecorder::rput( size_t pos, const void * data, size_t n ) throw() {
+
+		size_t first = _capacity - pos;
+		if ( first > n ) {
+			first = n;
+		}
+
+		memcpy( _ring + pos, data, first );
+		memcpy( _ring, (const char *) data + first, n - first );
+
+	}
+
+
+	void logflightrecorder::rget( size_t pos, void * data, size_t n ) const throw() {
+
+		size_t first = _capacity - pos;
+		if ( first > n ) {
+			first = n;
+		}
+
+		memcpy( data, _ring + pos, first );
+		memcpy( (char *) data + first, _ring, n - first );
+
+	}
+
+
+	bool logflightrecorder::dump() throw() {
+
+		pthread_mutex_lock( &_mutex );
+		bool ret = wdump();
+		pthread_mutex_unlock( &_mutex );
+
+		return ret;
+
+	}
+
+
+	void logflightrecorder::clear() throw() {
+
+		pthread_mutex_lock( &_mutex );
+		_head = 0;
+		_used = 0;
+		pthread_mutex_unlock( &_mutex );
+
+	}
+
+
+	size_t logflightrecorder::length() const throw() {
+
+		pthread_mutex_lock( &_mutex );
+		size_t used = _used;
+		pthread_mutex_unlock( &_mutex );
+
+		return used;
+
+	}
+
+} /* end of namespace logstreamxx */
+
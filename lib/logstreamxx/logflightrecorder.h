@@ -0,0 +1,165 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTREAMXX_LOGFLIGHTRECORDER_H
+#define LOGSTREAMXX_LOGFLIGHTRECORDER_H
+
+#include <logstreamxx/logsink.h>
+#include <logstreamxx/logexception.h>
+
+#include <cstddef>
+#include <pthread.h>
+
+#ifndef LOGFLIGHTRECORDER_SIZE
+#define LOGFLIGHTRECORDER_SIZE 1048576
+#endif
+
+
+namespace logstreamxx {
+
+	/**
+	*   @brief Flight recorder log sink class
+	*
+	*   Keeps the recent history of log records masked out by a target
+	*   log sink in a fixed size in-memory ring, and writes it out to
+	*   the target log sink when something goes wrong.
+	*
+	*   Log records enabled by the target log sink's log-mask are
+	*   written out straight away. The others are copied into the ring,
+	*   discarding the oldest records to make space. When a log record
+	*   with the trigger priority ( or higher ) is written, or on
+	*   dump(), the recorded history is written out to the target log
+	*   sink ahead of it, oldest first.
+	*
+	*   @code
+	*   logfilesink file( "/var/log/app.log" );
+	*   file.setlogmask( priority::mask::emerg | priority::mask::err | priority::mask::info );
+	*
+	*   logflightrecorder recorder( &file );
+	*   logstream logger( &recorder );
+	*   logger.loglevel( priority::debug );
+	*   @endcode
+	*
+	*   @note The log stream must enable the recorded priorities, its
+	*         log-mask decides what is formatted at all.
+	*
+	*/
+	class logflightrecorder : public logsink {
+	public:
+
+		/**
+		*   @brief constructor
+		*   @param sink target log sink
+		*   @param capacity ring capacity in bytes
+		*   @param trigger log priority which triggers writing out the
+		*          recorded history
+		*
+		*   @note The target log sink is not owned by the flight recorder
+		*         and must outlive it.
+		*
+		*/
+		logflightrecorder( logsink * sink, size_t capacity = LOGFLIGHTRECORDER_SIZE,
+				const priority::log_priority_t &trigger = priority::err ) throw( logexception );
+
+		/**
+		*   @brief destructor
+		*/
+		virtual ~logflightrecorder() throw();
+
+		/**
+		*   @brief write or record a log record
+		*   @return boolean @c true on success or @c false if writing out
+		*           to the target log sink failed
+		*
+		*   @sa logsink::write()
+		*
+		*/
+		virtual bool write( const priority::log_priority_t &p, const iovec * iov, int iovcnt ) throw();
+
+		/**
+		*   @brief write out the recorded history
+		*   @return boolean @c true on success or @c false if writing out
+		*           to the target log sink failed
+		*
+		*   Write out the recorded log records to the target log sink,
+		*   irrespective of its log-mask, and clear the ring.
+		*
+		*/
+		bool dump() throw();
+
+		/**
+		*   @brief discard the recorded history
+		*/
+		void clear() throw();
+
+		/**
+		*   @brief get the size of the recorded history
+		*   @return number of bytes used in the ring
+		*/
+		size_t length() const throw();
+
+
+	private:
+
+		/** recorded log record header size ( priority and length ) */
+		static const size_t header_size = 5;
+
+		/** target log sink */
+		logsink * _sink;
+
+		/** trigger priority */
+		priority::log_priority_t _trigger;
+
+		/** ring */
+		char * _ring;
+
+		/** ring capacity */
+		size_t _capacity;
+
+		/** ring offset of the oldest log record */
+		size_t _head;
+
+		/** ring bytes used */
+		size_t _used;
+
+		/** mutex to guard the ring */
+		mutable pthread_mutex_t _mutex;
+
+		/** record a log record in the ring */
+		void record( const priority::log_priority_t &p, const iovec * iov, int iovcnt, size_t n ) throw();
+
+		/** write out the recorded history, must be called with the mutex held */
+		bool wdump() throw();
+
+		/** copy @c n characters into the ring at offset @c pos */
+		void rput( size_t pos, const void * data, size_t n ) throw();
+
+		/** copy @c n characters out of the ring from offset @c pos */
+		void rget( size_t pos, void * data, size_t n ) const throw();
+
+		// disallow copying
+		logflightrecorder( const logflightrecorder & );
+		logflightrecorder &operator =( const logflightrecorder & );
+
+	};
+
+} /* end of namespace logstreamxx */
+
+#endif /* !LOGSTREAMXX_LOGFLIGHTRECORDER_H */
+
@@ -0,0 +1,191 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logflusher.h"
+
+#include <algorithm>
+#include <ctime>
+#include <utility>
+#include <vector>
+#include <pthread.h>
+
+
+namespace logstreamxx {
+
+	namespace {
+
+		/** attached callback type */
+		typedef std::pair<logflusher::callback_t, void *> callback_pair_t;
+
+		/** attached callbacks, never deallocated so the timer thread
+		    can safely outlive static destruction */
+		std::vector<callback_pair_t> * callbacks = 0;
+
+		/** flag to indicate whether the timer thread is running */
+		bool running = false;
+
+		/** mutex to guard the attached callbacks */
+		pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+		/** condition to signal changes to the attached callbacks */
+		pthread_cond_t * cond = 0;
+
+		/** callback argument of the callback being run ( 0 if none ) */
+		void * current = 0;
+
+		/** timer thread */
+		pthread_t timer;
+
+	} /* end of anonymous namespace */
+
+
+	long long logflusher::now() throw() {
+
+		timespec ts;
+		clock_gettime( CLOCK_MONOTONIC, &ts );
+
+		return ( (long long) ts.tv_sec * 1000 ) + ( ts.tv_nsec / 1000000 );
+
+	}
+
+
+	void logflusher::attach( callback_t fn, void * arg ) throw() {
+
+		pthread_mutex_lock( &mutex );
+
+		// initialise on first use, timed waits use the monotonic clock
+		if ( callbacks == 0 ) {
+
+			callbacks = new std::vector<callback_pair_t>();
+			cond    = new pthread_cond_t;
+
+			pthread_condattr_t attr;
+			pthread_condattr_init( &attr );
+			pthread_condattr_setclock( &attr, CLOCK_MONOTONIC );
+			pthread_cond_init( cond, &attr );
+			pthread_condattr_destroy( &attr );
+
+		}
+
+		callbacks->push_back( callback_pair_t( fn, arg ) );
+
+		// start the timer thread if it's not running
+		if (! running ) {
+
+			pthread_attr_t attr;
+
+			pthread_attr_init( &attr );
+			pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+
+			running = ( pthread_create( &timer, &attr, &logflusher::run, 0 ) == 0 );
+			pthread_attr_destroy( &attr );
+
+		}
+
+		// wake up the timer thread to pick up the new callback
+		pthread_cond_broadcast( cond );
+		pthread_mutex_unlock( &mutex );
+
+	}
+
+
+	void logflusher::detach( void * arg ) throw() {
+
+		pthread_mutex_lock( &mutex );
+
+		for ( size_t i = 0; ( callbacks != 0 ) && ( i < callbacks->size() ); i++ ) {
+
+			if ( ( *callbacks )[i].second == arg ) {
+				callbacks->erase( callbacks->begin() + i );
+				pthread_cond_broadcast( cond );
+				break;
+			}
+
+		}
+
+		// wait for the callback if it is being run ( unless detached
+		// from within the callback itself )
+		while ( ( current == arg ) && running && (! pthread_equal( timer, pthread_self() ) ) ) {
+			pthread_cond_wait( cond, &mutex );
+		}
+
+		pthread_mutex_unlock( &mutex );
+
+	}
+
+
+	void * logflusher::run( void * ) throw() {
+
+		// callbacks to run, copied so they are run without the mutex
+		// held and a slow callback ( e.g. fdatasync() ) doesn't hold up
+		// the attach() and detach() calls
+		std::vector<callback_pair_t> due;
+
+		pthread_mutex_lock( &mutex );
+
+		while (! callbacks->empty() ) {
+
+			long long t    = now();
+			long long next = t + 1000;
+
+			due = *callbacks;
+
+			for ( size_t i = 0; i < due.size(); i++ ) {
+
+				// check - detached in the meantime?
+				if ( std::find( callbacks->begin(), callbacks->end(), due[i] ) == callbacks->end() ) {
+					continue;
+				}
+
+				// detach() waits for the callback to return
+				current = due[i].second;
+				pthread_mutex_unlock( &mutex );
+
+				long long n = due[i].first( due[i].second, t );
+
+				pthread_mutex_lock( &mutex );
+				current = 0;
+				pthread_cond_broadcast( cond );
+
+				next = std::min( next, n );
+
+			}
+
+			// wait until the next callback is due
+			if ( ( next > t ) && (! callbacks->empty() ) ) {
+
+				timespec ts;
+				ts.tv_sec  = next / 1000;
+				ts.tv_nsec = ( next % 1000 ) * 1000000;
+
+				pthread_cond_timedwait( cond, &mutex, &ts );
+
+			}
+
+		}
+
+		running = false;
+		pthread_mutex_unlock( &mutex );
+
+		return 0;
+
+	}
+
+} /* end of namespace logstreamxx */
+
@@ -0,0 +1,91 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTREAMXX_LOGFLUSHER_H
+#define LOGSTREAMXX_LOGFLUSHER_H
+
+
+namespace logstreamxx {
+
+	/**
+	*   @brief Flush timer class
+	*
+	*   Process-wide timer thread which runs periodic work for log
+	*   stream buffers and log sinks, writing out batched log records
+	*   ( see logstreambuf::lflush() ) and syncing log files to disk
+	*   ( see logfdsink::durability() ). The thread is started when the
+	*   first callback is attached and stops once the last one is
+	*   detached.
+	*
+	*   @note This is an internal class.
+	*
+	*/
+	class logflusher {
+	public:
+
+		/**
+		*   @brief timer callback type
+		*
+		*   Called from the timer thread with the attached argument and
+		*   the current time ( now() ), returns the time it is due next.
+		*
+		*/
+		typedef long long (*callback_t)( void * arg, long long now );
+
+		/**
+		*   @brief attach a timer callback
+		*   @param fn callback
+		*   @param arg callback argument, identifies the callback
+		*/
+		static void attach( callback_t fn, void * arg ) throw();
+
+		/**
+		*   @brief detach a timer callback
+		*   @param arg callback argument
+		*
+		*   Once this returns the timer thread no longer calls the
+		*   callback attached with @c arg, waiting for it to return if
+		*   it is being run. Callbacks are run without the timer lock
+		*   held so a slow callback doesn't hold up the others attaching
+		*   or detaching.
+		*
+		*/
+		static void detach( void * arg ) throw();
+
+		/**
+		*   @brief get the monotonic clock time
+		*   @return time in milliseconds
+		*/
+		static long long now() throw();
+
+
+	private:
+
+		/** timer thread main loop */
+		static void * run( void * arg ) throw();
+
+		// static class
+		logflusher();
+
+	};
+
+} /* end of namespace logstreamxx */
+
+#endif /* !LOGSTREAMXX_LOGFLUSHER_H */
+
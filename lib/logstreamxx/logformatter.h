@@ -0,0 +1,339 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTREAMXX_LOGFORMATTER_H
+#define LOGSTREAMXX_LOGFORMATTER_H
+
+#if __cplusplus >= 201103L
+
+#include <logstreamxx/lognumput.h>
+
+#include <cstddef>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <type_traits>
+
+
+/**
+*   @brief compile-time format string
+*   @param s format string literal
+*
+*   Wrap a format string literal into a type of its own so it can be
+*   parsed at compile time, e.g.
+*
+*   @code
+*   logger.info( LOGSTREAMXX_FMT( "user {} took {}ms" ), id, ms );
+*   @endcode
+*
+*   @sa logstreamxx::logformatter
+*
+*/
+#define LOGSTREAMXX_FMT( s ) \
+	[] { \
+		struct logstreamxx_format_t { \
+			static constexpr const char * str() { return s; } \
+			static constexpr size_t size() { return sizeof( s ) - 1; } \
+		}; \
+		return logstreamxx_format_t(); \
+	}()
+
+
+namespace logstreamxx {
+
+	/**
+	*   @brief Compile-time format string writer class
+	*
+	*   Format strings wrapped with LOGSTREAMXX_FMT() are parsed at
+	*   compile time into a writer which appends the literal segments
+	*   and the arguments straight into the stream buffer, without any
+	*   runtime parsing and without the per-insertion stream overhead
+	*   ( sentry objects, format flags, locale facets ).
+	*
+	*   Each @c {} is replaced with the next argument, @c {{ and @c }}
+	*   give literal braces. The number of arguments is checked against
+	*   the number of placeholders at compile time. Integers are written
+	*   in decimal, floating point numbers in the shortest form which
+	*   reads back as the same value, @c bool as @c true / @c false and
+	*   anything else with its @c operator<<.
+	*
+	*   @note This needs C++11 or later.
+	*
+	*   @sa logstream::logf()
+	*
+	*/
+	class logformatter {
+	public:
+
+		/** token type */
+		enum token_t {
+			t_end         = 0,    //!< end of the format string
+			t_placeholder = 1,    //!< {}
+			t_escape      = 2,    //!< {{ or }}
+			t_invalid     = 3     //!< unmatched brace
+		};
+
+		/**
+		*   @brief find the next brace
+		*   @param s format string
+		*   @param lo start position
+		*   @param hi end position
+		*   @return position of the first brace in [ @c lo, @c hi ) or
+		*           @c hi if there are none
+		*
+		*   This halves the range on each step to keep the compile-time
+		*   recursion depth logarithmic to the format string length.
+		*
+		*/
+		static constexpr size_t find( const char * s, size_t lo, size_t hi ) {
+			return ( hi - lo ) == 0 ? hi :
+				( hi - lo ) == 1 ? ( ( ( s[lo] == '{' ) || ( s[lo] == '}' ) ) ? lo : hi ) :
+				first( find( s, lo, lo + ( ( hi - lo ) / 2 ) ), lo + ( ( hi - lo ) / 2 ), hi, s );
+		}
+
+		/**
+		*   @brief get the token type at a position
+		*   @param s format string
+		*   @param p position of a brace or the end of the string
+		*   @param n format string length
+		*   @return token type
+		*/
+		static constexpr token_t token( const char * s, size_t p, size_t n ) {
+			return ( p >= n ) ? t_end :
+				( ( p + 1 ) >= n ) ? t_invalid :
+				( ( s[p] == '{' ) && ( s[p + 1] == '}' ) ) ? t_placeholder :
+				( s[p] == s[p + 1] ) ? t_escape : t_invalid;
+		}
+
+		/**
+		*   @brief count the placeholders
+		*   @param s format string
+		*   @param p start position
+		*   @param n format string length
+		*   @return number of placeholders, negative if the format
+		*           string is invalid
+		*/
+		static constexpr int placeholders( const char * s, size_t p, size_t n ) {
+			return placeholders( s, find( s, p, n ), n, token( s, find( s, p, n ), n ) );
+		}
+
+		/**
+		*   @brief write out a log record
+		*   @param os output stream
+		*   @param args arguments
+		*
+		*   Write the format string @c F with the arguments substituted,
+		*   followed by a new line, and sync the stream buffer.
+		*
+		*/
+		template<typename F, typename... Args>
+		static void write( std::ostream &os, const Args &... args ) throw();
+
+		/** append an argument */
+		static void put( std::ostream &os, bool v ) throw();
+		static void put( std::ostream &os, char v ) throw();
+		static void put( std::ostream &os, const char * v ) throw();
+		static void put( std::ostream &os, const std::string &v ) throw();
+
+		template<typename T>
+		static typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+		put( std::ostream &os, T v ) throw();
+
+		template<typename T>
+		static typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type
+		put( std::ostream &os, T v ) throw();
+
+		template<typename T>
+		static typename std::enable_if<std::is_floating_point<T>::value>::type
+		put( std::ostream &os, T v ) throw();
+
+		template<typename T>
+		static typename std::enable_if<! std::is_arithmetic<T>::value>::type
+		put( std::ostream &os, const T &v ) throw();
+
+
+	private:
+
+		/** writer for the format string @c F from position @c P */
+		template<typename F, size_t P, token_t T = token( F::str(), find( F::str(), P, F::size() ), F::size() )>
+		struct writer;
+
+		/** pick the brace found in the first half, if any */
+		static constexpr size_t first( size_t a, size_t mid, size_t hi, const char * s ) {
+			return ( a != mid ) ? a : find( s, mid, hi );
+		}
+
+		/** count the placeholders from a token onwards */
+		static constexpr int placeholders( const char * s, size_t p, size_t n, token_t t ) {
+			return ( t == t_end ) ? 0 :
+				( t == t_invalid ) ? -1 :
+				add( ( t == t_placeholder ) ? 1 : 0, placeholders( s, p + 2, n ) );
+		}
+
+		/** add up placeholder counts, keeping the invalid state */
+		static constexpr int add( int a, int b ) {
+			return ( b < 0 ) ? b : ( a + b );
+		}
+
+		/** write a literal segment */
+		static void literal( std::ostream &os, const char * s, size_t n ) throw() {
+			if ( n > 0 ) {
+				os.rdbuf()->sputn( s, n );
+			}
+		}
+
+	};
+
+
+	/** end of the format string */
+	template<typename F, size_t P>
+	struct logformatter::writer<F, P, logformatter::t_end> {
+
+		static void write( std::ostream &os ) throw() {
+			literal( os, F::str() + P, F::size() - P );
+		}
+
+	};
+
+
+	/** placeholder, write the segment before it and the next argument */
+	template<typename F, size_t P>
+	struct logformatter::writer<F, P, logformatter::t_placeholder> {
+
+		static constexpr size_t brace = find( F::str(), P, F::size() );
+
+		template<typename A, typename... Args>
+		static void write( std::ostream &os, const A &arg, const Args &... args ) throw() {
+			literal( os, F::str() + P, brace - P );
+			put( os, arg );
+			writer<F, brace + 2>::write( os, args... );
+		}
+
+	};
+
+
+	/** escaped brace, write the segment before it including one brace */
+	template<typename F, size_t P>
+	struct logformatter::writer<F, P, logformatter::t_escape> {
+
+		static constexpr size_t brace = find( F::str(), P, F::size() );
+
+		template<typename... Args>
+		static void write( std::ostream &os, const Args &... args ) throw() {
+			literal( os, F::str() + P, ( brace - P ) + 1 );
+			writer<F, brace + 2>::write( os, args... );
+		}
+
+	};
+
+
+	template<typename F, typename... Args>
+	inline void logformatter::write( std::ostream &os, const Args &... args ) throw() {
+
+		static_assert( placeholders( F::str(), 0, F::size() ) >= 0, "invalid format string, unmatched brace" );
+		static_assert( placeholders( F::str(), 0, F::size() ) == sizeof...( Args ),
+				"number of arguments does not match the format string" );
+
+		writer<F, 0>::write( os, args... );
+
+		// end of the log record
+		os.rdbuf()->sputc( '\n' );
+		os.rdbuf()->pubsync();
+
+	}
+
+
+	inline void logformatter::put( std::ostream &os, bool v ) throw() {
+		if ( v ) {
+			os.rdbuf()->sputn( "true", 4 );
+		} else {
+			os.rdbuf()->sputn( "false", 5 );
+		}
+	}
+
+
+	inline void logformatter::put( std::ostream &os, char v ) throw() {
+		os.rdbuf()->sputc( v );
+	}
+
+
+	inline void logformatter::put( std::ostream &os, const char * v ) throw() {
+		if ( v != 0 ) {
+			os.rdbuf()->sputn( v, std::char_traits<char>::length( v ) );
+		}
+	}
+
+
+	inline void logformatter::put( std::ostream &os, const std::string &v ) throw() {
+		os.rdbuf()->sputn( v.data(), v.length() );
+	}
+
+
+	template<typename T>
+	inline typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+	logformatter::put( std::ostream &os, T v ) throw() {
+
+		char buffer[24];
+		char * end = buffer + sizeof( buffer );
+		char * p   = lognumput::utoa( end, ( v < 0 ) ? ( 0 - (unsigned long long) v ) : (unsigned long long) v );
+
+		if ( v < 0 ) {
+			*--p = '-';
+		}
+
+		os.rdbuf()->sputn( p, end - p );
+
+	}
+
+
+	template<typename T>
+	inline typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type
+	logformatter::put( std::ostream &os, T v ) throw() {
+
+		char buffer[24];
+		char * end = buffer + sizeof( buffer );
+		char * p   = lognumput::utoa( end, v );
+
+		os.rdbuf()->sputn( p, end - p );
+
+	}
+
+
+	template<typename T>
+	inline typename std::enable_if<std::is_floating_point<T>::value>::type
+	logformatter::put( std::ostream &os, T v ) throw() {
+
+		char buffer[32];
+		os.rdbuf()->sputn( buffer, lognumput::dtoa( buffer, v, 17 ) );
+
+	}
+
+
+	template<typename T>
+	inline typename std::enable_if<! std::is_arithmetic<T>::value>::type
+	logformatter::put( std::ostream &os, const T &v ) throw() {
+		os << v;
+	}
+
+} /* end of namespace logstreamxx */
+
+#endif /* __cplusplus >= 201103L */
+
+#endif /* !LOGSTREAMXX_LOGFORMATTER_H */
+
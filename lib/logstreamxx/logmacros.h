@@ -0,0 +1,170 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTREAMXX_LOGMACROS_H
+#define LOGSTREAMXX_LOGMACROS_H
+
+#include <logstreamxx/logstream.h>
+
+
+/**
+*   @brief log at a priority only if enabled
+*   @param logger logstreamxx::logstream instance
+*   @param p log priority
+*
+*   Set the log priority of @c logger to @c p and continue with the
+*   stream expression only if logging is enabled for @c p. When it
+*   is not, none of the following @c << operands are evaluated.
+*
+*   @code
+*   LOGSTREAMXX_LOG( logger, logstreamxx::priority::debug ) << "state: " << dump() << std::endl;
+*   @endcode
+*
+*/
+#define LOGSTREAMXX_LOG( logger, p ) \
+	if ( ( ( p ) > LOGSTREAMXX_LOGLEVEL ) || (! ( logger ).enabled( p ) ) ) {} else ( logger ) << ( p )
+
+/**
+*   @brief discarded log statement
+*
+*   The stream expression is still type checked but the dead branch is
+*   removed by the compiler, along with any string literals and calls
+*   within it, even without optimisations.
+*
+*/
+#define LOGSTREAMXX_NOLOG( logger, p ) \
+	if ( true ) {} else ( logger ) << ( p )
+
+#define LOGSTREAMXX_EMERG( logger ) LOGSTREAMXX_LOG( logger, logstreamxx::priority::emerg )    //!< log at emergency priority
+
+#if LOGSTREAMXX_LOGLEVEL >= 1
+#define LOGSTREAMXX_ALERT( logger ) LOGSTREAMXX_LOG( logger, logstreamxx::priority::alert )    //!< log at alert priority
+#else
+#define LOGSTREAMXX_ALERT( logger ) LOGSTREAMXX_NOLOG( logger, logstreamxx::priority::alert )
+#endif
+
+#if LOGSTREAMXX_LOGLEVEL >= 2
+#define LOGSTREAMXX_CRIT( logger ) LOGSTREAMXX_LOG( logger, logstreamxx::priority::crit )    //!< log at critical priority
+#else
+#define LOGSTREAMXX_CRIT( logger ) LOGSTREAMXX_NOLOG( logger, logstreamxx::priority::crit )
+#endif
+
+#if LOGSTREAMXX_LOGLEVEL >= 3
+#define LOGSTREAMXX_ERR( logger ) LOGSTREAMXX_LOG( logger, logstreamxx::priority::err )    //!< log at error priority
+#else
+#define LOGSTREAMXX_ERR( logger ) LOGSTREAMXX_NOLOG( logger, logstreamxx::priority::err )
+#endif
+
+#if LOGSTREAMXX_LOGLEVEL >= 4
+#define LOGSTREAMXX_WARNING( logger ) LOGSTREAMXX_LOG( logger, logstreamxx::priority::warning )    //!< log at warning priority
+#else
+#define LOGSTREAMXX_WARNING( logger ) LOGSTREAMXX_NOLOG( logger, logstreamxx::priority::warning )
+#endif
+
+#if LOGSTREAMXX_LOGLEVEL >= 5
+#define LOGSTREAMXX_NOTICE( logger ) LOGSTREAMXX_LOG( logger, logstreamxx::priority::notice )    //!< log at notice priority
+#else
+#define LOGSTREAMXX_NOTICE( logger ) LOGSTREAMXX_NOLOG( logger, logstreamxx::priority::notice )
+#endif
+
+#if LOGSTREAMXX_LOGLEVEL >= 6
+#define LOGSTREAMXX_INFO( logger ) LOGSTREAMXX_LOG( logger, logstreamxx::priority::info )    //!< log at info priority
+#else
+#define LOGSTREAMXX_INFO( logger ) LOGSTREAMXX_NOLOG( logger, logstreamxx::priority::info )
+#endif
+
+#if LOGSTREAMXX_LOGLEVEL >= 7
+#define LOGSTREAMXX_DEBUG( logger ) LOGSTREAMXX_LOG( logger, logstreamxx::priority::debug )    //!< log at debug priority
+#else
+#define LOGSTREAMXX_DEBUG( logger ) LOGSTREAMXX_NOLOG( logger, logstreamxx::priority::debug )
+#endif
+
+#if __cplusplus >= 201103L
+/**
+*   @brief log a compile-time format string at a priority only if enabled
+*   @param logger logstreamxx::logstream instance
+*   @param p log priority
+*   @param format format string literal
+*
+*   Same as logstream::logf() with the format string parsed at compile
+*   time, except that the arguments are not evaluated unless logging
+*   is enabled for @c p.
+*
+*   @code
+*   LOGSTREAMXX_LOGF( logger, logstreamxx::priority::info, "user {} took {}ms", id, ms );
+*   @endcode
+*
+*/
+#define LOGSTREAMXX_LOGF( logger, p, format, ... ) \
+	if ( ( ( p ) > LOGSTREAMXX_LOGLEVEL ) || (! ( logger ).enabled( p ) ) ) {} else \
+		( logger ).logf( ( p ), LOGSTREAMXX_FMT( format ), ##__VA_ARGS__ )
+
+/**
+*   @brief discarded compile-time format string log statement
+*/
+#define LOGSTREAMXX_NOLOGF( logger, p, format, ... ) \
+	if ( true ) {} else ( logger ).logf( ( p ), LOGSTREAMXX_FMT( format ), ##__VA_ARGS__ )
+
+#define LOGSTREAMXX_EMERGF( logger, ... ) LOGSTREAMXX_LOGF( logger, logstreamxx::priority::emerg, __VA_ARGS__ )    //!< log at emergency priority
+
+#if LOGSTREAMXX_LOGLEVEL >= 1
+#define LOGSTREAMXX_ALERTF( logger, ... ) LOGSTREAMXX_LOGF( logger, logstreamxx::priority::alert, __VA_ARGS__ )    //!< log at alert priority
+#else
+#define LOGSTREAMXX_ALERTF( logger, ... ) LOGSTREAMXX_NOLOGF( logger, logstreamxx::priority::alert, __VA_ARGS__ )
+#endif
+
+#if LOGSTREAMXX_LOGLEVEL >= 2
+#define LOGSTREAMXX_CRITF( logger, ... ) LOGSTREAMXX_LOGF( logger, logstreamxx::priority::crit, __VA_ARGS__ )    //!< log at critical priority
+#else
+#define LOGSTREAMXX_CRITF( logger, ... ) LOGSTREAMXX_NOLOGF( logger, logstreamxx::priority::crit, __VA_ARGS__ )
+#endif
+
+#if LOGSTREAMXX_LOGLEVEL >= 3
+#define LOGSTREAMXX_ERRF( logger, ... ) LOGSTREAMXX_LOGF( logger, logstreamxx::priority::err, __VA_ARGS__ )    //!< log at error priority
+#else
+#define LOGSTREAMXX_ERRF( logger, ... ) LOGSTREAMXX_NOLOGF( logger, logstreamxx::priority::err, __VA_ARGS__ )
+#endif
+
+#if LOGSTREAMXX_LOGLEVEL >= 4
+#define LOGSTREAMXX_WARNINGF( logger, ... ) LOGSTREAMXX_LOGF( logger, logstreamxx::priority::warning, __VA_ARGS__ )    //!< log at warning priority
+#else
+#define LOGSTREAMXX_WARNINGF( logger, ... ) LOGSTREAMXX_NOLOGF( logger, logstreamxx::priority::warning, __VA_ARGS__ )
+#endif
+
+#if LOGSTREAMXX_LOGLEVEL >= 5
+#define LOGSTREAMXX_NOTICEF( logger, ... ) LOGSTREAMXX_LOGF( logger, logstreamxx::priority::notice, __VA_ARGS__ )    //!< log at notice priority
+#else
+#define LOGSTREAMXX_NOTICEF( logger, ... ) LOGSTREAMXX_NOLOGF( logger, logstreamxx::priority::notice, __VA_ARGS__ )
+#endif
+
+#if LOGSTREAMXX_LOGLEVEL >= 6
+#define LOGSTREAMXX_INFOF( logger, ... ) LOGSTREAMXX_LOGF( logger, logstreamxx::priority::info, __VA_ARGS__ )    //!< log at info priority
+#else
+#define LOGSTREAMXX_INFOF( logger, ... ) LOGSTREAMXX_NOLOGF( logger, logstreamxx::priority::info, __VA_ARGS__ )
+#endif
+
+#if LOGSTREAMXX_LOGLEVEL >= 7
+#define LOGSTREAMXX_DEBUGF( logger, ... ) LOGSTREAMXX_LOGF( logger, logstreamxx::priority::debug, __VA_ARGS__ )    //!< log at debug priority
+#else
+#define LOGSTREAMXX_DEBUGF( logger, ... ) LOGSTREAMXX_NOLOGF( logger, logstreamxx::priority::debug, __VA_ARGS__ )
+#endif
+#endif /* __cplusplus >= 201103L */
+
+#endif /* !LOGSTREAMXX_LOGMACROS_H */
+
@@ -0,0 +1,78 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logmemsink.h"
+
+
+namespace logstreamxx {
+
+	logmemsink::logmemsink( size_t capacity ) throw() : _capacity( capacity ) {
+		pthread_mutex_init( &_mutex, 0 );
+	}
+
+
+	logmemsink::~logmemsink() throw() {
+		pthread_mutex_destroy( &_mutex );
+	}
+
+
+	bool logmemsink::write( const priority::log_priority_t &, const iovec * iov, int iovcnt ) throw() {
+
+		pthread_mutex_lock( &_mutex );
+
+		for ( int i = 0; i < iovcnt; i++ ) {
+			_data.append( (const char *) iov[i].iov_base, iov[i].iov_len );
+		}
+
+		// check - discard the oldest log records to fit the capacity
+		if ( ( _capacity > 0 ) && ( _data.length() > _capacity ) ) {
+
+			size_t pos = _data.find( '\n', _data.length() - _capacity - 1 );
+			_data.erase( 0, ( pos == std::string::npos ) ? _data.length() : pos + 1 );
+
+		}
+
+		pthread_mutex_unlock( &_mutex );
+
+		return true;
+
+	}
+
+
+	std::string logmemsink::str() const throw() {
+
+		pthread_mutex_lock( &_mutex );
+		std::string data = _data;
+		pthread_mutex_unlock( &_mutex );
+
+		return data;
+
+	}
+
+
+	void logmemsink::clear() throw() {
+
+		pthread_mutex_lock( &_mutex );
+		_data.clear();
+		pthread_mutex_unlock( &_mutex );
+
+	}
+
+} /* end of namespace logstreamxx */
+
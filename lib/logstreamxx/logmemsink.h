@@ -0,0 +1,90 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTREAMXX_LOGMEMSINK_H
+#define LOGSTREAMXX_LOGMEMSINK_H
+
+#include <logstreamxx/logsink.h>
+
+#include <cstddef>
+#include <string>
+#include <pthread.h>
+
+
+namespace logstreamxx {
+
+	/**
+	*   @brief Memory log sink class
+	*
+	*   Keeps log records in memory, e.g. for tests or to expose recent
+	*   log records through a diagnostics interface. If a capacity is set
+	*   then the oldest log records are discarded to make space for new
+	*   ones.
+	*
+	*/
+	class logmemsink : public logsink {
+	public:
+
+		/**
+		*   @brief constructor
+		*   @param capacity maximum number of characters to keep
+		*                   ( 0 for unlimited )
+		*/
+		logmemsink( size_t capacity = 0 ) throw();
+
+		/**
+		*   @brief destructor
+		*/
+		virtual ~logmemsink() throw();
+
+		/**
+		*   @brief write a log record
+		*   @sa logsink::write()
+		*/
+		virtual bool write( const priority::log_priority_t &p, const iovec * iov, int iovcnt ) throw();
+
+		/**
+		*   @brief get the log records
+		*   @return log records kept in memory
+		*/
+		std::string str() const throw();
+
+		/**
+		*   @brief discard all the log records kept in memory
+		*/
+		void clear() throw();
+
+
+	private:
+
+		/** maximum number of characters to keep */
+		size_t _capacity;
+
+		/** log records */
+		std::string _data;
+
+		/** mutex to serialise access to the log records */
+		mutable pthread_mutex_t _mutex;
+
+	};
+
+} /* end of namespace logstreamxx */
+
+#endif /* !LOGSTREAMXX_LOGMEMSINK_H */
+
@@ -0,0 +1,247 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logmmap.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace logstreamxx {
+
+	logmmap::logmmap( const char * filename, bool append, mode_t mode, size_t chunk ) throw( logexception ) :
+			_fd( -1 ), _chunk( chunk ), _length( 0 ), _allocated( 0 ), _map( 0 ), _offset( 0 ) {
+
+		// sanity check
+		if ( _chunk == 0 ) {
+			throw logexception( "Invalid chunk size" );
+		}
+
+		// round up the chunk size to the page size
+		size_t page = sysconf( _SC_PAGESIZE );
+		_chunk = ( ( _chunk + page - 1 ) / page ) * page;
+
+		// set file open flags
+		int flags = O_RDWR | O_CREAT;
+
+		// truncate file?
+		if (! append ) {
+			flags |= O_TRUNC;
+		}
+
+		// open file
+		_fd = ::open( filename, flags, mode );
+
+		// check - was the open file successful?
+		if ( _fd == -1 ) {
+			// throw a log exception with system message
+			throw logexception();
+		}
+
+		// current log file length
+		struct stat st;
+		if ( fstat( _fd, &st ) == 0 ) {
+			_length = _allocated = st.st_size;
+		}
+
+		// find the end of the log data, the preallocated space after it
+		// is left as NUL padding if the log file wasn't closed cleanly
+		char buffer[4096];
+
+		while ( _length > 0 ) {
+
+			off_t from = ( _length > (off_t) sizeof( buffer ) ) ? _length - sizeof( buffer ) : 0;
+			size_t n = _length - from;
+
+			if ( pread( _fd, buffer, n, from ) != (ssize_t) n ) {
+				break;
+			}
+
+			while ( ( n > 0 ) && ( buffer[n - 1] == '\0' ) ) {
+				n--;
+			}
+
+			_length = from + n;
+
+			// check - found the end of the log data?
+			if ( n > 0 ) {
+				break;
+			}
+
+		}
+
+		// map the first chunk
+		if (! remap() ) {
+
+			logexception e;
+			::close( _fd );
+
+			throw e;
+
+		}
+
+		pthread_mutex_init( &_mutex, 0 );
+
+	}
+
+
+	logmmap::~logmmap() throw() {
+
+		// unmap
+		if ( _map != 0 ) {
+			munmap( _map, _chunk );
+		}
+
+		// truncate the preallocated space and close the log file
+		if ( ftruncate( _fd, _length ) != 0 ) {
+			// nothing we can do here
+		}
+
+		::close( _fd );
+		pthread_mutex_destroy( &_mutex );
+
+	}
+
+
+	bool logmmap::remap() throw() {
+
+		// unmap the current chunk
+		if ( _map != 0 ) {
+			munmap( _map, _chunk );
+			_map = 0;
+		}
+
+		// map from the page containing the current length
+		size_t page = sysconf( _SC_PAGESIZE );
+		off_t offset = ( _length / page ) * page;
+
+		// extend the log file to cover the mapping
+		if ( ( offset + (off_t) _chunk ) > _allocated ) {
+
+			if ( ( errno = posix_fallocate( _fd, _allocated, ( offset + _chunk ) - _allocated ) ) != 0 ) {
+				return false;
+			}
+
+			_allocated = offset + _chunk;
+
+		}
+
+		void * map = mmap( 0, _chunk, PROT_WRITE, MAP_SHARED, _fd, offset );
+
+		if ( map == MAP_FAILED ) {
+			return false;
+		}
+
+		_map    = (char *) map;
+		_offset = offset;
+
+		return true;
+
+	}
+
+
+	bool logmmap::write( const iovec * iov, int iovcnt ) throw() {
+
+		bool ret = true;
+
+		pthread_mutex_lock( &_mutex );
+
+		// start of the log record, to roll back to on failure
+		off_t start = _length;
+
+		for ( int i = 0; ( i < iovcnt ) && ret; i++ ) {
+
+			const char * data = (const char *) iov[i].iov_base;
+			size_t n = iov[i].iov_len;
+
+			while ( n > 0 ) {
+
+				// check - is the current mapping full?
+				if ( ( _map == 0 ) || ( ( _length - _offset ) >= (off_t) _chunk ) ) {
+					if (! remap() ) {
+						ret = false;
+						break;
+					}
+				}
+
+				// copy as much as fits into the current mapping
+				size_t space = _chunk - ( _length - _offset );
+				size_t c = ( n < space ) ? n : space;
+
+				memcpy( _map + ( _length - _offset ), data, c );
+
+				_length += c;
+				data    += c;
+				n       -= c;
+
+			}
+
+		}
+
+		// roll back a partially written log record
+		if (! ret ) {
+
+			char zeros[256];
+			memset( zeros, 0, sizeof( zeros ) );
+
+			for ( off_t pos = start; pos < _length; ) {
+
+				size_t c = ( ( _length - pos ) < (off_t) sizeof( zeros ) ) ? ( _length - pos ) : sizeof( zeros );
+				ssize_t w = pwrite( _fd, zeros, c, pos );
+
+				if ( w <= 0 ) {
+					break;
+				}
+
+				pos += w;
+
+			}
+
+			_length = start;
+
+		}
+
+		pthread_mutex_unlock( &_mutex );
+
+		return ret;
+
+	}
+
+
+	bool logmmap::write( const priority::log_priority_t &, const iovec * iov, int iovcnt ) throw() {
+		return write( iov, iovcnt );
+	}
+
+
+	size_t logmmap::length() const throw() {
+
+		pthread_mutex_lock( &_mutex );
+		size_t length = _length;
+		pthread_mutex_unlock( &_mutex );
+
+		return length;
+
+	}
+
+} /* end of namespace logstreamxx */
+
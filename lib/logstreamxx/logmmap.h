@@ -0,0 +1,143 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTREAMXX_LOGMMAP_H
+#define LOGSTREAMXX_LOGMMAP_H
+
+#include <logstreamxx/logsink.h>
+#include <logstreamxx/logexception.h>
+
+#include <cstddef>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#ifndef LOGMMAP_CHUNK_SIZE
+#define LOGMMAP_CHUNK_SIZE 4194304
+#endif
+
+
+namespace logstreamxx {
+
+	/**
+	*   @brief Memory-mapped log file class
+	*
+	*   Maps a preallocated region of the log file into memory so log
+	*   records are written out by copying them into the mapping instead
+	*   of with a system call. The log file is extended ( allocated with
+	*   @c posix_fallocate() ) and remapped in chunks as it fills, and
+	*   is truncated to the real length on close.
+	*
+	*   @note Readers following the log file ( e.g. @c tail ) will see
+	*         the preallocated space as null characters until the log
+	*         file is closed.
+	*
+	*/
+	class logmmap : public logsink {
+	public:
+
+		/**
+		*   @brief constructor
+		*   @param filename log file name
+		*   @param append boolean flag to indicate whether to append to
+		*                 the log file or truncate the file if already
+		*                 exists
+		*
+		*   @param mode file mode to open the log file with
+		*   @param chunk size to extend and map the log file by
+		*                ( rounded up to the page size )
+		*
+		*   Open and map @c filename for writing. The file will be
+		*   created if it doesn't exist.
+		*
+		*/
+		logmmap( const char * filename, bool append = true, mode_t mode = 00644,
+				size_t chunk = LOGMMAP_CHUNK_SIZE ) throw( logexception );
+
+		/**
+		*   @brief destructor
+		*
+		*   Unmap the log file, truncate it to the length written and
+		*   close it.
+		*
+		*/
+		virtual ~logmmap() throw();
+
+		/**
+		*   @brief write a log record
+		*   @param iov log record parts
+		*   @param iovcnt number of log record parts
+		*   @return boolean @c true on success or @c false if the log
+		*           file couldn't be extended
+		*
+		*   Copy the @c iovcnt parts described by @c iov into the mapped
+		*   log file as a single log record. This is thread-safe.
+		*
+		*/
+		bool write( const iovec * iov, int iovcnt ) throw();
+
+		/**
+		*   @brief write a log record
+		*   @sa logsink::write(), write( const iovec *, int )
+		*/
+		virtual bool write( const priority::log_priority_t &p, const iovec * iov, int iovcnt ) throw();
+
+		/**
+		*   @brief get the log file length
+		*   @return number of characters written to the log file
+		*/
+		size_t length() const throw();
+
+
+	private:
+
+		/** log file descriptor */
+		int _fd;
+
+		/** map chunk size */
+		size_t _chunk;
+
+		/** log file length */
+		off_t _length;
+
+		/** allocated log file size */
+		off_t _allocated;
+
+		/** current mapping */
+		char * _map;
+
+		/** log file offset of the current mapping */
+		off_t _offset;
+
+		/** mutex to serialise writers */
+		mutable pthread_mutex_t _mutex;
+
+		/** map the next chunk of the log file */
+		bool remap() throw();
+
+		// disallow copying
+		logmmap( const logmmap & );
+		logmmap &operator =( const logmmap & );
+
+	};
+
+} /* end of namespace logstreamxx */
+
+#endif /* !LOGSTREAMXX_LOGMMAP_H */
+
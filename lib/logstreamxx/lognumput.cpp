@@ -0,0 +1,324 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "lognumput.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+
+namespace logstreamxx {
+
+	namespace {
+
+		/** two digit lookup table, "00" to "99" */
+		const char digits[201] =
+			"0001020304050607080910111213141516171819"
+			"2021222324252627282930313233343536373839"
+			"4041424344454647484950515253545556575859"
+			"6061626364656667686970717273747576777879"
+			"8081828384858687888990919293949596979899";
+
+		/** exact powers of ten */
+		const double powers[] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+			1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17
+		};
+
+		/** largest integer a double holds exactly ( 2^53 ) */
+		const double exact = 9007199254740992.0;
+
+	} /* end of anonymous namespace */
+
+
+	lognumput::lognumput( size_t refs ) : std::num_put<char>( refs ) {
+
+	}
+
+
+	lognumput::~lognumput() {
+
+	}
+
+
+	char * lognumput::utoa( char * end, unsigned long long v ) throw() {
+
+		char * p = end;
+
+		while ( v >= 100 ) {
+
+			const char * d = digits + ( ( v % 100 ) * 2 );
+			v /= 100;
+
+			*--p = d[1];
+			*--p = d[0];
+
+		}
+
+		if ( v >= 10 ) {
+			*--p = digits[( v * 2 ) + 1];
+			*--p = digits[v * 2];
+		} else {
+			*--p = '0' + v;
+		}
+
+		return p;
+
+	}
+
+
+	size_t lognumput::dtoa( char * buffer, double v, int precision ) throw() {
+
+		// %g treats a precision of 0 as 1
+		int p = ( precision > 0 ) ? precision : 1;
+		bool shortest = ( p >= 17 );
+
+		// sanity check - non-finite values go the printf() way
+		bool finite = ( v == v ) && ( ( v - v ) == 0 );
+
+		if ( finite ) {
+
+			bool negative = ( copysign( 1.0, v ) < 0 );
+			double a = negative ? -v : v;
+
+			// fraction digits the fixed notation can have
+			int kmax = shortest ? 17 : ( ( p < 14 ) ? ( p + 3 ) : 17 );
+
+			// look for an exact short decimal representation, digits * 10^-k
+			for ( int k = 0; k <= kmax; k++ ) {
+
+				double s = a * powers[k];
+
+				if ( s >= exact ) {
+					break;
+				}
+
+				unsigned long long u = (unsigned long long) s;
+
+				// check - does it read back as the same value?
+				if ( ( (double) u != s ) || ( ( s / powers[k] ) != a ) ) {
+					continue;
+				}
+
+				// drop trailing fraction zeros
+				while ( ( k > 0 ) && ( u != 0 ) && ( ( u % 10 ) == 0 ) ) {
+					u /= 10;
+					k--;
+				}
+
+				char d[24];
+				char * start = utoa( d + sizeof( d ), u );
+				int nd = ( d + sizeof( d ) ) - start;
+
+				// significant digits and the decimal exponent
+				int sig = nd;
+				while ( ( sig > 1 ) && ( start[sig - 1] == '0' ) ) {
+					sig--;
+				}
+
+				int x = ( u == 0 ) ? 0 : ( nd - k - 1 );
+
+				// check - would %g use the fixed notation with these digits?
+				if ( ( sig > p ) || ( x < -4 ) || ( x >= ( shortest ? 17 : p ) ) ) {
+					break;
+				}
+
+				char * out = buffer;
+
+				if ( negative ) {
+					*out++ = '-';
+				}
+
+				if ( k == 0 ) {
+					memcpy( out, start, nd );
+					out += nd;
+				} else if ( nd > k ) {
+					memcpy( out, start, nd - k );
+					out += nd - k;
+					*out++ = '.';
+					memcpy( out, start + ( nd - k ), k );
+					out += k;
+				} else {
+					*out++ = '0';
+					*out++ = '.';
+					memset( out, '0', k - nd );
+					out += k - nd;
+					memcpy( out, start, nd );
+					out += nd;
+				}
+
+				return out - buffer;
+
+			}
+
+		}
+
+		int n = 0;
+
+		// shortest of 15, 16 or 17 significant digits which reads back
+		// as the same value, or the requested significant digits
+		for ( p = ( shortest ? 15 : p ); ; p++ ) {
+
+			n = snprintf( buffer, 32, "%.*g", p, v );
+
+			if ( (! shortest ) || ( p >= 17 ) || ( strtod( buffer, 0 ) == v ) ) {
+				break;
+			}
+
+		}
+
+		// decimal point is locale dependent
+		for ( int i = 0; finite && ( i < n ); i++ ) {
+			if ( ( ( buffer[i] < '0' ) || ( buffer[i] > '9' ) ) && ( buffer[i] != '-' ) &&
+					( buffer[i] != '+' ) && ( buffer[i] != 'e' ) ) {
+				buffer[i] = '.';
+			}
+		}
+
+		return n;
+
+	}
+
+
+	bool lognumput::fast( const std::ios_base &io ) throw() {
+
+		const std::ios_base::fmtflags slow = std::ios_base::showpos | std::ios_base::showbase |
+				std::ios_base::showpoint | std::ios_base::floatfield;
+
+		return ( ( io.flags() & slow ) == 0 ) && ( io.width() == 0 );
+
+	}
+
+
+	lognumput::iter_t lognumput::put( iter_t out, const std::ios_base &io, unsigned long long v, bool negative ) {
+
+		char buffer[24];
+		char * end   = buffer + sizeof( buffer );
+		char * start = end;
+
+		std::ios_base::fmtflags base = io.flags() & std::ios_base::basefield;
+
+		if ( base == std::ios_base::hex ) {
+
+			const char * hex = ( io.flags() & std::ios_base::uppercase ) ? "0123456789ABCDEF" : "0123456789abcdef";
+
+			do {
+				*--start = hex[v & 0xf];
+				v >>= 4;
+			} while ( v != 0 );
+
+		} else if ( base == std::ios_base::oct ) {
+
+			do {
+				*--start = '0' + ( v & 7 );
+				v >>= 3;
+			} while ( v != 0 );
+
+		} else {
+
+			start = utoa( end, v );
+
+			if ( negative ) {
+				*--start = '-';
+			}
+
+		}
+
+		return std::copy( start, end, out );
+
+	}
+
+
+	lognumput::iter_t lognumput::do_put( iter_t out, std::ios_base &io, char fill, long v ) const {
+
+		// check - anything other than the plain formatting?
+		if (! fast( io ) ) {
+			return std::num_put<char>::do_put( out, io, fill, v );
+		}
+
+		// signed only in decimal, like the standard formatting
+		if ( ( v < 0 ) && ( ( io.flags() & ( std::ios_base::hex | std::ios_base::oct ) ) == 0 ) ) {
+			return put( out, io, 0 - (unsigned long long) v, true );
+		}
+
+		return put( out, io, (unsigned long) v, false );
+
+	}
+
+
+	lognumput::iter_t lognumput::do_put( iter_t out, std::ios_base &io, char fill, unsigned long v ) const {
+
+		// check - anything other than the plain formatting?
+		if (! fast( io ) ) {
+			return std::num_put<char>::do_put( out, io, fill, v );
+		}
+
+		return put( out, io, v, false );
+
+	}
+
+
+	lognumput::iter_t lognumput::do_put( iter_t out, std::ios_base &io, char fill, long long v ) const {
+
+		// check - anything other than the plain formatting?
+		if (! fast( io ) ) {
+			return std::num_put<char>::do_put( out, io, fill, v );
+		}
+
+		// signed only in decimal, like the standard formatting
+		if ( ( v < 0 ) && ( ( io.flags() & ( std::ios_base::hex | std::ios_base::oct ) ) == 0 ) ) {
+			return put( out, io, 0 - (unsigned long long) v, true );
+		}
+
+		return put( out, io, (unsigned long long) v, false );
+
+	}
+
+
+	lognumput::iter_t lognumput::do_put( iter_t out, std::ios_base &io, char fill, unsigned long long v ) const {
+
+		// check - anything other than the plain formatting?
+		if (! fast( io ) ) {
+			return std::num_put<char>::do_put( out, io, fill, v );
+		}
+
+		return put( out, io, v, false );
+
+	}
+
+
+	lognumput::iter_t lognumput::do_put( iter_t out, std::ios_base &io, char fill, double v ) const {
+
+		// check - anything other than the plain formatting?
+		if ( (! fast( io ) ) || ( io.flags() & std::ios_base::uppercase ) ) {
+			return std::num_put<char>::do_put( out, io, fill, v );
+		}
+
+		char buffer[32];
+		size_t n = dtoa( buffer, v, io.precision() );
+
+		return std::copy( buffer, buffer + n, out );
+
+	}
+
+} /* end of namespace logstreamxx */
+
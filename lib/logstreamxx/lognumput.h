@@ -0,0 +1,125 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTREAMXX_LOGNUMPUT_H
+#define LOGSTREAMXX_LOGNUMPUT_H
+
+#include <cstddef>
+#include <ios>
+#include <iterator>
+#include <locale>
+
+
+namespace logstreamxx {
+
+	/**
+	*   @brief Locale-free numeric formatting facet class
+	*
+	*   A @c std::num_put facet installed on log streams so numbers
+	*   inserted with @c << skip the locale dependent formatting of the
+	*   standard library. Integers are converted two digits at a time
+	*   using a lookup table and floating point numbers with an exact
+	*   short decimal representation ( e.g. @c 3.25, @c 0.001, @c 1e6 )
+	*   are converted without going through @c printf().
+	*
+	*   @c std::dec, @c std::hex, @c std::oct and @c std::uppercase
+	*   are handled on the fast path, anything else ( field widths,
+	*   @c std::showpos, @c std::showbase, @c std::fixed etc. ) falls
+	*   back to the standard formatting. Floating point numbers follow
+	*   the stream precision like @c "%g" does, except that a precision
+	*   of 17 or more gives the shortest representation which reads
+	*   back as the same value ( e.g. @c 0.1 rather than
+	*   @c 0.10000000000000001 ).
+	*
+	*   @note Digit grouping and the decimal point of the stream locale
+	*         are not applied, log output is the same regardless of the
+	*         locale.
+	*
+	*/
+	class lognumput : public std::num_put<char> {
+	public:
+
+		/**
+		*   @brief constructor
+		*   @param refs facet reference count, @c 0 to be deleted along
+		*               with the last locale referring to it
+		*/
+		explicit lognumput( size_t refs = 0 );
+
+		/**
+		*   @brief destructor
+		*/
+		virtual ~lognumput();
+
+		/**
+		*   @brief convert an unsigned integer to decimal digits
+		*   @param end end of the output buffer, at least 20 characters
+		*              are written before it
+		*
+		*   @param v value
+		*   @return start of the converted digits
+		*
+		*   Digits are written backwards from @c end, two at a time.
+		*
+		*/
+		static char * utoa( char * end, unsigned long long v ) throw();
+
+		/**
+		*   @brief convert a floating point number
+		*   @param buffer output buffer, at least 32 characters
+		*   @param v value
+		*   @param precision maximum number of significant digits,
+		*                    @c 17 or more for the shortest round trip
+		*                    representation
+		*
+		*   @return number of characters written
+		*
+		*   Same as @c "%.*g" in the C locale.
+		*
+		*/
+		static size_t dtoa( char * buffer, double v, int precision ) throw();
+
+
+	protected:
+
+		typedef std::ostreambuf_iterator<char> iter_t;
+
+		using std::num_put<char>::do_put;
+
+		virtual iter_t do_put( iter_t out, std::ios_base &io, char fill, long v ) const;
+		virtual iter_t do_put( iter_t out, std::ios_base &io, char fill, unsigned long v ) const;
+		virtual iter_t do_put( iter_t out, std::ios_base &io, char fill, long long v ) const;
+		virtual iter_t do_put( iter_t out, std::ios_base &io, char fill, unsigned long long v ) const;
+		virtual iter_t do_put( iter_t out, std::ios_base &io, char fill, double v ) const;
+
+
+	private:
+
+		/** check whether the stream format flags allow the fast path */
+		static bool fast( const std::ios_base &io ) throw();
+
+		/** write out an integer, @c negative is ignored unless decimal */
+		static iter_t put( iter_t out, const std::ios_base &io, unsigned long long v, bool negative );
+
+	};
+
+} /* end of namespace logstreamxx */
+
+#endif /* !LOGSTREAMXX_LOGNUMPUT_H */
+
@@ -0,0 +1,360 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logrecorder.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <sched.h>
+#include <sys/time.h>
+
+
+namespace logstreamxx {
+
+	/** last assigned log site id */
+	static uint32_t last_site_id = 0;
+
+	const size_t logargs::header_size;
+	const char logrecorder::magic[8] = { 'L', 'S', 'X', 'X', 'B', 'I', 'N', '2' };
+
+
+	void logargs::append_u( tag_t t, uint64_t v ) throw() {
+
+		// check - enough space?
+		if ( ( _n + 1 + sizeof( v ) ) > sizeof( _data ) ) {
+			return;
+		}
+
+		_data[_n++] = t;
+		memcpy( _data + _n, &v, sizeof( v ) );
+		_n += sizeof( v );
+		_count++;
+
+	}
+
+
+	void logargs::append_c( char v ) throw() {
+
+		// check - enough space?
+		if ( ( _n + 2 ) > sizeof( _data ) ) {
+			return;
+		}
+
+		_data[_n++] = t_char;
+		_data[_n++] = v;
+		_count++;
+
+	}
+
+
+	void logargs::append_f( double v ) throw() {
+
+		// check - enough space?
+		if ( ( _n + 1 + sizeof( v ) ) > sizeof( _data ) ) {
+			return;
+		}
+
+		_data[_n++] = t_double;
+		memcpy( _data + _n, &v, sizeof( v ) );
+		_n += sizeof( v );
+		_count++;
+
+	}
+
+
+	void logargs::append_s( const char * v, size_t n ) throw() {
+
+		// check - enough space?
+		if ( ( _n + 3 ) > sizeof( _data ) ) {
+			return;
+		}
+
+		// truncate to fit
+		if ( n > ( sizeof( _data ) - _n - 3 ) ) {
+			n = sizeof( _data ) - _n - 3;
+		}
+
+		uint16_t len = n;
+
+		_data[_n++] = t_string;
+		memcpy( _data + _n, &len, sizeof( len ) );
+		_n += sizeof( len );
+		memcpy( _data + _n, v, n );
+		_n += n;
+		_count++;
+
+	}
+
+
+	logrecorder::logrecorder( int output_fd ) throw( logexception ) :
+			_logfd( output_fd ), _fd( -1 ), _writer( 0 ), _mask( 1 ) {
+
+		// sanity check
+		if ( _logfd < 0 ) {
+			throw logexception( "Invalid file descriptor" );
+		}
+
+		// initialise recording session
+		init();
+
+	}
+
+
+	logrecorder::logrecorder( const char * filename, const logwriter::overflow_t &overflow,
+			size_t capacity, bool append, mode_t mode ) throw( logexception ) :
+			_logfd( -1 ), _fd( -1 ), _writer( 0 ), _mask( 1 ) {
+
+		// set file open flags
+		int flags = O_WRONLY | O_CREAT | O_APPEND;
+
+		// truncate file?
+		if (! append ) {
+			flags |= O_TRUNC;
+		}
+
+		// open file
+		_fd = ::open( filename, flags, mode );
+
+		// check - was the open file successful?
+		if ( _fd == -1 ) {
+			// throw a log exception with system message
+			throw logexception();
+		}
+
+		// background log writer
+		try {
+			_writer = new logwriter( _fd, overflow, capacity );
+		} catch ( logexception &e ) {
+			::close( _fd );
+			throw;
+		}
+
+		_logfd = _fd;
+
+		// initialise recording session
+		init();
+
+	}
+
+
+	logrecorder::~logrecorder() throw() {
+
+		// write out queued records and stop the writer
+		delete _writer;
+
+		// close any open files
+		if ( _fd != -1 ) {
+			::close( _fd );
+		}
+
+	}
+
+
+	void logrecorder::init() throw( logexception ) {
+
+		// site definitions are per session
+		memset( _sites, 0, sizeof( _sites ) );
+
+		// session start
+		wstring( r_session, 0, 0, magic, sizeof( magic ) );
+
+	}
+
+
+	int logrecorder::loglevel( const priority::log_priority_t &level ) throw() {
+
+		// create bit mask
+		int mask = 1 << level;
+		mask = ( mask - 1 ) | mask;
+
+		// update
+		__atomic_store_n( &_mask, mask, __ATOMIC_RELAXED );
+
+		return mask;
+
+	}
+
+
+	void logrecorder::lprefix( const std::string &prefix ) throw() {
+		wstring( r_prefix, 0, 0, prefix.data(), prefix.length() );
+	}
+
+
+	void logrecorder::log( const priority::log_priority_t &p, logsite &site ) throw() {
+
+		logargs args;
+		record( p, site, args );
+
+	}
+
+
+	void logrecorder::record( const priority::log_priority_t &p, logsite &site, logargs &args ) throw() {
+
+		// check - first use of the site?
+		if ( __atomic_load_n( &site.id, __ATOMIC_ACQUIRE ) == 0 ) {
+
+			uint32_t id = __atomic_add_fetch( &last_site_id, 1, __ATOMIC_RELAXED );
+			uint32_t expected = 0;
+
+			// another thread may have assigned an id already
+			__atomic_compare_exchange_n( &site.id, &expected, id, false,
+					__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE );
+
+		}
+
+		// write out the site definition if needed
+		define( site );
+
+		// raw timestamp
+		timeval tv;
+		gettimeofday( &tv, 0 );
+
+		int64_t  sec   = tv.tv_sec;
+		uint32_t usec  = tv.tv_usec;
+		uint16_t size  = args.size();
+		uint8_t  count = args.count();
+
+		// log entry header
+		char * header = args.data();
+		memcpy( header, &size, 2 );
+		header[2] = r_entry;
+		memcpy( header + 3, &site.id, 4 );
+		memcpy( header + 7, &sec, 8 );
+		memcpy( header + 15, &usec, 4 );
+		header[19] = p;
+		header[20] = count;
+
+		wrecord( args.data(), args.size() );
+
+	}
+
+
+	void logrecorder::define( logsite &site ) throw() {
+
+		char header[4];
+		memcpy( header, &site.id, 4 );
+
+		// check - can we keep track of this site?
+		if ( site.id >= LOGRECORDER_SITES ) {
+			wstring( r_site, header, sizeof( header ), site.format, strlen( site.format ) );
+			return;
+		}
+
+		unsigned char * state = &_sites[site.id];
+
+		for (;;) {
+
+			// check - already written?
+			if ( __atomic_load_n( state, __ATOMIC_ACQUIRE ) == 2 ) {
+				return;
+			}
+
+			unsigned char expected = 0;
+			if ( __atomic_compare_exchange_n( state, &expected, 1, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) ) {
+
+				// log entries can't be decoded without the definition,
+				// write it out again with the next log entry if it failed
+				bool written = wstring( r_site, header, sizeof( header ), site.format, strlen( site.format ) );
+				__atomic_store_n( state, written ? 2 : 0, __ATOMIC_RELEASE );
+
+				return;
+
+			}
+
+			// another thread is writing the definition, it must be out
+			// before any log entries referring to it
+			while ( __atomic_load_n( state, __ATOMIC_ACQUIRE ) == 1 ) {
+				sched_yield();
+			}
+
+		}
+
+	}
+
+
+	bool logrecorder::wstring( const record_t &type, const char * prefix, size_t prefix_n,
+			const char * data, size_t n ) throw() {
+
+		char header[16];
+		size_t header_n = 3 + prefix_n;
+
+		// truncate to fit into a record
+		if ( ( header_n + n ) > 0xffff ) {
+			n = 0xffff - header_n;
+		}
+
+		uint16_t size = header_n + n;
+		memcpy( header, &size, 2 );
+		header[2] = type;
+		memcpy( header + 3, prefix, prefix_n );
+
+		iovec iov[2];
+		iov[0].iov_base = header;
+		iov[0].iov_len  = header_n;
+		iov[1].iov_base = (void *) data;
+		iov[1].iov_len  = n;
+
+		// check - asynchronous mode?
+		if ( _writer != 0 ) {
+			return _writer->push( iov, 2 );
+		}
+
+		// single write per record
+		std::string record( header, header_n );
+		record.append( data, n );
+
+		return wrecord( record.data(), record.length() );
+
+	}
+
+
+	bool logrecorder::wrecord( const char * data, size_t n ) throw() {
+
+		// check - asynchronous mode?
+		if ( _writer != 0 ) {
+			return _writer->push( data, n );
+		}
+
+		while ( n > 0 ) {
+
+			ssize_t w = write( _logfd, data, n );
+
+			if ( w < 0 ) {
+
+				// retry if interrupted
+				if ( errno == EINTR ) {
+					continue;
+				}
+
+				return false;
+
+			}
+
+			data += w;
+			n    -= w;
+
+		}
+
+		return true;
+
+	}
+
+} /* end of namespace logstreamxx */
+
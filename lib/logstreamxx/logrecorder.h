@@ -0,0 +1,403 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTREAMXX_LOGRECORDER_H
+#define LOGSTREAMXX_LOGRECORDER_H
+
+#include <logstreamxx/priority.h>
+#include <logstreamxx/logexception.h>
+#include <logstreamxx/logwriter.h>
+
+#include <cstring>
+#include <string>
+#include <stdint.h>
+#include <sys/stat.h>
+
+#ifndef LOGRECORDER_RECORD_SIZE
+#define LOGRECORDER_RECORD_SIZE 512
+#endif
+
+#ifndef LOGRECORDER_SITES
+#define LOGRECORDER_SITES 4096
+#endif
+
+
+/**
+*   @brief record a log entry at a priority only if enabled
+*   @param recorder logstreamxx::logrecorder instance
+*   @param p log priority
+*   @param format printf(3) style format string
+*
+*   Declare a static log site for @c format and record a log entry with
+*   the rest of the macro arguments. Arguments are not evaluated if
+*   logging is not enabled for @c p or @c p is above the compile-time
+*   log level ( @c LOGSTREAMXX_LOGLEVEL ).
+*
+*   @code
+*   LOGSTREAMXX_RECORD( recorder, logstreamxx::priority::info, "user %d took %.2fms", id, ms );
+*   @endcode
+*
+*/
+#define LOGSTREAMXX_RECORD( recorder, p, format, ... ) \
+	do { \
+		if ( ( ( p ) <= LOGSTREAMXX_LOGLEVEL ) && ( recorder ).enabled( p ) ) { \
+			static logstreamxx::logsite logstreamxx_site = { format, 0 }; \
+			( recorder ).log( p, logstreamxx_site, ##__VA_ARGS__ ); \
+		} \
+	} while ( 0 )
+
+
+namespace logstreamxx {
+
+	/**
+	*   @brief Log site structure
+	*
+	*   Static description of a log statement. The format string is
+	*   only written out once per log recorder, log entries refer to
+	*   it by the site id.
+	*
+	*/
+	struct logsite {
+
+		/** printf(3) style format string */
+		const char * format;
+
+		/** site id, assigned on first use ( 0 until then ) */
+		uint32_t id;
+
+	};
+
+
+	/**
+	*   @brief Log entry arguments class
+	*
+	*   Fixed size buffer to encode log entry arguments into. Each
+	*   argument is stored as a one byte type tag followed by its raw
+	*   value, strings are stored with a 2 byte length and truncated to
+	*   fit into the buffer.
+	*
+	*/
+	class logargs {
+	public:
+
+		/** argument type tags */
+		enum tag_t {
+			t_signed    = 'i',    //!< 8 byte signed integer
+			t_unsigned  = 'u',    //!< 8 byte unsigned integer
+			t_double    = 'f',    //!< 8 byte floating point number
+			t_char      = 'c',    //!< 1 byte character
+			t_string    = 's',    //!< 2 byte length followed by the characters
+			t_pointer   = 'p'     //!< 8 byte pointer value
+		};
+
+		/** log entry header size ( size, type, site id, timestamp, priority and argument count ) */
+		static const size_t header_size = 21;
+
+		logargs() throw() : _n( header_size ), _count( 0 ) {}
+
+		void append( bool v ) throw()                 { append_u( t_signed, v ); }
+		void append( char v ) throw()                 { append_c( v ); }
+		void append( signed char v ) throw()          { append_u( t_signed, (int64_t) v ); }
+		void append( unsigned char v ) throw()        { append_u( t_unsigned, (uint64_t) v ); }
+		void append( short v ) throw()                { append_u( t_signed, (int64_t) v ); }
+		void append( unsigned short v ) throw()       { append_u( t_unsigned, (uint64_t) v ); }
+		void append( int v ) throw()                  { append_u( t_signed, (int64_t) v ); }
+		void append( unsigned int v ) throw()         { append_u( t_unsigned, (uint64_t) v ); }
+		void append( long v ) throw()                 { append_u( t_signed, (int64_t) v ); }
+		void append( unsigned long v ) throw()        { append_u( t_unsigned, (uint64_t) v ); }
+		void append( long long v ) throw()            { append_u( t_signed, (int64_t) v ); }
+		void append( unsigned long long v ) throw()   { append_u( t_unsigned, (uint64_t) v ); }
+		void append( float v ) throw()                { append_f( v ); }
+		void append( double v ) throw()               { append_f( v ); }
+		void append( const char * v ) throw()         { append_s( v, ( v == 0 ) ? 0 : strlen( v ) ); }
+		void append( const std::string &v ) throw()   { append_s( v.data(), v.length() ); }
+		void append( const void * v ) throw()         { append_u( t_pointer, (uint64_t) (uintptr_t) v ); }
+
+		/** encoded data */
+		char * data() throw() { return _data; }
+
+		/** encoded size */
+		size_t size() const throw() { return _n; }
+
+		/** number of arguments */
+		uint8_t count() const throw() { return _count; }
+
+
+	private:
+
+		/** encoded arguments (after the log entry header) */
+		char _data[LOGRECORDER_RECORD_SIZE];
+
+		/** encoded size */
+		size_t _n;
+
+		/** number of arguments */
+		uint8_t _count;
+
+		void append_u( tag_t t, uint64_t v ) throw();
+		void append_c( char v ) throw();
+		void append_f( double v ) throw();
+		void append_s( const char * v, size_t n ) throw();
+
+	};
+
+
+	/**
+	*   @brief Binary log recorder class
+	*
+	*   Deferred formatting log frontend. Instead of formatting log
+	*   lines, a log entry is recorded as the log site id, the raw
+	*   timestamp and the raw argument values. Text rendering happens
+	*   later (offline) using logdecoder, which produces the same log
+	*   line format as logstreambuf.
+	*
+	*   Binary records are framed as a 2 byte size (including itself)
+	*   followed by a 1 byte record type;
+	*
+	*   - @c 'S' session start, followed by the logrecorder::magic string.
+	*     Written when a recorder is created and resets the site ids.
+	*   - @c 'D' site definition, followed by the 4 byte site id and
+	*     the format string. Written before the first log entry of the
+	*     site, and again until it is written out successfully.
+	*   - @c 'P' log prefix, followed by the prefix string.
+	*   - @c 'E' log entry, followed by the 4 byte site id, 8 byte
+	*     seconds, 4 byte microseconds, 1 byte priority, 1 byte argument
+	*     count and the arguments (see logargs).
+	*
+	*   All values are in host byte order. log() can be called from
+	*   multiple threads.
+	*
+	*/
+	class logrecorder {
+	public:
+
+		/** session start magic string */
+		static const char magic[8];
+
+		/** binary record types */
+		enum record_t {
+			r_session  = 'S',    //!< session start
+			r_site     = 'D',    //!< site definition
+			r_prefix   = 'P',    //!< log prefix
+			r_entry    = 'E'     //!< log entry
+		};
+
+		/**
+		*   @brief constructor
+		*   @param output_fd binary log output file descriptor
+		*
+		*   Initialise a log recorder which writes binary records to
+		*   @c output_fd on the caller's thread (one write per record).
+		*
+		*   @note The file descriptor is not owned by the log recorder.
+		*
+		*/
+		logrecorder( int output_fd ) throw( logexception );
+
+		/**
+		*   @brief overloaded constructor
+		*   @param filename binary log destination filename
+		*   @param overflow queue overflow policy
+		*   @param capacity queue capacity in bytes
+		*   @param append boolean flag to indicate whether to append to
+		*                 the log file or truncate the file if already
+		*                 exists
+		*
+		*   @param mode file mode to open the log file with
+		*
+		*   Initialise a log recorder with @c filename as the destination
+		*   and a background log writer to write out the binary records.
+		*
+		*/
+		logrecorder( const char * filename, const logwriter::overflow_t &overflow = logwriter::block,
+				size_t capacity = LOGWRITER_QUEUE_SIZE, bool append = true,
+				mode_t mode = 00644 ) throw( logexception );
+
+		/**
+		*   @brief destructor
+		*
+		*   Write out any queued records and close the log file (if
+		*   opened by the recorder).
+		*
+		*/
+		virtual ~logrecorder() throw();
+
+		/**
+		*   @brief set log output level
+		*   @param level log output level
+		*   @return log priority bit mask
+		*
+		*   @sa logstream::loglevel()
+		*
+		*/
+		int loglevel( const priority::log_priority_t &level ) throw();
+
+		/**
+		*   @brief check whether logging is enabled for a priority
+		*   @param p log priority
+		*   @return boolean @c true if log entries with priority @c p
+		*           will be recorded or @c false otherwise
+		*/
+		bool enabled( const priority::log_priority_t &p ) const throw();
+
+		/**
+		*   @brief set an additional prefix for the log lines
+		*   @param prefix log prefix
+		*
+		*   The prefix applies to the log entries recorded after this.
+		*
+		*/
+		void lprefix( const std::string &prefix ) throw();
+
+		/**
+		*   @brief record a log entry
+		*   @param p log priority
+		*   @param site log site
+		*
+		*   Record a log entry for @c site with no arguments.
+		*
+		*/
+		void log( const priority::log_priority_t &p, logsite &site ) throw();
+
+		/**
+		*   @brief record a log entry
+		*   @param p log priority
+		*   @param site log site
+		*   @param a1 first format argument
+		*
+		*   Record a log entry for @c site with the passed in arguments.
+		*   Overloads are provided for up to 8 arguments.
+		*
+		*/
+		template <typename A1>
+		void log( const priority::log_priority_t &p, logsite &site, const A1 &a1 ) throw() {
+			logargs args;
+			args.append( a1 );
+			record( p, site, args );
+		}
+
+		template <typename A1, typename A2>
+		void log( const priority::log_priority_t &p, logsite &site, const A1 &a1, const A2 &a2 ) throw() {
+			logargs args;
+			args.append( a1 ); args.append( a2 );
+			record( p, site, args );
+		}
+
+		template <typename A1, typename A2, typename A3>
+		void log( const priority::log_priority_t &p, logsite &site, const A1 &a1, const A2 &a2, const A3 &a3 ) throw() {
+			logargs args;
+			args.append( a1 ); args.append( a2 ); args.append( a3 );
+			record( p, site, args );
+		}
+
+		template <typename A1, typename A2, typename A3, typename A4>
+		void log( const priority::log_priority_t &p, logsite &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4 ) throw() {
+			logargs args;
+			args.append( a1 ); args.append( a2 ); args.append( a3 ); args.append( a4 );
+			record( p, site, args );
+		}
+
+		template <typename A1, typename A2, typename A3, typename A4, typename A5>
+		void log( const priority::log_priority_t &p, logsite &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4,
+				const A5 &a5 ) throw() {
+			logargs args;
+			args.append( a1 ); args.append( a2 ); args.append( a3 ); args.append( a4 );
+			args.append( a5 );
+			record( p, site, args );
+		}
+
+		template <typename A1, typename A2, typename A3, typename A4, typename A5, typename A6>
+		void log( const priority::log_priority_t &p, logsite &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4,
+				const A5 &a5, const A6 &a6 ) throw() {
+			logargs args;
+			args.append( a1 ); args.append( a2 ); args.append( a3 ); args.append( a4 );
+			args.append( a5 ); args.append( a6 );
+			record( p, site, args );
+		}
+
+		template <typename A1, typename A2, typename A3, typename A4, typename A5, typename A6,
+				typename A7>
+		void log( const priority::log_priority_t &p, logsite &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4,
+				const A5 &a5, const A6 &a6, const A7 &a7 ) throw() {
+			logargs args;
+			args.append( a1 ); args.append( a2 ); args.append( a3 ); args.append( a4 );
+			args.append( a5 ); args.append( a6 ); args.append( a7 );
+			record( p, site, args );
+		}
+
+		template <typename A1, typename A2, typename A3, typename A4, typename A5, typename A6,
+				typename A7, typename A8>
+		void log( const priority::log_priority_t &p, logsite &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4,
+				const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8 ) throw() {
+			logargs args;
+			args.append( a1 ); args.append( a2 ); args.append( a3 ); args.append( a4 );
+			args.append( a5 ); args.append( a6 ); args.append( a7 ); args.append( a8 );
+			record( p, site, args );
+		}
+
+
+	private:
+
+		/** log file descriptor */
+		int _logfd;
+
+		/** file descriptor opened by the recorder (if any) */
+		int _fd;
+
+		/** asynchronous log writer (if any) */
+		logwriter * _writer;
+
+		/** log priority mask */
+		int _mask;
+
+		/** site definition state ( 0 - not written, 1 - writing, 2 - written ),
+		    reset to 0 if writing out the definition failed */
+		unsigned char _sites[LOGRECORDER_SITES];
+
+		/** record a log entry with encoded arguments */
+		void record( const priority::log_priority_t &p, logsite &site, logargs &args ) throw();
+
+		/** write out the site definition (until written out successfully) */
+		void define( logsite &site ) throw();
+
+		/** write out a record with a string payload */
+		bool wstring( const record_t &type, const char * prefix, size_t prefix_n,
+				const char * data, size_t n ) throw();
+
+		/** write out a binary record */
+		bool wrecord( const char * data, size_t n ) throw();
+
+		/** initialise a recording session */
+		void init() throw( logexception );
+
+		// disallow copying
+		logrecorder( const logrecorder & );
+		logrecorder &operator =( const logrecorder & );
+
+	};
+
+
+	inline bool logrecorder::enabled( const priority::log_priority_t &p ) const throw() {
+		return ( ( 1 << p ) & __atomic_load_n( &_mask, __ATOMIC_RELAXED ) ) != 0;
+	}
+
+} /* end of namespace logstreamxx */
+
+#endif /* !LOGSTREAMXX_LOGRECORDER_H */
+
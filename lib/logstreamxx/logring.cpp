@@ -0,0 +1,264 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logring.h"
+
+#include <cstring>
+
+
+namespace logstreamxx {
+
+	const uint32_t logring::pad;
+
+
+	logring::logring( size_t capacity ) throw() :
+			_ring( 0 ), _capacity( sizeof( header ) ), _tail( 0 ), _head( 0 ), _releasing( 0 ) {
+
+		// round up to a power of 2
+		while ( _capacity < capacity ) {
+			_capacity <<= 1;
+		}
+
+		// allocate (zeroed) ring space
+		_ring = new char[_capacity]();
+
+	}
+
+
+	logring::~logring() throw() {
+
+		// cleanup
+		delete [] _ring;
+
+	}
+
+
+	size_t logring::capacity() const throw() {
+		return _capacity;
+	}
+
+
+	size_t logring::slot( size_t n ) throw() {
+		return ( sizeof( header ) + n + 7 ) & ~( (size_t) 7 );
+	}
+
+
+	bool logring::fits( size_t n ) const throw() {
+		return ( slot( n ) <= _capacity );
+	}
+
+
+	uint64_t logring::tail() const throw() {
+		return __atomic_load_n( &_tail, __ATOMIC_ACQUIRE );
+	}
+
+
+	uint64_t logring::head() const throw() {
+		return __atomic_load_n( &_head, __ATOMIC_ACQUIRE );
+	}
+
+
+	bool logring::push( const iovec * iov, int iovcnt, size_t n ) throw() {
+
+		size_t need = slot( n );
+		uint64_t t;
+		size_t offset;
+
+		// reserve space
+		for (;;) {
+
+			t = __atomic_load_n( &_tail, __ATOMIC_RELAXED );
+			uint64_t h = __atomic_load_n( &_head, __ATOMIC_ACQUIRE );
+
+			offset = t & ( _capacity - 1 );
+			size_t contiguous = _capacity - offset;
+
+			// check - does the record fit before the end of the ring?
+			if ( need > contiguous ) {
+
+				// pad up to the end of the ring and try again from the start
+				if ( ( t + contiguous - h ) > _capacity ) {
+					return false;
+				}
+
+				if ( __atomic_compare_exchange_n( &_tail, &t, t + contiguous, false,
+						__ATOMIC_ACQ_REL, __ATOMIC_RELAXED ) ) {
+
+					header * hdr = (header *) ( _ring + offset );
+					hdr->len = pad;
+					__atomic_store_n( &hdr->size, (uint32_t) contiguous, __ATOMIC_RELEASE );
+
+				}
+
+				continue;
+
+			}
+
+			// check - enough space?
+			if ( ( t + need - h ) > _capacity ) {
+				return false;
+			}
+
+			if ( __atomic_compare_exchange_n( &_tail, &t, t + need, false,
+					__ATOMIC_ACQ_REL, __ATOMIC_RELAXED ) ) {
+				break;
+			}
+
+		}
+
+		// copy the record parts
+		header * hdr = (header *) ( _ring + offset );
+		char * data  = (char *) ( hdr + 1 );
+
+		for ( int i = 0; i < iovcnt; i++ ) {
+			memcpy( data, iov[i].iov_base, iov[i].iov_len );
+			data += iov[i].iov_len;
+		}
+
+		// publish
+		hdr->len = n;
+		__atomic_store_n( &hdr->size, (uint32_t) need, __ATOMIC_RELEASE );
+
+		return true;
+
+	}
+
+
+	size_t logring::pop( char * buffer, uint64_t limit ) throw() {
+
+		// only contended by producers dropping old records
+		while (! lock() ) {
+			continue;
+		}
+
+		uint64_t h = __atomic_load_n( &_head, __ATOMIC_RELAXED );
+		uint64_t t = __atomic_load_n( &_tail, __ATOMIC_ACQUIRE );
+		uint64_t pos = h;
+		size_t n = 0;
+
+		if ( t > limit ) {
+			t = limit;
+		}
+
+		while ( pos < t ) {
+
+			header * hdr  = (header *) ( _ring + ( pos & ( _capacity - 1 ) ) );
+			uint32_t size = __atomic_load_n( &hdr->size, __ATOMIC_ACQUIRE );
+
+			// check - reserved but not published yet?
+			if ( size == 0 ) {
+				break;
+			}
+
+			// copy out the record (skipping padding)
+			if ( hdr->len != pad ) {
+				memcpy( buffer + n, hdr + 1, hdr->len );
+				n += hdr->len;
+			}
+
+			pos += size;
+
+		}
+
+		release( h, pos );
+		unlock();
+
+		return n;
+
+	}
+
+
+	int logring::discard( size_t n ) throw() {
+
+		// check - is the consumer releasing space?
+		if (! lock() ) {
+			return -1;
+		}
+
+		size_t need = slot( n );
+		uint64_t h = __atomic_load_n( &_head, __ATOMIC_RELAXED );
+		uint64_t t = __atomic_load_n( &_tail, __ATOMIC_ACQUIRE );
+		uint64_t pos = h;
+		int dropped = 0;
+
+		while ( ( pos < t ) && ( ( t + need - pos ) > _capacity ) ) {
+
+			header * hdr  = (header *) ( _ring + ( pos & ( _capacity - 1 ) ) );
+			uint32_t size = __atomic_load_n( &hdr->size, __ATOMIC_ACQUIRE );
+
+			// check - reserved but not published yet?
+			if ( size == 0 ) {
+				break;
+			}
+
+			if ( hdr->len != pad ) {
+				dropped++;
+			}
+
+			pos += size;
+
+		}
+
+		release( h, pos );
+		unlock();
+
+		return dropped;
+
+	}
+
+
+	void logring::release( uint64_t from, uint64_t to ) throw() {
+
+		// sanity check
+		if ( from == to ) {
+			return;
+		}
+
+		// zero out released slots, producers rely on unpublished headers being 0
+		size_t offset = from & ( _capacity - 1 );
+		size_t n = to - from;
+
+		if ( ( offset + n ) <= _capacity ) {
+			memset( _ring + offset, 0, n );
+		} else {
+			memset( _ring + offset, 0, _capacity - offset );
+			memset( _ring, 0, n - ( _capacity - offset ) );
+		}
+
+		// update consumer position
+		__atomic_store_n( &_head, to, __ATOMIC_RELEASE );
+
+	}
+
+
+	bool logring::lock() throw() {
+
+		int expected = 0;
+		return __atomic_compare_exchange_n( &_releasing, &expected, 1, false,
+				__ATOMIC_ACQUIRE, __ATOMIC_RELAXED );
+
+	}
+
+
+	void logring::unlock() throw() {
+		__atomic_store_n( &_releasing, 0, __ATOMIC_RELEASE );
+	}
+
+} /* end of namespace logstreamxx */
+
@@ -0,0 +1,175 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTREAMXX_LOGRING_H
+#define LOGSTREAMXX_LOGRING_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <sys/uio.h>
+
+
+namespace logstreamxx {
+
+	/**
+	*   @brief Lock-free log record ring class
+	*
+	*   Bounded multi-producer/single-consumer ring of variable-length
+	*   log records. Producers reserve space with a compare-and-swap on
+	*   the ring tail, copy the record in and publish it by storing the
+	*   record header. The consumer copies out batches of published
+	*   records in order.
+	*
+	*   Records are stored with an 8 byte header and padded to 8 byte
+	*   boundaries. A record never wraps around the end of the ring,
+	*   the space up to the end is filled with a padding record instead.
+	*
+	*/
+	class logring {
+	public:
+
+		/**
+		*   @brief constructor
+		*   @param capacity ring capacity in bytes, rounded up to a power of 2
+		*/
+		logring( size_t capacity ) throw();
+
+		/**
+		*   @brief destructor
+		*/
+		virtual ~logring() throw();
+
+		/**
+		*   @brief get the ring capacity
+		*   @return ring capacity in bytes
+		*/
+		size_t capacity() const throw();
+
+		/**
+		*   @brief check whether a record can ever fit into the ring
+		*   @param n record size
+		*   @return boolean @c true if a record of @c n characters fits
+		*           into an empty ring or @c false otherwise
+		*/
+		bool fits( size_t n ) const throw();
+
+		/**
+		*   @brief push a log record into the ring (producer)
+		*   @param iov log record parts
+		*   @param iovcnt number of log record parts
+		*   @param n log record size
+		*   @return boolean @c true if the record was published or
+		*           @c false if there wasn't enough space
+		*
+		*   Gather the @c iovcnt parts described by @c iov into the
+		*   ring as a single record. This never blocks.
+		*
+		*/
+		bool push( const iovec * iov, int iovcnt, size_t n ) throw();
+
+		/**
+		*   @brief copy out published log records (consumer)
+		*   @param buffer output buffer of at least capacity() characters
+		*   @param limit ring position to stop at
+		*   @return number of characters copied out to @c buffer
+		*
+		*   Copy out all the records published in order (stopping at the
+		*   first record which is reserved but not yet published, or at
+		*   @c limit) and release their space. Only a single thread may
+		*   consume.
+		*
+		*/
+		size_t pop( char * buffer, uint64_t limit = ~( (uint64_t) 0 ) ) throw();
+
+		/**
+		*   @brief drop the oldest log records (producer)
+		*   @param n space needed in the ring
+		*   @return number of records dropped, or -1 if the consumer is
+		*           busy releasing space at the moment
+		*
+		*   Discard the oldest published records until there is space for
+		*   a record of @c n characters or an unpublished record is reached.
+		*
+		*/
+		int discard( size_t n ) throw();
+
+		/**
+		*   @brief get the ring tail position
+		*   @return total number of bytes reserved so far
+		*/
+		uint64_t tail() const throw();
+
+		/**
+		*   @brief get the ring head position
+		*   @return total number of bytes released so far
+		*/
+		uint64_t head() const throw();
+
+
+	private:
+
+		/** record header */
+		struct header {
+			uint32_t size;    //!< slot size including the header, 0 until published
+			uint32_t len;     //!< record size or logring::pad for padding
+		};
+
+		/** record length marker for padding records */
+		static const uint32_t pad = 0xffffffff;
+
+		/** ring buffer */
+		char * _ring;
+
+		/** ring capacity */
+		size_t _capacity;
+
+		/** producer position */
+		uint64_t _tail;
+
+		/** padding to keep producer and consumer positions on separate cache lines */
+		char _padding[64];
+
+		/** consumer position */
+		uint64_t _head;
+
+		/** flag to indicate space is being released */
+		int _releasing;
+
+		/** slot size for a record of @c n characters */
+		static size_t slot( size_t n ) throw();
+
+		/** acquire the release flag */
+		bool lock() throw();
+
+		/** release the release flag */
+		void unlock() throw();
+
+		/** release the slots in [ @c from, @c to ) */
+		void release( uint64_t from, uint64_t to ) throw();
+
+		// disallow copying
+		logring( const logring & );
+		logring &operator =( const logring & );
+
+	};
+
+} /* end of namespace logstreamxx */
+
+#endif /* !LOGSTREAMXX_LOGRING_H */
+
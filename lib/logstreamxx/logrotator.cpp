@@ -0,0 +1,477 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logrotator.h"
+
+#include <config.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+
+namespace logstreamxx {
+
+	/**
+	*   @brief check whether @c name is @c prefix followed by a rotation
+	*          index or stamp ( digits and dots ) and @c suffix
+	*/
+	static bool matches( const std::string &name, const std::string &prefix, const std::string &suffix ) throw() {
+
+		// sanity check
+		if ( name.length() <= ( prefix.length() + suffix.length() ) ) {
+			return false;
+		}
+
+		if ( ( name.compare( 0, prefix.length(), prefix ) != 0 ) ||
+				( name.compare( name.length() - suffix.length(), suffix.length(), suffix ) != 0 ) ) {
+			return false;
+		}
+
+		for ( size_t i = prefix.length(); i < ( name.length() - suffix.length() ); i++ ) {
+			if ( ( ( name[i] < '0' ) || ( name[i] > '9' ) ) && ( name[i] != '.' ) ) {
+				return false;
+			}
+		}
+
+		return true;
+
+	}
+
+
+	logrotator::logrotator( const char * filename, const policy_t &policy,
+			bool append, mode_t mode ) throw( logexception ) :
+			_filename( filename ), _policy( policy ), _mode( mode ), _fd( -1 ),
+			_size( 0 ), _next( 0 ), _rotating( 0 ), _rotations( 0 ), _sequence( 0 ), _stop( false ) {
+
+#ifndef HAVE_ZLIB
+		// sanity check
+		if ( _policy.compress ) {
+			throw logexception( "Log file compression is not supported" );
+		}
+#endif
+
+		// set file open flags
+		int flags = O_WRONLY | O_CREAT | O_APPEND;
+
+		// truncate file?
+		if (! append ) {
+			flags |= O_TRUNC;
+		}
+
+		// open file
+		_fd = ::open( filename, flags, mode );
+
+		// check - was the open file successful?
+		if ( _fd == -1 ) {
+			// throw a log exception with system message
+			throw logexception();
+		}
+
+		// current log file size
+		struct stat st;
+		if ( fstat( _fd, &st ) == 0 ) {
+			_size = st.st_size;
+		}
+
+		// first time boundary
+		if ( _policy.interval > 0 ) {
+			_next = boundary( time( 0 ) );
+		}
+
+		// pick up rotated log files left behind, before the compression
+		// thread is started so the queue doesn't need locking
+		recover();
+
+		// start the compression thread
+		if ( _policy.compress ) {
+
+			pthread_mutex_init( &_mutex, 0 );
+			pthread_cond_init( &_cond, 0 );
+
+			if ( ( errno = pthread_create( &_thread, 0, &logrotator::start, this ) ) != 0 ) {
+
+				// cleanup
+				pthread_cond_destroy( &_cond );
+				pthread_mutex_destroy( &_mutex );
+				::close( _fd );
+
+				// throw a log exception with system message
+				throw logexception();
+
+			}
+
+		}
+
+	}
+
+
+	logrotator::~logrotator() throw() {
+
+		// stop the compression thread, it will compress pending files first
+		if ( _policy.compress ) {
+
+			pthread_mutex_lock( &_mutex );
+			_stop = true;
+			pthread_cond_signal( &_cond );
+			pthread_mutex_unlock( &_mutex );
+
+			pthread_join( _thread, 0 );
+
+			pthread_cond_destroy( &_cond );
+			pthread_mutex_destroy( &_mutex );
+
+		}
+
+		// close the log file
+		::close( _fd );
+
+	}
+
+
+	void logrotator::recover() throw() {
+
+		// split the log file name into the directory and the base name
+		std::string dir  = ".";
+		std::string path = "";
+		std::string base = _filename;
+
+		size_t slash = _filename.rfind( '/' );
+		if ( slash != std::string::npos ) {
+			dir  = ( slash == 0 ) ? "/" : _filename.substr( 0, slash );
+			path = _filename.substr( 0, slash + 1 );
+			base = _filename.substr( slash + 1 );
+		}
+
+		DIR * d = opendir( dir.c_str() );
+
+		// check - can we read the directory?
+		if ( d == 0 ) {
+			return;
+		}
+
+		std::vector<std::string> pending;
+		struct dirent * entry;
+
+		while ( ( entry = readdir( d ) ) != 0 ) {
+
+			std::string name = entry->d_name;
+
+			if ( matches( name, base + ".", ".pending" ) ) {
+				pending.push_back( path + name );
+			} else if ( matches( name, base + ".", ".gz.tmp" ) ) {
+				// partially compressed, the rotated log file is still there
+				::unlink( ( path + name ).c_str() );
+			}
+
+		}
+
+		closedir( d );
+
+		// oldest first, names are zero padded
+		std::sort( pending.begin(), pending.end() );
+
+		for ( size_t i = 0; i < pending.size(); i++ ) {
+
+			if ( _policy.keep == 0 ) {
+				::unlink( pending[i].c_str() );
+			} else if ( _policy.compress ) {
+				_pending.push_back( pending[i] );
+			} else {
+
+				for ( unsigned int j = _policy.keep - 1; j > 0; j-- ) {
+					::rename( rname( j ).c_str(), rname( j + 1 ).c_str() );
+				}
+
+				::rename( pending[i].c_str(), rname( 1 ).c_str() );
+
+			}
+
+		}
+
+	}
+
+
+	void * logrotator::start( void * arg ) throw() {
+
+		// rotator instance
+		logrotator * r = (logrotator *) arg;
+		r->run();
+
+		return 0;
+
+	}
+
+
+	void logrotator::run() throw() {
+
+#ifdef __linux__
+		// lowest scheduling priority for this thread only
+		setpriority( PRIO_PROCESS, syscall( SYS_gettid ), 19 );
+#endif
+
+		pthread_mutex_lock( &_mutex );
+
+		for (;;) {
+
+			if ( _pending.empty() ) {
+
+				// check - nothing left to compress and asked to stop?
+				if ( _stop ) {
+					break;
+				}
+
+				pthread_cond_wait( &_cond, &_mutex );
+				continue;
+
+			}
+
+			std::string filename = _pending.front();
+			_pending.pop_front();
+
+			// compress without holding the lock
+			pthread_mutex_unlock( &_mutex );
+			compress( filename );
+			pthread_mutex_lock( &_mutex );
+
+		}
+
+		pthread_mutex_unlock( &_mutex );
+
+	}
+
+
+	void logrotator::compress( const std::string &filename ) throw() {
+
+		// shift the compressed log files ( dropping the oldest )
+		for ( unsigned int i = _policy.keep - 1; i > 0; i-- ) {
+			::rename( rname( i, ".gz" ).c_str(), rname( i + 1, ".gz" ).c_str() );
+		}
+
+#ifdef HAVE_ZLIB
+		std::string tmp = rname( 1, ".gz.tmp" );
+
+		int in = ::open( filename.c_str(), O_RDONLY );
+		gzFile out = gzopen( tmp.c_str(), "wb" );
+
+		bool ok = ( in != -1 ) && ( out != 0 );
+
+		if ( ok ) {
+
+			char buffer[65536];
+			ssize_t n;
+
+			while ( ( n = read( in, buffer, sizeof( buffer ) ) ) != 0 ) {
+
+				if ( n < 0 ) {
+
+					// retry if interrupted
+					if ( errno == EINTR ) {
+						continue;
+					}
+
+					ok = false;
+					break;
+
+				}
+
+				if ( gzwrite( out, buffer, n ) != n ) {
+					ok = false;
+					break;
+				}
+
+			}
+
+		}
+
+		if ( out != 0 ) {
+			ok = ( gzclose( out ) == Z_OK ) && ok;
+		}
+
+		if ( in != -1 ) {
+			::close( in );
+		}
+
+		// only replace the rotated log file if it was compressed successfully
+		if ( ok && ( ::rename( tmp.c_str(), rname( 1, ".gz" ).c_str() ) == 0 ) ) {
+			::unlink( filename.c_str() );
+		} else {
+			::unlink( tmp.c_str() );
+		}
+#endif
+
+	}
+
+
+	int logrotator::fd() const throw() {
+		return _fd;
+	}
+
+
+	size_t logrotator::rotations() const throw() {
+		return __atomic_load_n( &_rotations, __ATOMIC_RELAXED );
+	}
+
+
+	std::string logrotator::rname( unsigned int index, const char * suffix ) const throw() {
+
+		char name[16];
+		snprintf( name, sizeof( name ), ".%u", index );
+
+		return _filename + name + suffix;
+
+	}
+
+
+	std::string logrotator::pname() throw() {
+
+		char name[32];
+		snprintf( name, sizeof( name ), ".%010lu.%010u.pending", (unsigned long) time( 0 ), ++_sequence );
+
+		return _filename + name;
+
+	}
+
+
+	time_t logrotator::boundary( time_t t ) const throw() {
+
+		// align to local time
+		struct tm tm;
+		localtime_r( &t, &tm );
+		time_t local = t + tm.tm_gmtoff;
+
+		return ( ( local / _policy.interval ) + 1 ) * _policy.interval - tm.tm_gmtoff;
+
+	}
+
+
+	void logrotator::written( size_t n ) throw() {
+
+		size_t size = __atomic_add_fetch( &_size, n, __ATOMIC_RELAXED );
+
+		// check - size limit reached or time boundary passed?
+		bool due = ( _policy.size > 0 ) && ( size >= _policy.size );
+
+		if ( (! due ) && ( _policy.interval > 0 ) ) {
+			due = time( 0 ) >= __atomic_load_n( &_next, __ATOMIC_RELAXED );
+		}
+
+		if ( due ) {
+			rotate();
+		}
+
+	}
+
+
+	bool logrotator::rotate() throw() {
+
+		// only one thread rotates, others carry on writing to the old file
+		int expected = 0;
+		if (! __atomic_compare_exchange_n( &_rotating, &expected, 1, false,
+				__ATOMIC_ACQUIRE, __ATOMIC_RELAXED ) ) {
+			return false;
+		}
+
+		// rotated log files waiting to be compressed are shifted by
+		// the compression thread instead
+		std::string pending;
+
+		// shift the rotated log files ( dropping the oldest )
+		if ( _policy.keep == 0 ) {
+			::unlink( _filename.c_str() );
+		} else if ( _policy.compress ) {
+			pending = pname();
+
+			// check - nothing to hand over if the log file wasn't moved
+			if ( ::rename( _filename.c_str(), pending.c_str() ) != 0 ) {
+				pending.clear();
+			}
+		} else {
+
+			for ( unsigned int i = _policy.keep - 1; i > 0; i-- ) {
+				::rename( rname( i ).c_str(), rname( i + 1 ).c_str() );
+			}
+
+			::rename( _filename.c_str(), rname( 1 ).c_str() );
+
+		}
+
+		// open a new log file and swap it in place of the old one,
+		// writes in progress still complete to the old file
+		bool ret = false;
+		int fd = ::open( _filename.c_str(), O_WRONLY | O_CREAT | O_APPEND, _mode );
+
+		if ( fd != -1 ) {
+
+			// keep the old log file open to sync it after the swap
+			int old = dup( _fd );
+
+			int r;
+			while ( ( ( r = dup2( fd, _fd ) ) == -1 ) && ( errno == EINTR ) ) { }
+			::close( fd );
+
+			if ( r != -1 ) {
+				__atomic_fetch_add( &_rotations, 1, __ATOMIC_RELAXED );
+				ret = true;
+			}
+
+			// log records written to the old log file and synced by
+			// the writers after the swap would otherwise be lost
+			if ( old != -1 ) {
+				fdatasync( old );
+				::close( old );
+			}
+
+		}
+
+		// reset, if the rotation failed this will retry on the next
+		// size limit or time boundary
+		__atomic_store_n( &_size, 0, __ATOMIC_RELAXED );
+
+		if ( _policy.interval > 0 ) {
+			__atomic_store_n( &_next, boundary( time( 0 ) ), __ATOMIC_RELAXED );
+		}
+
+		__atomic_store_n( &_rotating, 0, __ATOMIC_RELEASE );
+
+		// hand over the rotated log file to the compression thread
+		if (! pending.empty() ) {
+			pthread_mutex_lock( &_mutex );
+			_pending.push_back( pending );
+			pthread_cond_signal( &_cond );
+			pthread_mutex_unlock( &_mutex );
+		}
+
+		return ret;
+
+	}
+
+} /* end of namespace logstreamxx */
+
@@ -0,0 +1,234 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTREAMXX_LOGROTATOR_H
+#define LOGSTREAMXX_LOGROTATOR_H
+
+#include <logstreamxx/logexception.h>
+
+#include <cstddef>
+#include <ctime>
+#include <deque>
+#include <string>
+#include <pthread.h>
+#include <sys/types.h>
+
+
+namespace logstreamxx {
+
+	/**
+	*   @brief Log file rotation class
+	*
+	*   Owns a log file descriptor and rotates the log file when it grows
+	*   beyond a size limit or when a time boundary passes. On rotation
+	*   the log file is renamed to @c filename.1 ( shifting the existing
+	*   rotated files up to @c filename.keep ) and a new log file is
+	*   opened in place of the old one using @c dup2().
+	*
+	*   The file descriptor number never changes so log stream buffers
+	*   and log writers keep writing to the same descriptor. A log record
+	*   written with a single system call ends up either in the old or in
+	*   the new log file, and writers never wait for a rotation to finish.
+	*   The old log file is synced once it has been swapped out, so log
+	*   records synced by the writers stay durable across a rotation.
+	*
+	*   If compression is enabled then rotated log files are compressed
+	*   ( gzip ) to @c filename.1.gz ... @c filename.keep.gz on a low
+	*   priority background thread, so the log writes themselves are
+	*   never compressed.
+	*
+	*   Rotated log files waiting to be compressed are named
+	*   @c filename.<time>.<sequence>.pending so a failed rotation or
+	*   compression never collides with the next one. Any left behind
+	*   by a previous process are picked up again by the constructor.
+	*
+	*/
+	class logrotator {
+	public:
+
+		/**
+		*   @brief rotation policy type
+		*/
+		struct policy_t {
+
+			/**
+			*   @brief constructor
+			*   @param size rotate when the log file grows beyond @c size
+			*               bytes ( 0 to disable )
+			*
+			*   @param interval rotate every @c interval seconds, aligned
+			*                   to local time ( 0 to disable )
+			*
+			*   @param keep number of rotated log files to keep
+			*   @param compress boolean flag to indicate whether to
+			*                   compress rotated log files
+			*
+			*/
+			explicit policy_t( size_t size = 0, time_t interval = 0, unsigned int keep = 5,
+					bool compress = false ) throw() :
+					size( size ), interval( interval ), keep( keep ), compress( compress ) { }
+
+			size_t size;            //!< size limit in bytes
+			time_t interval;        //!< time interval in seconds
+			unsigned int keep;      //!< number of rotated log files to keep
+			bool compress;          //!< compress rotated log files
+
+		};
+
+		/**
+		*   @brief constructor
+		*   @param filename log file name
+		*   @param policy rotation policy
+		*   @param append boolean flag to indicate whether to append to
+		*                 the log file or truncate the file if already
+		*                 exists
+		*
+		*   @param mode file mode to open the log files with
+		*
+		*   Open @c filename for writing. The file will be created if it
+		*   doesn't exist.
+		*
+		*   Stale partially compressed files are removed and rotated log
+		*   files left pending are compressed ( or shifted in as
+		*   @c filename.1 if compression is disabled ).
+		*
+		*   @note Compression requires the library to be built with zlib,
+		*         otherwise a logexception is thrown.
+		*
+		*/
+		logrotator( const char * filename, const policy_t &policy,
+				bool append = true, mode_t mode = 00644 ) throw( logexception );
+
+		/**
+		*   @brief destructor
+		*
+		*   Close the log file. If compression is enabled this waits for
+		*   all the rotated log files to be compressed.
+		*
+		*/
+		virtual ~logrotator() throw();
+
+		/**
+		*   @brief get the log file descriptor
+		*   @return log file descriptor
+		*/
+		int fd() const throw();
+
+		/**
+		*   @brief account for data written out to the log file
+		*   @param n number of bytes written out
+		*
+		*   This must be called after each write to the log file
+		*   descriptor and will rotate the log file if the size limit
+		*   is reached or the time boundary has passed.
+		*
+		*   @note If another thread is already rotating the log file
+		*         then this returns without waiting for it.
+		*
+		*/
+		void written( size_t n ) throw();
+
+		/**
+		*   @brief rotate the log file
+		*   @return boolean @c true on success or @c false otherwise
+		*/
+		bool rotate() throw();
+
+		/**
+		*   @brief get the number of log file rotations
+		*   @return number of successful log file rotations
+		*/
+		size_t rotations() const throw();
+
+
+	private:
+
+		/** log file name */
+		std::string _filename;
+
+		/** rotation policy */
+		policy_t _policy;
+
+		/** file mode */
+		mode_t _mode;
+
+		/** log file descriptor */
+		int _fd;
+
+		/** bytes written to the current log file */
+		size_t _size;
+
+		/** next rotation time boundary */
+		time_t _next;
+
+		/** flag to indicate a rotation is in progress */
+		int _rotating;
+
+		/** rotations count */
+		size_t _rotations;
+
+		/** rotated log file name sequence */
+		unsigned int _sequence;
+
+		/** rotated log files waiting to be compressed */
+		std::deque<std::string> _pending;
+
+		/** flag to indicate the compression thread to stop */
+		bool _stop;
+
+		/** compression queue mutex */
+		pthread_mutex_t _mutex;
+
+		/** condition to signal rotated log files to compress */
+		pthread_cond_t _cond;
+
+		/** compression thread */
+		pthread_t _thread;
+
+		/** get the rotated log file name for @c index */
+		std::string rname( unsigned int index, const char * suffix = "" ) const throw();
+
+		/** get a unique name for a rotated log file waiting to be compressed */
+		std::string pname() throw();
+
+		/** recover rotated log files left behind by a previous process */
+		void recover() throw();
+
+		/** compression thread main loop */
+		void run() throw();
+
+		/** compress a rotated log file as the newest compressed file */
+		void compress( const std::string &filename ) throw();
+
+		/** compression thread entry point */
+		static void * start( void * arg ) throw();
+
+		/** get the time boundary following @c t */
+		time_t boundary( time_t t ) const throw();
+
+		// disallow copying
+		logrotator( const logrotator & );
+		logrotator &operator =( const logrotator & );
+
+	};
+
+} /* end of namespace logstreamxx */
+
+#endif /* !LOGSTREAMXX_LOGROTATOR_H */
+
@@ -0,0 +1,48 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logsink.h"
+
+
+namespace logstreamxx {
+
+	logsink::logsink() throw() : _mask( 0xff ) {
+
+	}
+
+
+	logsink::~logsink() throw() {
+
+	}
+
+
+	int logsink::setlogmask( int mask ) throw() {
+
+		// sanity check
+		if ( mask == 0 ) {
+			return __atomic_load_n( &_mask, __ATOMIC_RELAXED );
+		}
+
+		// update and return the previous mask
+		return __atomic_exchange_n( &_mask, mask, __ATOMIC_RELAXED );
+
+	}
+
+} /* end of namespace logstreamxx */
+
@@ -0,0 +1,113 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTREAMXX_LOGSINK_H
+#define LOGSTREAMXX_LOGSINK_H
+
+#include <logstreamxx/priority.h>
+
+#include <sys/uio.h>
+
+
+namespace logstreamxx {
+
+	/**
+	*   @brief Log sink interface class
+	*
+	*   Base class for log record destinations. Log stream buffers format
+	*   a log record once and hand it over to a log sink as a list of
+	*   parts which must be written out as a single log record.
+	*
+	*   Each log sink has its own log priority mask, using the
+	*   priority::mask bits, in addition to the log stream mask.
+	*
+	*/
+	class logsink {
+	public:
+
+		/**
+		*   @brief constructor
+		*
+		*   @note The log-mask defaults to all priorities.
+		*
+		*/
+		logsink() throw();
+
+		/**
+		*   @brief destructor
+		*/
+		virtual ~logsink() throw();
+
+		/**
+		*   @brief write a log record
+		*   @param p log priority of the record
+		*   @param iov log record parts
+		*   @param iovcnt number of log record parts
+		*   @return boolean @c true on success or @c false otherwise
+		*
+		*   Write out the @c iovcnt parts described by @c iov as a single
+		*   log record. The parts must not be modified.
+		*
+		*   @note Log sinks must be thread-safe if they are shared between
+		*         threads ( e.g. with sharedlogstream ).
+		*
+		*/
+		virtual bool write( const priority::log_priority_t &p, const iovec * iov, int iovcnt ) throw() = 0;
+
+		/**
+		*   @brief set log priority mask
+		*   @param mask log priority mask
+		*   @return previous log priority mask
+		*
+		*   This method sets the log-mask for the log sink and returns the
+		*   previous log-mask. If the @c mask is 0 then the current
+		*   log-mask is not modified.
+		*
+		*/
+		int setlogmask( int mask ) throw();
+
+		/**
+		*   @brief check whether a priority is enabled for this sink
+		*   @param p log priority
+		*   @return boolean @c true if log records with priority @c p
+		*           should be written to this sink or @c false otherwise
+		*/
+		bool enabled( const priority::log_priority_t &p ) const throw();
+
+
+	private:
+
+		/** log priority mask */
+		int _mask;
+
+		// disallow copying
+		logsink( const logsink & );
+		logsink &operator =( const logsink & );
+
+	};
+
+
+	inline bool logsink::enabled( const priority::log_priority_t &p ) const throw() {
+		return ( ( 1 << p ) & __atomic_load_n( &_mask, __ATOMIC_RELAXED ) ) != 0;
+	}
+
+} /* end of namespace logstreamxx */
+
+#endif /* !LOGSTREAMXX_LOGSINK_H */
+
@@ -0,0 +1,508 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logsocketsink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+
+namespace logstreamxx {
+
+	logsocketsink::logsocketsink( const char * address, const framing_t &framing, size_t capacity ) throw( logexception ) :
+			_address( address ), _framing( framing ), _capacity( capacity ), _fd( -1 ), _connected( 0 ),
+			_offset( 0 ), _stop( false ) {
+
+		// sanity checks
+		if ( _address.empty() || ( ( _address[0] == '/' ) ?
+				( _address.length() >= sizeof( ( (sockaddr_un *) 0 )->sun_path ) ) :
+				( _address.rfind( ':' ) == std::string::npos ) ) ) {
+			throw logexception( "Invalid socket address" );
+		}
+
+		if ( _capacity == 0 ) {
+			throw logexception( "Invalid spool capacity" );
+		}
+
+		memset( &_stats, 0, sizeof( _stats ) );
+
+		// synchronisation primitives, timed waits use the monotonic clock
+		pthread_condattr_t attr;
+		pthread_condattr_init( &attr );
+		pthread_condattr_setclock( &attr, CLOCK_MONOTONIC );
+
+		pthread_mutex_init( &_mutex, 0 );
+		pthread_cond_init( &_cond, &attr );
+		pthread_condattr_destroy( &attr );
+
+		// start the background thread
+		if ( ( errno = pthread_create( &_thread, 0, &logsocketsink::start, this ) ) != 0 ) {
+
+			// cleanup
+			pthread_cond_destroy( &_cond );
+			pthread_mutex_destroy( &_mutex );
+
+			// throw a log exception with system message
+			throw logexception();
+
+		}
+
+	}
+
+
+	logsocketsink::~logsocketsink() throw() {
+
+		// signal the background thread to stop
+		pthread_mutex_lock( &_mutex );
+		_stop = true;
+		pthread_cond_signal( &_cond );
+		pthread_mutex_unlock( &_mutex );
+
+		// wait for the background thread
+		pthread_join( _thread, 0 );
+
+		if ( _fd != -1 ) {
+			::close( _fd );
+		}
+
+		// cleanup
+		pthread_cond_destroy( &_cond );
+		pthread_mutex_destroy( &_mutex );
+
+	}
+
+
+	void * logsocketsink::start( void * arg ) throw() {
+
+		// log sink instance
+		logsocketsink * s = (logsocketsink *) arg;
+		s->run();
+
+		return 0;
+
+	}
+
+
+	long long logsocketsink::now() throw() {
+
+		timespec ts;
+		clock_gettime( CLOCK_MONOTONIC, &ts );
+
+		return ( (long long) ts.tv_sec * 1000 ) + ( ts.tv_nsec / 1000000 );
+
+	}
+
+
+	bool logsocketsink::write( const priority::log_priority_t &, const iovec * iov, int iovcnt ) throw() {
+
+		// log record size
+		size_t n = 0;
+		for ( int i = 0; i < iovcnt; i++ ) {
+			n += iov[i].iov_len;
+		}
+
+		// sanity check
+		if ( n == 0 ) {
+			return true;
+		}
+
+		// check - new line to be added?
+		bool terminate = ( _framing == newline ) && ( iov[iovcnt - 1].iov_len > 0 ) &&
+				( ( (const char *) iov[iovcnt - 1].iov_base )[iov[iovcnt - 1].iov_len - 1] != '\n' );
+
+		// framed size
+		size_t framed = n + ( ( _framing == length ) ? 4 : 0 ) + ( terminate ? 1 : 0 );
+
+		pthread_mutex_lock( &_mutex );
+
+		// check - spool full?
+		if ( ( _spool.size() + framed ) > _capacity ) {
+
+			_stats.dropped_records++;
+			_stats.dropped_bytes += framed;
+
+			pthread_mutex_unlock( &_mutex );
+			return true;
+
+		}
+
+		bool signal = _spool.empty();
+
+		if ( _framing == length ) {
+			unsigned char prefix[4] = { (unsigned char) ( n >> 24 ), (unsigned char) ( n >> 16 ),
+					(unsigned char) ( n >> 8 ), (unsigned char) n };
+			_spool.insert( _spool.end(), prefix, prefix + 4 );
+		}
+
+		for ( int i = 0; i < iovcnt; i++ ) {
+			const char * data = (const char *) iov[i].iov_base;
+			_spool.insert( _spool.end(), data, data + iov[i].iov_len );
+		}
+
+		if ( terminate ) {
+			_spool.push_back( '\n' );
+		}
+
+		_spool_ends.push_back( _spool.size() );
+
+		_stats.spooled_records++;
+		_stats.spooled_bytes += framed;
+
+		// wake up the background thread if the spool was empty
+		if ( signal ) {
+			pthread_cond_signal( &_cond );
+		}
+
+		pthread_mutex_unlock( &_mutex );
+
+		return true;
+
+	}
+
+
+	void logsocketsink::run() throw() {
+
+		long long backoff = LOGSOCKETSINK_BACKOFF_MIN;
+		long long retry   = 0;
+		long long linger  = 0;
+
+		for (;;) {
+
+			pthread_mutex_lock( &_mutex );
+
+			// take over the spooled log records once connected and the batch is sent
+			if ( ( _fd != -1 ) && _batch.empty() && (! _spool.empty() ) ) {
+				_batch.swap( _spool );
+				_batch_ends.swap( _spool_ends );
+				_offset = 0;
+			}
+
+			bool stop = _stop;
+			pthread_mutex_unlock( &_mutex );
+
+			if ( stop && ( linger == 0 ) ) {
+				linger = now() + LOGSOCKETSINK_LINGER;
+			}
+
+			// check - asked to stop and nothing left to send or out of time?
+			if ( stop && ( _batch.empty() || ( _fd == -1 ) || ( now() >= linger ) ) ) {
+				break;
+			}
+
+			// connect ( or reconnect after backing off )
+			if ( _fd == -1 ) {
+
+				if ( now() >= retry ) {
+
+					if ( sconnect() ) {
+						backoff = LOGSOCKETSINK_BACKOFF_MIN;
+						continue;
+					}
+
+					retry   = now() + backoff;
+					backoff = std::min( backoff * 2, (long long) LOGSOCKETSINK_BACKOFF_MAX );
+
+				}
+
+				pthread_mutex_lock( &_mutex );
+				if (! _stop ) {
+					wait( retry - now() );
+				}
+				pthread_mutex_unlock( &_mutex );
+
+				continue;
+
+			}
+
+			// check - anything to send?
+			if ( _batch.empty() ) {
+
+				// check - connection closed by the collector?
+				if ( sclosed() ) {
+					sclose();
+					retry = now() + backoff;
+					continue;
+				}
+
+				pthread_mutex_lock( &_mutex );
+				if ( _spool.empty() && (! _stop ) ) {
+					wait( LOGSOCKETSINK_BACKOFF_MIN );
+				}
+				pthread_mutex_unlock( &_mutex );
+
+				continue;
+
+			}
+
+			ssize_t n = send( _fd, &_batch[_offset], _batch.size() - _offset, MSG_DONTWAIT | MSG_NOSIGNAL );
+
+			if ( n > 0 ) {
+
+				_offset += n;
+
+				// check - batch sent?
+				if ( _offset == _batch.size() ) {
+
+					pthread_mutex_lock( &_mutex );
+					_stats.sent_records += _batch_ends.size();
+					pthread_mutex_unlock( &_mutex );
+
+					_batch.clear();
+					_batch_ends.clear();
+					_offset = 0;
+
+				}
+
+				continue;
+
+			}
+
+			// retry if interrupted
+			if ( ( n < 0 ) && ( errno == EINTR ) ) {
+				continue;
+			}
+
+			// wait for the collector to catch up
+			if ( ( n < 0 ) && ( ( errno == EAGAIN ) || ( errno == EWOULDBLOCK ) ) ) {
+
+				pollfd pfd = { _fd, POLLOUT, 0 };
+				poll( &pfd, 1, LOGSOCKETSINK_BACKOFF_MIN );
+
+				continue;
+
+			}
+
+			// connection lost
+			sclose();
+			retry = now() + backoff;
+
+		}
+
+		// account for the log records which couldn't be sent
+		pthread_mutex_lock( &_mutex );
+
+		if (! _batch.empty() ) {
+
+			size_t sent  = std::upper_bound( _batch_ends.begin(), _batch_ends.end(), _offset ) - _batch_ends.begin();
+			size_t start = ( sent > 0 ) ? _batch_ends[sent - 1] : 0;
+
+			_stats.sent_records    += sent;
+			_stats.dropped_records += _batch_ends.size() - sent;
+			_stats.dropped_bytes   += _batch.size() - start;
+
+		}
+
+		_stats.dropped_records += _spool_ends.size();
+		_stats.dropped_bytes   += _spool.size();
+
+		pthread_mutex_unlock( &_mutex );
+
+	}
+
+
+	bool logsocketsink::sconnect() throw() {
+
+		int fd = -1;
+
+		if ( _address[0] == '/' ) {
+
+			// Unix socket
+			sockaddr_un addr;
+			memset( &addr, 0, sizeof( addr ) );
+			addr.sun_family = AF_UNIX;
+			memcpy( addr.sun_path, _address.c_str(), _address.length() );
+
+			fd = sconnect( AF_UNIX, 0, (sockaddr *) &addr, sizeof( addr ) );
+
+		} else {
+
+			// TCP socket ( "host:port" )
+			size_t colon = _address.rfind( ':' );
+			std::string host = _address.substr( 0, colon );
+			std::string port = _address.substr( colon + 1 );
+
+			// strip brackets around IPv6 addresses
+			if ( ( host.length() > 1 ) && ( host[0] == '[' ) && ( host[host.length() - 1] == ']' ) ) {
+				host = host.substr( 1, host.length() - 2 );
+			}
+
+			addrinfo hints;
+			memset( &hints, 0, sizeof( hints ) );
+			hints.ai_family   = AF_UNSPEC;
+			hints.ai_socktype = SOCK_STREAM;
+
+			addrinfo * result = 0;
+			if ( getaddrinfo( host.c_str(), port.c_str(), &hints, &result ) != 0 ) {
+				return false;
+			}
+
+			for ( addrinfo * ai = result; ( ai != 0 ) && ( fd == -1 ); ai = ai->ai_next ) {
+
+				fd = sconnect( ai->ai_family, ai->ai_protocol, ai->ai_addr, ai->ai_addrlen );
+
+			}
+
+			freeaddrinfo( result );
+
+		}
+
+		if ( fd == -1 ) {
+			return false;
+		}
+
+		_fd = fd;
+		__atomic_store_n( &_connected, 1, __ATOMIC_RELEASE );
+
+		pthread_mutex_lock( &_mutex );
+		_stats.connects++;
+		pthread_mutex_unlock( &_mutex );
+
+		return true;
+
+	}
+
+
+	int logsocketsink::sconnect( int domain, int protocol, const sockaddr * addr, socklen_t addrlen ) throw() {
+
+		int fd = socket( domain, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, protocol );
+
+		if ( fd == -1 ) {
+			return -1;
+		}
+
+		if ( connect( fd, addr, addrlen ) == 0 ) {
+			return fd;
+		}
+
+		// wait for the connection to be established, for a limited time
+		if ( errno == EINPROGRESS ) {
+
+			pollfd pfd = { fd, POLLOUT, 0 };
+			int error = 0;
+			socklen_t len = sizeof( error );
+
+			if ( ( poll( &pfd, 1, LOGSOCKETSINK_LINGER ) == 1 ) &&
+					( getsockopt( fd, SOL_SOCKET, SO_ERROR, &error, &len ) == 0 ) && ( error == 0 ) ) {
+				return fd;
+			}
+
+		}
+
+		::close( fd );
+
+		return -1;
+
+	}
+
+
+	void logsocketsink::sclose() throw() {
+
+		::close( _fd );
+		_fd = -1;
+		__atomic_store_n( &_connected, 0, __ATOMIC_RELEASE );
+
+		// send the interrupted log record again in full
+		if (! _batch.empty() ) {
+
+			std::vector<size_t>::iterator it = std::upper_bound( _batch_ends.begin(), _batch_ends.end(), _offset );
+			size_t sent  = it - _batch_ends.begin();
+			size_t start = ( sent > 0 ) ? _batch_ends[sent - 1] : 0;
+
+			_batch.erase( _batch.begin(), _batch.begin() + start );
+			_batch_ends.erase( _batch_ends.begin(), it );
+
+			for ( size_t i = 0; i < _batch_ends.size(); i++ ) {
+				_batch_ends[i] -= start;
+			}
+
+			_offset = 0;
+
+			pthread_mutex_lock( &_mutex );
+			_stats.sent_records += sent;
+			pthread_mutex_unlock( &_mutex );
+
+		}
+
+	}
+
+
+	bool logsocketsink::sclosed() throw() {
+
+		pollfd pfd = { _fd, POLLIN, 0 };
+
+		if ( poll( &pfd, 1, 0 ) <= 0 ) {
+			return false;
+		}
+
+		// discard anything sent by the collector
+		char buffer[256];
+		ssize_t n = recv( _fd, buffer, sizeof( buffer ), MSG_DONTWAIT );
+
+		return ( n == 0 ) || ( ( n < 0 ) && ( errno != EAGAIN ) && ( errno != EWOULDBLOCK ) && ( errno != EINTR ) );
+
+	}
+
+
+	void logsocketsink::wait( long ms ) throw() {
+
+		// sanity check
+		if ( ms <= 0 ) {
+			return;
+		}
+
+		timespec ts;
+		clock_gettime( CLOCK_MONOTONIC, &ts );
+
+		ts.tv_sec  += ms / 1000;
+		ts.tv_nsec += ( ms % 1000 ) * 1000000;
+
+		if ( ts.tv_nsec >= 1000000000 ) {
+			ts.tv_sec++;
+			ts.tv_nsec -= 1000000000;
+		}
+
+		pthread_cond_timedwait( &_cond, &_mutex, &ts );
+
+	}
+
+
+	bool logsocketsink::connected() const throw() {
+		return __atomic_load_n( &_connected, __ATOMIC_ACQUIRE ) != 0;
+	}
+
+
+	logsocketsink::stats_t logsocketsink::stats() const throw() {
+
+		pthread_mutex_lock( &_mutex );
+		stats_t stats = _stats;
+		pthread_mutex_unlock( &_mutex );
+
+		return stats;
+
+	}
+
+} /* end of namespace logstreamxx */
+
@@ -0,0 +1,222 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTREAMXX_LOGSOCKETSINK_H
+#define LOGSTREAMXX_LOGSOCKETSINK_H
+
+#include <logstreamxx/logsink.h>
+#include <logstreamxx/logexception.h>
+
+#include <ctime>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <sys/socket.h>
+
+#ifndef LOGSOCKETSINK_SPOOL_SIZE
+#define LOGSOCKETSINK_SPOOL_SIZE 1048576
+#endif
+
+#ifndef LOGSOCKETSINK_BACKOFF_MIN
+#define LOGSOCKETSINK_BACKOFF_MIN 100
+#endif
+
+#ifndef LOGSOCKETSINK_BACKOFF_MAX
+#define LOGSOCKETSINK_BACKOFF_MAX 30000
+#endif
+
+#ifndef LOGSOCKETSINK_LINGER
+#define LOGSOCKETSINK_LINGER 1000
+#endif
+
+
+namespace logstreamxx {
+
+	/**
+	*   @brief Stream socket log sink class
+	*
+	*   Ships log records to a collector ( e.g. a local log aggregator )
+	*   over a TCP or Unix stream socket, newline-delimited or length
+	*   prefixed.
+	*
+	*   Log records are copied into a bounded in-memory spool and sent
+	*   by a background thread using non-blocking sends, so a slow or
+	*   unreachable collector never blocks the logging thread. When the
+	*   spool is full new log records are dropped and counted. The
+	*   background thread connects on demand and reconnects with an
+	*   exponential back-off ( LOGSOCKETSINK_BACKOFF_MIN to
+	*   LOGSOCKETSINK_BACKOFF_MAX milliseconds ) when the connection
+	*   fails or is closed by the collector. A log record interrupted
+	*   by a lost connection is sent again in full after reconnecting.
+	*
+	*   @note Memory use is bounded to twice the spool capacity, the
+	*         spool and the batch being sent.
+	*
+	*/
+	class logsocketsink : public logsink {
+	public:
+
+		/**
+		*   @brief log record framing type
+		*/
+		enum framing_t {
+			newline  = 0,       //!< log records terminated by a new line
+			length   = 1        //!< log records prefixed by a 32-bit big-endian length
+		};
+
+		/**
+		*   @brief counters type
+		*/
+		struct stats_t {
+			size_t spooled_records;     //!< log records spooled
+			size_t spooled_bytes;       //!< bytes spooled ( framed log records )
+			size_t dropped_records;     //!< log records dropped
+			size_t dropped_bytes;       //!< bytes dropped ( framed log records )
+			size_t sent_records;        //!< log records sent
+			size_t connects;            //!< successful connections
+		};
+
+		/**
+		*   @brief constructor
+		*   @param address collector address, a Unix socket path
+		*          ( starting with @c '/' ) or @c "host:port"
+		*   @param framing log record framing
+		*   @param capacity spool capacity in bytes
+		*
+		*   Start the background thread which connects to the collector.
+		*   The collector does not need to be reachable at this point.
+		*
+		*/
+		logsocketsink( const char * address, const framing_t &framing = newline,
+				size_t capacity = LOGSOCKETSINK_SPOOL_SIZE ) throw( logexception );
+
+		/**
+		*   @brief destructor
+		*
+		*   Stop the background thread. Spooled log records are sent
+		*   out if connected, waiting for up to LOGSOCKETSINK_LINGER
+		*   milliseconds, and any left over are counted as dropped.
+		*
+		*/
+		virtual ~logsocketsink() throw();
+
+		/**
+		*   @brief spool a log record to be sent
+		*   @return boolean @c true, dropped log records are accounted
+		*           for by the log sink instead
+		*
+		*   @sa logsink::write()
+		*
+		*/
+		virtual bool write( const priority::log_priority_t &p, const iovec * iov, int iovcnt ) throw();
+
+		/**
+		*   @brief check whether connected to the collector
+		*   @return boolean @c true if connected
+		*/
+		bool connected() const throw();
+
+		/**
+		*   @brief get the counters
+		*   @return counters
+		*/
+		stats_t stats() const throw();
+
+
+	private:
+
+		/** collector address */
+		std::string _address;
+
+		/** log record framing */
+		framing_t _framing;
+
+		/** spool capacity */
+		size_t _capacity;
+
+		/** socket ( -1 if not connected ) */
+		int _fd;
+
+		/** flag to indicate whether connected */
+		int _connected;
+
+		/** spooled log records */
+		std::vector<char> _spool;
+
+		/** spooled log record end offsets */
+		std::vector<size_t> _spool_ends;
+
+		/** batch being sent */
+		std::vector<char> _batch;
+
+		/** batch log record end offsets */
+		std::vector<size_t> _batch_ends;
+
+		/** batch bytes sent so far */
+		size_t _offset;
+
+		/** counters */
+		stats_t _stats;
+
+		/** flag to indicate the background thread to stop */
+		bool _stop;
+
+		/** mutex to guard the spool and the counters */
+		mutable pthread_mutex_t _mutex;
+
+		/** condition to signal new log records in the spool */
+		pthread_cond_t _cond;
+
+		/** background thread */
+		pthread_t _thread;
+
+		/** background thread main loop */
+		void run() throw();
+
+		/** connect to the collector */
+		bool sconnect() throw();
+
+		/** close the connection, to be sent again from the interrupted log record */
+		void sclose() throw();
+
+		/** check whether the connection was closed by the collector */
+		bool sclosed() throw();
+
+		/** wait for new log records for up to @c ms milliseconds */
+		void wait( long ms ) throw();
+
+		/** background thread entry point */
+		static void * start( void * arg ) throw();
+
+		/** connect a non-blocking stream socket to @c addr */
+		static int sconnect( int domain, int protocol, const sockaddr * addr, socklen_t addrlen ) throw();
+
+		/** get the monotonic clock time in milliseconds */
+		static long long now() throw();
+
+		// disallow copying
+		logsocketsink( const logsocketsink & );
+		logsocketsink &operator =( const logsocketsink & );
+
+	};
+
+} /* end of namespace logstreamxx */
+
+#endif /* !LOGSTREAMXX_LOGSOCKETSINK_H */
+
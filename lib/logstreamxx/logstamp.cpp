@@ -0,0 +1,80 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logstamp.h"
+
+#include <cstring>
+
+
+namespace logstreamxx {
+
+	const size_t logstamp::size;
+
+
+	logstamp::logstamp() throw() : _sec( -1 ) {
+
+	}
+
+
+	size_t logstamp::now( char * buffer ) throw() {
+
+		timeval tv;
+
+		// current timestamp
+		gettimeofday( &tv, 0 );
+
+		return format( buffer, tv );
+
+	}
+
+
+	size_t logstamp::format( char * buffer, const timeval &tv ) throw() {
+
+		// check - do we need to re-format the date and time part?
+		if ( tv.tv_sec != _sec ) {
+
+			tm ti;
+			localtime_r( &tv.tv_sec, &ti );
+
+			// format
+			if ( strftime( _cache, sizeof( _cache ), "%b %e %T", &ti ) != 15 ) {
+				memset( _cache, ' ', 15 );
+			}
+
+			_cache[15] = '.';
+			_sec = tv.tv_sec;
+
+		}
+
+		// date and time
+		memcpy( buffer, _cache, sizeof( _cache ) );
+
+		// microseconds
+		unsigned int usec = tv.tv_usec;
+		for ( int i = size - 1; i >= (int) sizeof( _cache ); i-- ) {
+			buffer[i] = '0' + ( usec % 10 );
+			usec /= 10;
+		}
+
+		return size;
+
+	}
+
+} /* end of namespace logstreamxx */
+
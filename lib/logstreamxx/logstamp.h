@@ -0,0 +1,89 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTREAMXX_LOGSTAMP_H
+#define LOGSTREAMXX_LOGSTAMP_H
+
+#include <cstddef>
+#include <ctime>
+#include <sys/time.h>
+
+
+namespace logstreamxx {
+
+	/**
+	*   @brief Log timestamp formatter class
+	*
+	*   Formats log timestamps ( @c "%b %e %T.usec" ) into caller supplied
+	*   buffers. The date and time part is cached and only re-formatted
+	*   when the seconds value changes, for every other timestamp only the
+	*   microsecond digits are patched in.
+	*
+	*   @note Instances are not thread-safe, each log stream buffer owns
+	*         its own formatter.
+	*
+	*/
+	class logstamp {
+	public:
+
+		/** formatted timestamp size */
+		static const size_t size = 22;
+
+		/**
+		*   @brief constructor
+		*/
+		logstamp() throw();
+
+		/**
+		*   @brief format the current time
+		*   @param buffer output buffer of at least logstamp::size characters
+		*   @return number of characters written to @c buffer
+		*
+		*   Format the current time into @c buffer. The output is not
+		*   null terminated.
+		*
+		*/
+		size_t now( char * buffer ) throw();
+
+		/**
+		*   @brief format a timestamp
+		*   @param buffer output buffer of at least logstamp::size characters
+		*   @param tv timestamp to format
+		*   @return number of characters written to @c buffer
+		*
+		*   Format @c tv into @c buffer. The output is not null terminated.
+		*
+		*/
+		size_t format( char * buffer, const timeval &tv ) throw();
+
+
+	private:
+
+		/** seconds value of the cached date and time */
+		time_t _sec;
+
+		/** cached date and time ( @c "%b %e %T." ) */
+		char _cache[16];
+
+	};
+
+} /* end of namespace logstreamxx */
+
+#endif /* !LOGSTREAMXX_LOGSTAMP_H */
+
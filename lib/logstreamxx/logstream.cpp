@@ -18,6 +18,7 @@
 */
 
 #include "logstream.h"
+#include "lognumput.h"
 
 #include <fcntl.h>
 #include <unistd.h>
@@ -25,55 +26,202 @@
 
 namespace logstreamxx {
 
-	logstream::logstream() throw() : std::ostream( 0 ), _fd( -1 ) {
+	logstream::logstream() throw() : std::ostream( 0 ), _fd( -1 ), _writer( 0 ), _rotator( 0 ) {
 
 		// log stream buffer instance
 		logstreambuf * sb = new logstreambuf();
 
 		// update output buffer
-		rdbuf( sb );
+		linit( sb );
 
 	}
 
 
-	logstream::logstream( const char * filename, bool append, mode_t mode ) throw( logexception ) :
-			std::ostream ( 0 ), _fd( -1 ) {
+	logstream::logstream( const char * filename, bool append, mode_t mode,
+			size_t buffer_size, size_t buffer_limit ) throw( logexception ) :
+			std::ostream ( 0 ), _fd( -1 ), _writer( 0 ), _rotator( 0 ) {
 
-		// set file open flags
-		int flags = O_WRONLY | O_CREAT | O_APPEND;
+		// sanity check
+		if ( buffer_size < 2 ) {
+			throw logexception( "Invalid buffer size" );
+		}
 
-		// truncate file?
-		if (! append ) {
-			flags |= O_TRUNC;
+		// open file
+		lopen( filename, append, mode );
+
+		// log stream buffer instance
+		logstreambuf * sb = new logstreambuf( _fd );
+		lbuffer( sb, buffer_size, buffer_limit );
+
+		// update output buffer
+		linit( sb );
+
+	}
+
+
+	logstream::logstream( const logwriter::overflow_t &overflow, size_t capacity,
+			size_t buffer_size, size_t buffer_limit ) throw( logexception ) :
+			std::ostream( 0 ), _fd( -1 ), _writer( 0 ), _rotator( 0 ) {
+
+		// sanity check
+		if ( buffer_size < 2 ) {
+			throw logexception( "Invalid buffer size" );
+		}
+
+		// background log writer
+		_writer = new logwriter( STDOUT_FILENO, overflow, capacity );
+
+		// log stream buffer instance
+		logstreambuf * sb = new logstreambuf( _writer );
+		lbuffer( sb, buffer_size, buffer_limit );
+
+		// update output buffer
+		linit( sb );
+
+	}
+
+
+	logstream::logstream( const char * filename, const logwriter::overflow_t &overflow,
+			size_t capacity, bool append, mode_t mode, size_t buffer_size,
+			size_t buffer_limit ) throw( logexception ) :
+			std::ostream( 0 ), _fd( -1 ), _writer( 0 ), _rotator( 0 ) {
+
+		// sanity check
+		if ( buffer_size < 2 ) {
+			throw logexception( "Invalid buffer size" );
 		}
 
 		// open file
-		_fd = ::open( filename, flags, mode );
+		lopen( filename, append, mode );
 
-		// check - was the open file successful?
-		if ( _fd == -1 ) {
-			// throw a log exception with system message
-			throw logexception();
+		// background log writer
+		try {
+			_writer = new logwriter( _fd, overflow, capacity );
+		} catch ( logexception &e ) {
+			::close( _fd );
+			throw;
 		}
 
 		// log stream buffer instance
-		logstreambuf * sb = new logstreambuf( _fd );
+		logstreambuf * sb = new logstreambuf( _writer );
+		lbuffer( sb, buffer_size, buffer_limit );
 
 		// update output buffer
-		rdbuf( sb );
+		linit( sb );
+
+	}
+
+
+	logstream::logstream( logsink * sink ) throw( logexception ) :
+			std::ostream( 0 ), _fd( -1 ), _writer( 0 ), _rotator( 0 ) {
+
+		// log stream buffer instance, this will throw on invalid sinks
+		logstreambuf * sb = new logstreambuf( sink );
+
+		// update output buffer
+		linit( sb );
+
+	}
+
+
+	logstream::logstream( const char * filename, const logrotator::policy_t &rotation,
+			bool append, mode_t mode ) throw( logexception ) :
+			std::ostream( 0 ), _fd( -1 ), _writer( 0 ), _rotator( 0 ) {
+
+		// open file
+		_rotator = new logrotator( filename, rotation, append, mode );
+
+		// log stream buffer instance
+		logstreambuf * sb = new logstreambuf( _rotator );
+
+		// update output buffer
+		linit( sb );
+
+	}
+
+
+	logstream::logstream( const char * filename, const logrotator::policy_t &rotation,
+			const logwriter::overflow_t &overflow, size_t capacity, bool append,
+			mode_t mode ) throw( logexception ) :
+			std::ostream( 0 ), _fd( -1 ), _writer( 0 ), _rotator( 0 ) {
+
+		// open file
+		_rotator = new logrotator( filename, rotation, append, mode );
+
+		// background log writer
+		try {
+			_writer = new logwriter( _rotator, overflow, capacity );
+		} catch ( logexception &e ) {
+			delete _rotator;
+			throw;
+		}
+
+		// log stream buffer instance
+		logstreambuf * sb = new logstreambuf( _writer );
+
+		// update output buffer
+		linit( sb );
 
 	}
 
 
 	logstream::~logstream() throw() {
 
+		// cleanup, this will sync any buffered content
+		delete rdbuf();
+
+		// write out queued log records and stop the writer
+		delete _writer;
+
+		// close any rotated log files
+		delete _rotator;
+
 		// close any open files
-		if ( _fd != 0 ) {
+		if ( _fd != -1 ) {
 			::close( _fd );
 		}
 
-		// cleanup
-		delete rdbuf();
+	}
+
+
+	void logstream::linit( logstreambuf * sb ) throw() {
+
+		rdbuf( sb );
+
+		// locale-free number formatting
+		imbue( std::locale( getloc(), new lognumput() ) );
+
+	}
+
+
+	void logstream::lbuffer( logstreambuf * sb, size_t buffer_size, size_t buffer_limit ) throw() {
+
+		// check - anything other than the defaults?
+		if ( ( buffer_size != LOGSTREAMBUF_SIZE ) || ( buffer_limit != LOGSTREAMBUF_LIMIT ) ) {
+			sb->lbuffer( buffer_size, buffer_limit );
+		}
+
+	}
+
+
+	void logstream::lopen( const char * filename, bool append, mode_t mode ) throw( logexception ) {
+
+		// set file open flags
+		int flags = O_WRONLY | O_CREAT | O_APPEND;
+
+		// truncate file?
+		if (! append ) {
+			flags |= O_TRUNC;
+		}
+
+		// open file
+		_fd = ::open( filename, flags, mode );
+
+		// check - was the open file successful?
+		if ( _fd == -1 ) {
+			// throw a log exception with system message
+			throw logexception();
+		}
 
 	}
 
@@ -117,5 +265,53 @@ namespace logstreamxx {
 
 	}
 
+
+	bool logstream::logpattern( const std::string &pattern ) throw() {
+
+		// log stream buffer
+		logstreambuf * sb = (logstreambuf *) rdbuf();
+
+		return sb->lpattern( pattern );
+
+	}
+
+
+	void logstream::logflush( const logstreambuf::flush_policy_t &policy ) throw() {
+
+		// log stream buffer
+		logstreambuf * sb = (logstreambuf *) rdbuf();
+
+		sb->lflush( policy );
+
+	}
+
+
+	void logstream::logformat( const logstreambuf::format_t &format ) throw() {
+
+		// log stream buffer
+		logstreambuf * sb = (logstreambuf *) rdbuf();
+
+		sb->lformat( format );
+
+	}
+
+
+	bool logstream::logdurability( const logfdsink::durability_t &policy ) throw() {
+
+		// log stream buffer
+		logstreambuf * sb = (logstreambuf *) rdbuf();
+
+		// check - writing to a file descriptor?
+		logfdsink * sink = dynamic_cast<logfdsink *>( sb->lsink() );
+		if ( sink == 0 ) {
+			return false;
+		}
+
+		sink->durability( policy );
+
+		return true;
+
+	}
+
 } /* end of namespace logstreamxx */
 
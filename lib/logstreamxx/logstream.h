@@ -21,6 +21,7 @@
 #define LOGSTREAMXX_LOGSTREAM_H
 
 #include <logstreamxx/logstreambuf.h>
+#include <logstreamxx/logformatter.h>
 
 #include <ostream>
 #include <sys/stat.h>
@@ -31,7 +32,9 @@ namespace logstreamxx {
 	/**
 	*   @brief Log stream controller class
 	*
-	*   This is the log stream output controller class.
+	*   This is the log stream output controller class. Numbers are
+	*   formatted without going through the locale ( see lognumput ),
+	*   @c std::hex, @c std::oct etc. work as usual.
 	*
 	*/
 	class logstream : public std::ostream {
@@ -54,17 +57,130 @@ namespace logstreamxx {
 		*                 exists
 		*
 		*   @param mode file mode to open the log file with
+		*   @param buffer_size log stream buffer size
+		*   @param buffer_limit maximum size a single log record can grow
+		*                       the log stream buffer to
 		*
 		*   Initialise a log output stream with @c filename as the output
 		*   destination. Destination file will be created if it doesn't exist.
 		*
+		*   @sa logstreambuf::lbuffer()
+		*
+		*/
+		logstream( const char * filename, bool append = true, mode_t mode = 00644,
+				size_t buffer_size = LOGSTREAMBUF_SIZE, size_t buffer_limit = LOGSTREAMBUF_LIMIT ) throw( logexception );
+
+		/**
+		*   @brief overloaded constructor (asynchronous)
+		*   @param overflow queue overflow policy
+		*   @param capacity queue capacity in bytes
+		*   @param buffer_size log stream buffer size
+		*   @param buffer_limit maximum size a single log record can grow
+		*                       the log stream buffer to
+		*
+		*   Initialise a log output stream with standard output ( @c STDOUT )
+		*   as the destination and a background log writer to write out
+		*   the log records.
+		*
+		*   @sa logwriter, logstreambuf::lbuffer()
+		*
+		*/
+		logstream( const logwriter::overflow_t &overflow,
+				size_t capacity = LOGWRITER_QUEUE_SIZE, size_t buffer_size = LOGSTREAMBUF_SIZE,
+				size_t buffer_limit = LOGSTREAMBUF_LIMIT ) throw( logexception );
+
+		/**
+		*   @brief overloaded constructor (asynchronous)
+		*   @param filename log destination filename
+		*   @param overflow queue overflow policy
+		*   @param capacity queue capacity in bytes
+		*   @param append boolean flag to indicate whether to append to
+		*                 the log file or truncate the file if already
+		*                 exists
+		*
+		*   @param mode file mode to open the log file with
+		*   @param buffer_size log stream buffer size
+		*   @param buffer_limit maximum size a single log record can grow
+		*                       the log stream buffer to
+		*
+		*   Initialise a log output stream with @c filename as the output
+		*   destination and a background log writer to write out the log
+		*   records. Destination file will be created if it doesn't exist.
+		*
+		*   @sa logwriter, logstreambuf::lbuffer()
+		*
+		*/
+		logstream( const char * filename, const logwriter::overflow_t &overflow,
+				size_t capacity = LOGWRITER_QUEUE_SIZE, bool append = true,
+				mode_t mode = 00644, size_t buffer_size = LOGSTREAMBUF_SIZE,
+				size_t buffer_limit = LOGSTREAMBUF_LIMIT ) throw( logexception );
+
+		/**
+		*   @brief overloaded constructor
+		*   @param sink log sink
+		*
+		*   Initialise a log output stream which hands over log records
+		*   to @c sink. e.g. a logfanout to write each log record to
+		*   multiple destinations.
+		*
+		*   @note The log sink is not owned by the log stream and must
+		*         outlive it.
+		*
+		*   @sa logsink
+		*
+		*/
+		logstream( logsink * sink ) throw( logexception );
+
+		/**
+		*   @brief overloaded constructor (log rotation)
+		*   @param filename log destination filename
+		*   @param rotation log file rotation policy
+		*   @param append boolean flag to indicate whether to append to
+		*                 the log file or truncate the file if already
+		*                 exists
+		*
+		*   @param mode file mode to open the log files with
+		*
+		*   Initialise a log output stream with @c filename as the output
+		*   destination which is rotated according to @c rotation.
+		*   Destination file will be created if it doesn't exist.
+		*
+		*   @sa logrotator
+		*
 		*/
-		logstream( const char * filename, bool append = true, mode_t mode = 00644 ) throw( logexception );
+		logstream( const char * filename, const logrotator::policy_t &rotation,
+				bool append = true, mode_t mode = 00644 ) throw( logexception );
+
+		/**
+		*   @brief overloaded constructor (asynchronous, log rotation)
+		*   @param filename log destination filename
+		*   @param rotation log file rotation policy
+		*   @param overflow queue overflow policy
+		*   @param capacity queue capacity in bytes
+		*   @param append boolean flag to indicate whether to append to
+		*                 the log file or truncate the file if already
+		*                 exists
+		*
+		*   @param mode file mode to open the log files with
+		*
+		*   Initialise a log output stream with @c filename as the output
+		*   destination which is rotated according to @c rotation, and a
+		*   background log writer to write out the log records. Log files
+		*   are rotated on the background writer thread.
+		*
+		*   @sa logrotator, logwriter
+		*
+		*/
+		logstream( const char * filename, const logrotator::policy_t &rotation,
+				const logwriter::overflow_t &overflow, size_t capacity = LOGWRITER_QUEUE_SIZE,
+				bool append = true, mode_t mode = 00644 ) throw( logexception );
 
 		/**
 		*   @brief destructor
 		*
-		*   Deallocate associated buffers.
+		*   Deallocate associated buffers. If there is a background log
+		*   writer then all the queued log records are written out before
+		*   returning.
 		*
 		*/
 		virtual ~logstream() throw();
@@ -86,6 +202,18 @@ namespace logstreamxx {
 		*/
 		int loglevel( const priority::log_priority_t &level ) throw();
 
+		/**
+		*   @brief check whether logging is enabled for a priority
+		*   @param p log priority
+		*   @return boolean @c true if log records with priority @c p
+		*           will be written out or @c false otherwise
+		*
+		*   @sa LOGSTREAMXX_LOG() to skip evaluating log statements for
+		*       disabled priorities.
+		*
+		*/
+		bool enabled( const priority::log_priority_t &p ) const throw();
+
 		/**
 		*   @brief set an extra prefix for the log lines
 		*   @param p prefix
@@ -98,14 +226,219 @@ namespace logstreamxx {
 		*/
 		void logprefix( const std::string &p ) throw();
 
+		/**
+		*   @brief set the log line header layout
+		*   @param pattern header layout pattern
+		*   @return boolean @c true on success or @c false if @c pattern
+		*           is invalid
+		*
+		*   This sets the layout of the header before the log message,
+		*   e.g. @c "%t %P/%T [%p] %x" to add the process and thread ids.
+		*
+		*   @sa logstreambuf::lpattern()
+		*
+		*/
+		bool logpattern( const std::string &pattern ) throw();
+
+		/**
+		*   @brief set the flush policy
+		*   @param policy flush policy
+		*
+		*   This sets when completed log records are written out to the
+		*   destination, immediately ( default ) or batched by size, time
+		*   and priority.
+		*
+		*   @sa logstreambuf::lflush()
+		*
+		*/
+		void logflush( const logstreambuf::flush_policy_t &policy ) throw();
+
+		/**
+		*   @brief set the log record format
+		*   @param format log record format
+		*
+		*   This switches between free text log lines ( default ) and
+		*   structured JSON lines or logfmt log records, with the fields
+		*   attached using logfield.
+		*
+		*   @sa logstreambuf::lformat(), logfield
+		*
+		*/
+		void logformat( const logstreambuf::format_t &format ) throw();
+
+		/**
+		*   @brief set the durability policy
+		*   @param policy durability policy
+		*   @return boolean @c true on success or @c false if the log
+		*           stream doesn't write to a file descriptor directly
+		*           ( e.g. asynchronous log streams )
+		*
+		*   e.g. to sync critical log records to disk before returning
+		*   and everything else every second;
+		*
+		*   @code
+		*   logger.logdurability( logfdsink::durability_t( logfdsink::durability_t::group, 1000, priority::crit ) );
+		*   @endcode
+		*
+		*   @sa logfdsink::durability()
+		*
+		*/
+		bool logdurability( const logfdsink::durability_t &policy ) throw();
+
+#if __cplusplus >= 201103L
+		/**
+		*   @brief write a log record using a compile-time format string
+		*   @param p log priority
+		*   @param format format string, see LOGSTREAMXX_FMT()
+		*   @param args arguments to substitute for the @c {} placeholders
+		*   @return reference to this log stream
+		*
+		*   This sets the log priority to @c p and writes out a whole log
+		*   record, no @c std::endl needed. e.g.
+		*
+		*   @code
+		*   logger.logf( priority::info, LOGSTREAMXX_FMT( "user {} took {}ms" ), id, ms );
+		*   @endcode
+		*
+		*   @note The arguments are evaluated even if logging is disabled
+		*         for @c p, use LOGSTREAMXX_LOGF() to skip them.
+		*
+		*   @sa logformatter
+		*
+		*/
+		template<typename F, typename... Args>
+		logstream &logf( const priority::log_priority_t &p, const F &format, const Args &... args ) throw();
+
+		/**
+		*   @brief write a log record at a priority using a compile-time
+		*          format string
+		*   @param format format string, see LOGSTREAMXX_FMT()
+		*   @param args arguments to substitute for the @c {} placeholders
+		*   @return reference to this log stream
+		*
+		*   @sa logf()
+		*
+		*/
+		template<typename F, typename... Args>
+		logstream &emerg( const F &format, const Args &... args ) throw();
+
+		template<typename F, typename... Args>
+		logstream &alert( const F &format, const Args &... args ) throw();
+
+		template<typename F, typename... Args>
+		logstream &crit( const F &format, const Args &... args ) throw();
+
+		template<typename F, typename... Args>
+		logstream &err( const F &format, const Args &... args ) throw();
+
+		template<typename F, typename... Args>
+		logstream &warning( const F &format, const Args &... args ) throw();
+
+		template<typename F, typename... Args>
+		logstream &notice( const F &format, const Args &... args ) throw();
+
+		template<typename F, typename... Args>
+		logstream &info( const F &format, const Args &... args ) throw();
+
+		template<typename F, typename... Args>
+		logstream &debug( const F &format, const Args &... args ) throw();
+#endif
+
 
 	private:
 
 		/** file descriptor */
 		int _fd;
 
+		/** asynchronous log writer (if any) */
+		logwriter * _writer;
+
+		/** log file rotator (if any) */
+		logrotator * _rotator;
+
+		/** set the log stream buffer and the number formatting */
+		void linit( logstreambuf * sb ) throw();
+
+		/** setup the log stream buffer */
+		void lbuffer( logstreambuf * sb, size_t buffer_size, size_t buffer_limit ) throw();
+
+		/** open the log file */
+		void lopen( const char * filename, bool append, mode_t mode ) throw( logexception );
+
 	};
 
+
+	inline bool logstream::enabled( const priority::log_priority_t &p ) const throw() {
+		return static_cast<logstreambuf *>( rdbuf() )->enabled( p );
+	}
+
+#if __cplusplus >= 201103L
+	template<typename F, typename... Args>
+	inline logstream &logstream::logf( const priority::log_priority_t &p, const F &, const Args &... args ) throw() {
+
+		// log stream buffer
+		logstreambuf * sb = static_cast<logstreambuf *>( rdbuf() );
+
+		// set priority for the log stream buffer
+		sb->lpriority( p );
+
+		if ( sb->enabled( p ) ) {
+			logformatter::write<F>( *this, args... );
+		}
+
+		return *this;
+
+	}
+
+
+	template<typename F, typename... Args>
+	inline logstream &logstream::emerg( const F &format, const Args &... args ) throw() {
+		return logf( priority::emerg, format, args... );
+	}
+
+
+	template<typename F, typename... Args>
+	inline logstream &logstream::alert( const F &format, const Args &... args ) throw() {
+		return logf( priority::alert, format, args... );
+	}
+
+
+	template<typename F, typename... Args>
+	inline logstream &logstream::crit( const F &format, const Args &... args ) throw() {
+		return logf( priority::crit, format, args... );
+	}
+
+
+	template<typename F, typename... Args>
+	inline logstream &logstream::err( const F &format, const Args &... args ) throw() {
+		return logf( priority::err, format, args... );
+	}
+
+
+	template<typename F, typename... Args>
+	inline logstream &logstream::warning( const F &format, const Args &... args ) throw() {
+		return logf( priority::warning, format, args... );
+	}
+
+
+	template<typename F, typename... Args>
+	inline logstream &logstream::notice( const F &format, const Args &... args ) throw() {
+		return logf( priority::notice, format, args... );
+	}
+
+
+	template<typename F, typename... Args>
+	inline logstream &logstream::info( const F &format, const Args &... args ) throw() {
+		return logf( priority::info, format, args... );
+	}
+
+
+	template<typename F, typename... Args>
+	inline logstream &logstream::debug( const F &format, const Args &... args ) throw() {
+		return logf( priority::debug, format, args... );
+	}
+#endif
+
 } /* end of namespace logstreamxx */
 
 #endif /* !LOGSTREAMXX_LOGSTREAM_H */
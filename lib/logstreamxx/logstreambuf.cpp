@@ -18,80 +18,310 @@
 */
 
 #include "logstreambuf.h"
+#include "logflusher.h"
+#include "logencoder.h"
+#include "lognumput.h"
 
 #include <unistd.h>
-#include <sstream>
-#include <ctime>
-#include <sys/time.h>
+#include <cstring>
+#include <pthread.h>
+#include <sys/syscall.h>
 
 
 namespace logstreamxx {
 
+	namespace {
+
+		/** number of grown buffer size classes ( powers of 2 ) */
+		const size_t pool_classes = sizeof( size_t ) * 8;
+
+		/** pool of grown buffers, indexed by the size class */
+		char * pool[pool_classes][LOGSTREAMBUF_POOL_SIZE];
+
+		/** number of pooled buffers in each size class */
+		size_t pooled[pool_classes];
+
+		/** pool mutex */
+		pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+		/** get the size class for a buffer of @c n characters */
+		size_t pool_class( size_t n ) throw() {
+
+			size_t k = 0;
+			while ( ( ( (size_t) 1 ) << k ) < n ) {
+				k++;
+			}
+
+			return k;
+
+		}
+
+
+		/** get a buffer of at least @c n characters from the pool */
+		char * pool_acquire( size_t n ) throw() {
+
+			size_t k = pool_class( n );
+			char * buffer = 0;
+
+			pthread_mutex_lock( &pool_mutex );
+			if ( pooled[k] > 0 ) {
+				buffer = pool[k][--pooled[k]];
+			}
+			pthread_mutex_unlock( &pool_mutex );
+
+			if ( buffer == 0 ) {
+				buffer = new char[( (size_t) 1 ) << k];
+			}
+
+			return buffer;
+
+		}
+
+
+		/** give back a buffer acquired for @c n characters to the pool */
+		void pool_release( char * buffer, size_t n ) throw() {
+
+			size_t k = pool_class( n );
+
+			pthread_mutex_lock( &pool_mutex );
+			if ( pooled[k] < LOGSTREAMBUF_POOL_SIZE ) {
+				pool[k][pooled[k]++] = buffer;
+				buffer = 0;
+			}
+			pthread_mutex_unlock( &pool_mutex );
+
+			// pool is full, deallocate
+			delete [] buffer;
+
+		}
+
+
+		/** cached process id */
+		pid_t cached_pid = 0;
+
+		/** cached thread id of the calling thread */
+		__thread pid_t cached_tid = 0;
+
+		/** once control to setup the process / thread id caches */
+		pthread_once_t ids_once = PTHREAD_ONCE_INIT;
+
+
+		/** refresh the cached process / thread ids ( in a forked child ) */
+		void ids_refresh() {
+
+			__atomic_store_n( &cached_pid, getpid(), __ATOMIC_RELAXED );
+			cached_tid = 0;
+
+		}
+
+
+		/** setup the process / thread id caches */
+		void ids_init() {
+
+			ids_refresh();
+			pthread_atfork( 0, 0, ids_refresh );
+
+		}
+
+
+		/** get the thread id of the calling thread */
+		pid_t thread_id() throw() {
+
+			if ( cached_tid == 0 ) {
+				cached_tid = syscall( SYS_gettid );
+			}
+
+			return cached_tid;
+
+		}
+
+	} /* end of anonymous namespace */
+
+
 	logstreambuf::logstreambuf() throw() :
-			_logfd( STDOUT_FILENO ), _continue( false ),
-			_priority( priority::debug ), _mask( 1 ) {
+			_sink( 0 ), _owned( true ), _continue( false ),
+			_priority( priority::debug ), _mask( 1 ),
+			_nslots( 0 ), _sequence( 0 ),
+			_base( 0 ), _size( 0 ), _limit( LOGSTREAMBUF_LIMIT ),
+			_batch_time( 0 ),
+			_format( text ), _closing( false ) {
+
+		// standard output log sink
+		_sink = new logfdsink( STDOUT_FILENO );
+
+		// default header layout
+		compile( LOGSTREAMBUF_PATTERN );
 
 		// initialise buffer space
-		init_buf();
+		init_buf( LOGSTREAMBUF_SIZE );
+		pthread_mutex_init( &_batch_mutex, 0 );
 
 	}
 
 
 	logstreambuf::logstreambuf( int output_fd ) throw( logexception ) :
-			_logfd( output_fd ), _continue( false ),
-			_priority( priority::debug ), _mask( 1 ) {
+			_sink( 0 ), _owned( true ), _continue( false ),
+			_priority( priority::debug ), _mask( 1 ),
+			_nslots( 0 ), _sequence( 0 ),
+			_base( 0 ), _size( 0 ), _limit( LOGSTREAMBUF_LIMIT ),
+			_batch_time( 0 ),
+			_format( text ), _closing( false ) {
+
+		// file descriptor log sink, this will throw on invalid descriptors
+		_sink = new logfdsink( output_fd );
+
+		// default header layout
+		compile( LOGSTREAMBUF_PATTERN );
+
+		// initialise buffer space
+		init_buf( LOGSTREAMBUF_SIZE );
+		pthread_mutex_init( &_batch_mutex, 0 );
+
+	}
+
+
+	logstreambuf::logstreambuf( logrotator * rotator ) throw( logexception ) :
+			_sink( 0 ), _owned( true ), _continue( false ),
+			_priority( priority::debug ), _mask( 1 ),
+			_nslots( 0 ), _sequence( 0 ),
+			_base( 0 ), _size( 0 ), _limit( LOGSTREAMBUF_LIMIT ),
+			_batch_time( 0 ),
+			_format( text ), _closing( false ) {
+
+		// rotated log file sink, this will throw on invalid rotators
+		_sink = new logfdsink( rotator );
+
+		// default header layout
+		compile( LOGSTREAMBUF_PATTERN );
+
+		// initialise buffer space
+		init_buf( LOGSTREAMBUF_SIZE );
+		pthread_mutex_init( &_batch_mutex, 0 );
+
+	}
+
+
+	logstreambuf::logstreambuf( logsink * sink ) throw( logexception ) :
+			_sink( sink ), _owned( false ), _continue( false ),
+			_priority( priority::debug ), _mask( 1 ),
+			_nslots( 0 ), _sequence( 0 ),
+			_base( 0 ), _size( 0 ), _limit( LOGSTREAMBUF_LIMIT ),
+			_batch_time( 0 ),
+			_format( text ), _closing( false ) {
 
 		// sanity check
-		if ( _logfd < 0 ) {
-			throw logexception( "Invalid file descriptor" );
+		if ( _sink == 0 ) {
+			throw logexception( "Invalid log sink" );
 		}
 
+		// default header layout
+		compile( LOGSTREAMBUF_PATTERN );
+
 		// initialise buffer space
-		init_buf();
+		init_buf( LOGSTREAMBUF_SIZE );
+		pthread_mutex_init( &_batch_mutex, 0 );
 
 	}
 
 
 	logstreambuf::~logstreambuf() throw() {
 
-		// sync
+		// stop the timer thread from writing out the batch
+		if ( _policy.interval > 0 ) {
+			logflusher::detach( this );
+		}
+
+		// sync and write out any batched log records
 		sync();
+		drain();
+		pthread_mutex_destroy( &_batch_mutex );
 
 		// cleanup output buffer
-		delete [] pbase();
+		shrink();
+		delete [] _base;
+
+		// cleanup log sink
+		if ( _owned ) {
+			delete _sink;
+		}
 
 	}
 
 
-	void logstreambuf::init_buf() throw() {
+	void logstreambuf::init_buf( size_t size ) throw() {
 
 		// allocate output buffer space
-		char * pbuf = new char[LOGSTREAMBUF_SIZE];
+		_base = new char[size];
+		_size = size;
+
+		// setup output buffer
+		setp( _base, _base + ( _size - 1 ) );
+
+	}
+
+
+	bool logstreambuf::grow() throw() {
+
+		// current buffer size ( including the overflow char )
+		size_t size = ( epptr() - pbase() ) + 1;
+
+		// sanity check - can we grow any further?
+		if ( size >= _limit ) {
+			return false;
+		}
+
+		size_t n = size * 2;
+		if ( n > _limit ) {
+			n = _limit;
+		}
+
+		// copy the buffered content to a bigger buffer
+		int used = pptr() - pbase();
+		char * pbuf = pool_acquire( n );
+		memcpy( pbuf, pbase(), used );
+
+		// give back any previously grown buffer
+		if ( pbase() != _base ) {
+			pool_release( pbase(), size );
+		}
 
 		// setup output buffer
-		setp( pbuf, pbuf + ( LOGSTREAMBUF_SIZE - 1 ) );
+		setp( pbuf, pbuf + ( n - 1 ) );
+		pbump( used );
+
+		return true;
 
 	}
 
 
-	const std::string logstreambuf::lstamp() const throw() {
+	void logstreambuf::shrink() throw() {
 
-		timeval tv;
-		tm * ti;
+		// sanity check - is the buffer grown?
+		if ( pbase() == _base ) {
+			return;
+		}
+
+		int used = pptr() - pbase();
+
+		// check - more than the base buffer can hold? ( e.g. the
+		// destination failed ) keep the grown buffer so nothing is lost
+		if ( used >= (int) _size ) {
+			return;
+		}
 
-		// current timestamp
-		gettimeofday( &tv, 0 );
-		ti = localtime( &tv.tv_sec );
+		memcpy( _base, pbase(), used );
+		pool_release( pbase(), ( epptr() - pbase() ) + 1 );
 
-		// format
-		char buffer[23];
-		int n = strftime( buffer, 16, "%b %e %T", ti );
+		// setup output buffer
+		setp( _base, _base + ( _size - 1 ) );
+		pbump( used );
 
-		// append milliseconds
-		sprintf( ( buffer + n ), ".%06d", (int) tv.tv_usec );
+	}
 
-		return buffer;
 
+	size_t logstreambuf::lstamp( char * buffer ) const throw() {
+		return _stamp.now( buffer );
 	}
 
 
@@ -103,7 +333,7 @@ namespace logstreamxx {
 		if ( flush_size > 0 ) {
 
 			// check - logging enabled for the current priority?
-			if ( ( ( 1 << _priority ) & ( _mask ) ) == 0 ) {
+			if (! enabled( _priority ) ) {
 
 				// not enabled, update buffer pointers
 				pbump( -flush_size );
@@ -112,21 +342,43 @@ namespace logstreamxx {
 
 			}
 
-			// write prefix
-			if ( wlprefix() ) {
+			// hold back an incomplete UTF-8 sequence of a structured log
+			// record until the rest of it is buffered
+			int held = 0;
+			if ( ( _format != text ) && (! _closing ) ) {
 
-				//  write buffer content
-				if ( write( _logfd, pbase(), flush_size ) == flush_size ) {
+				held = logencoder::incomplete( pbase(), flush_size );
+				if ( held >= flush_size ) {
+					held = 0;
+				}
+
+			}
 
-					// update buffer pointers
-					pbump( -flush_size );
+			// hold back a trailing new line of a log record with fields
+			// so they can go in before it when the log record is closed
+			if ( ( held == 0 ) && (! _closing ) && ( ( _format != text ) || (! _fields.empty() ) )
+					&& ( pbase()[flush_size - 1] == '\n' ) ) {
 
-					return flush_size;
+				held = 1;
 
+				// check - nothing else to write out yet?
+				if ( held == flush_size ) {
+					return flush_size;
 				}
 
 			}
 
+			// write prefix and buffer content
+			if ( wlprefix( pbase(), flush_size - held ) ) {
+
+				// update buffer pointers
+				memmove( pbase(), pbase() + ( flush_size - held ), held );
+				pbump( -( flush_size - held ) );
+
+				return flush_size;
+
+			}
+
 		}
 
 		return eof;
@@ -134,24 +386,168 @@ namespace logstreamxx {
 	}
 
 
-	bool logstreambuf::wlprefix() throw() {
+	bool logstreambuf::wlprefix( const char * data, size_t n ) throw() {
+
+		// check - structured log record?
+		if ( _format != text ) {
+			return wstructured( data, n );
+		}
 
-		// check - do we need to write the prefix
+		iovec iov[( LOGSTREAMBUF_SLOTS * 2 ) + 4];
+		int iovcnt = 0;
+		char values[LOGSTREAMBUF_SLOTS][logstamp::size + 2];
+
+		// check - do we need to write the header
 		if (! _continue ) {
 
-			// populate prefix
-			std::stringstream ss;
-			ss  << lstamp() << " [" << priority::text( _priority ) << "] ";
+			_sequence++;
+
+			// precompiled static header text with the dynamic parts
+			// formatted in between
+			const std::string &header = _header[_priority];
+			size_t offset = 0;
+
+			for ( size_t i = 0; i < _nslots; i++ ) {
+
+				size_t at = _offsets[_priority][i];
+				if ( at > offset ) {
+
+					iov[iovcnt].iov_base = (void *) ( header.data() + offset );
+					iov[iovcnt].iov_len  = at - offset;
+					iovcnt++;
+
+					offset = at;
+
+				}
+
+				iov[iovcnt].iov_base = values[i];
+				iov[iovcnt].iov_len  = lslot( _slots[i], values[i] );
+				iovcnt++;
 
-			if ( _prefix.length() > 0 ) {
-				ss << _prefix << " ";
 			}
 
-			// write prefix
-			if ( write( _logfd, ss.str().c_str(), ss.str().length() ) != ss.str().length() ) {
-				return false;
+			if ( header.length() > offset ) {
+
+				iov[iovcnt].iov_base = (void *) ( header.data() + offset );
+				iov[iovcnt].iov_len  = header.length() - offset;
+				iovcnt++;
+
+			}
+
+		}
+
+		// check - closing a log record with fields?
+		bool trailer = _closing && (! _fields.empty() );
+
+		if ( trailer && ( n > 0 ) && ( data[n - 1] == '\n' ) ) {
+			n--;
+		}
+
+		// log data
+		iov[iovcnt].iov_base = (void *) data;
+		iov[iovcnt].iov_len  = n;
+		iovcnt++;
+
+		// fields ( " key=value" ) after the log data
+		if ( trailer ) {
+
+			iov[iovcnt].iov_base = (void *) _fields.data();
+			iov[iovcnt].iov_len  = _fields.length();
+			iovcnt++;
+
+			iov[iovcnt].iov_base = (void *) "\n";
+			iov[iovcnt].iov_len  = 1;
+			iovcnt++;
+
+		}
+
+		// write prefix and log data
+		if (! wdata( iov, iovcnt ) ) {
+			return false;
+		}
+
+		// update continuation flag
+		_continue = true;
+
+		return true;
+
+	}
+
+
+	bool logstreambuf::wstructured( const char * data, size_t n ) throw() {
+
+		_scratch.clear();
+
+		// check - do we need to write the leading fields
+		if (! _continue ) {
+
+			char stamp[logstamp::size];
+			size_t sn = lstamp( stamp );
+
+			if ( _format == json ) {
+
+				// {"time":"...","level":"...","prefix":"...","msg":"
+				_scratch.append( "{\"time\":\"", 9 );
+				_scratch.append( stamp, sn );
+				_scratch.append( "\",\"level\":\"", 11 );
+				_scratch.append( priority::name( _priority ) );
+				_scratch += '"';
+
+				if ( _prefix.length() > 0 ) {
+					_scratch.append( ",\"prefix\":\"", 11 );
+					logencoder::escape( _scratch, _prefix.data(), _prefix.length() );
+					_scratch += '"';
+				}
+
+				_scratch.append( ",\"msg\":\"", 8 );
+
+			} else {
+
+				// time="..." level=... prefix=... msg="
+				_scratch.append( "time=\"", 6 );
+				_scratch.append( stamp, sn );
+				_scratch.append( "\" level=", 8 );
+				_scratch.append( priority::name( _priority ) );
+
+				if ( _prefix.length() > 0 ) {
+					_scratch.append( " prefix=", 8 );
+					lvalue( _scratch, _prefix.data(), _prefix.length() );
+				}
+
+				_scratch.append( " msg=\"", 6 );
+
+			}
+
+		}
+
+		// log message, without the trailing new line of the record
+		if ( _closing && ( n > 0 ) && ( data[n - 1] == '\n' ) ) {
+			n--;
+		}
+
+		logencoder::escape( _scratch, data, n );
+
+		// check - closing the log record?
+		if ( _closing ) {
+
+			_scratch += '"';
+			_scratch += _fields;
+
+			if ( _format == json ) {
+				_scratch += '}';
 			}
 
+			_scratch += '\n';
+
+		}
+
+		iovec iov;
+		iov.iov_base = (void *) _scratch.data();
+		iov.iov_len  = _scratch.length();
+
+		// write the log record ( or a part of it )
+		if (! wdata( &iov, 1 ) ) {
+			return false;
 		}
 
 		// update continuation flag
@@ -162,8 +558,232 @@ namespace logstreamxx {
 	}
 
 
+	void logstreambuf::lvalue( std::string &out, const char * data, size_t n ) throw() {
+
+		// check - logfmt value needs quoting?
+		if ( logencoder::quote( data, n ) ) {
+			out += '"';
+			logencoder::escape( out, data, n );
+			out += '"';
+		} else {
+			out.append( data, n );
+		}
+
+	}
+
+
+	void logstreambuf::encode( std::string &out, const format_t &format, const logfield &field ) throw() {
+
+		// key
+		if ( format == json ) {
+			out.append( ",\"", 2 );
+			logencoder::escape( out, field.key, strlen( field.key ) );
+			out.append( "\":", 2 );
+		} else {
+			out += ' ';
+			out += field.key;
+			out += '=';
+		}
+
+		// value
+		switch ( field.type ) {
+
+			case logfield::t_signed:
+				logencoder::integer( out, field.value.i );
+				break;
+
+			case logfield::t_unsigned:
+				logencoder::integer( out, field.value.u );
+				break;
+
+			case logfield::t_double:
+				logencoder::real( out, field.value.d );
+				break;
+
+			case logfield::t_bool:
+				if ( field.value.b ) {
+					out.append( "true", 4 );
+				} else {
+					out.append( "false", 5 );
+				}
+				break;
+
+			default:
+				if ( format == json ) {
+					out += '"';
+					logencoder::escape( out, field.str, field.len );
+					out += '"';
+				} else {
+					lvalue( out, field.str, field.len );
+				}
+				break;
+
+		}
+
+	}
+
+
+	void logstreambuf::lfield( const logfield &field ) throw() {
+
+		// check - logging enabled for the current priority?
+		if (! enabled( _priority ) ) {
+			return;
+		}
+
+		encode( _fields, _format, field );
+
+	}
+
+
+	logstreambuf::format_t logstreambuf::lformat( const format_t &format ) throw() {
+
+		// backup the current format
+		format_t prev_format = _format;
+
+		// sync existing buffer content
+		sync();
+
+		// update
+		_format = format;
+		_fields.clear();
+
+		return prev_format;
+
+	}
+
+
+	bool logstreambuf::wdata( iovec * iov, int iovcnt ) throw() {
+
+		// check - log priority enabled for the log sink?
+		if (! _sink->enabled( _priority ) ) {
+			return true;
+		}
+
+		// check - batching log records?
+		if ( ( _policy.bytes > 0 ) || ( _policy.interval > 0 ) ) {
+			return wbatch( iov, iovcnt );
+		}
+
+		return _sink->write( _priority, iov, iovcnt );
+
+	}
+
+
+	bool logstreambuf::wbatch( iovec * iov, int iovcnt ) throw() {
+
+		bool ret = true;
+
+		pthread_mutex_lock( &_batch_mutex );
+
+		// check - flush immediately?
+		if ( _priority <= _policy.threshold ) {
+
+			// write out the batch first to preserve the order
+			ret = wflush();
+			ret = _sink->write( _priority, iov, iovcnt ) && ret;
+
+			pthread_mutex_unlock( &_batch_mutex );
+			return ret;
+
+		}
+
+		if ( _batch.empty() ) {
+			_batch_time = ( _policy.interval > 0 ) ? logflusher::now() : 0;
+		}
+
+		for ( int i = 0; i < iovcnt; i++ ) {
+			_batch.append( (const char *) iov[i].iov_base, iov[i].iov_len );
+		}
+
+		// extend the last run or start a new one if the priority changed
+		if ( ( _batch_runs.empty() ) || ( _batch_runs.back().first != _priority ) ) {
+			_batch_runs.push_back( std::make_pair( _priority, _batch.length() ) );
+		} else {
+			_batch_runs.back().second = _batch.length();
+		}
+
+		// check - batch size reached?
+		if ( ( _policy.bytes > 0 ) && ( _batch.length() >= _policy.bytes ) ) {
+			ret = wflush();
+		}
+
+		pthread_mutex_unlock( &_batch_mutex );
+
+		return ret;
+
+	}
+
+
+	bool logstreambuf::wflush() throw() {
+
+		// sanity check - is there anything to write out?
+		if ( _batch.empty() ) {
+			return true;
+		}
+
+		bool ret = true;
+		size_t start = 0;
+
+		// a write for each run, keeping the log record priorities
+		for ( size_t i = 0; i < _batch_runs.size(); i++ ) {
+
+			iovec iov;
+			iov.iov_base = (void *) ( _batch.data() + start );
+			iov.iov_len  = _batch_runs[i].second - start;
+
+			ret   = _sink->write( _batch_runs[i].first, &iov, 1 ) && ret;
+			start = _batch_runs[i].second;
+
+		}
+
+		_batch.clear();
+		_batch_runs.clear();
+
+		return ret;
+
+	}
+
+
+	long long logstreambuf::tflush( void * arg, long long now ) throw() {
+
+		// log stream buffer instance
+		logstreambuf * sb = (logstreambuf *) arg;
+
+		pthread_mutex_lock( &sb->_batch_mutex );
+
+		long long next = now + sb->_policy.interval;
+
+		if (! sb->_batch.empty() ) {
+
+			// check - batch due?
+			if ( now >= ( sb->_batch_time + sb->_policy.interval ) ) {
+				sb->wflush();
+			} else {
+				next = sb->_batch_time + sb->_policy.interval;
+			}
+
+		}
+
+		pthread_mutex_unlock( &sb->_batch_mutex );
+
+		return next;
+
+	}
+
+
 	int logstreambuf::overflow( int c ) throw() {
 
+		// check - can we grow the buffer to keep the log record together?
+		if ( ( c != eof ) && grow() ) {
+
+			// insert the overflowed char into the buffer
+			*pptr() = c;
+			pbump( 1 );
+
+			return c;
+
+		}
+
 		if ( c != eof ) {
 
 			// insert the overflowed char into the buffer
@@ -184,13 +804,32 @@ namespace logstreamxx {
 
 	int logstreambuf::sync() throw() {
 
-		// flush buffer
-		if ( flush() == eof ) {
+		// closing the log record
+		_closing = true;
+
+		bool ret = true;
+
+		// check - log record written out in parts to close?
+		if ( _continue && ( pptr() == pbase() ) && enabled( _priority ) &&
+				( ( _format != text ) || (! _fields.empty() ) ) ) {
+			ret = wlprefix( pbase(), 0 );
+		} else {
+			// flush buffer
+			ret = ( flush() != eof );
+		}
+
+		_closing = false;
+
+		if (! ret ) {
 			return eof;
 		}
 
-		// update continuation flag
+		// update continuation flag and clear the fields
 		_continue = false;
+		_fields.clear();
+
+		// revert to the base buffer
+		shrink();
 
 		return 0;
 
@@ -202,11 +841,27 @@ namespace logstreamxx {
 		// sanity check
 		if ( ( s != 0 ) && ( n > 1 ) ) {
 
+			// check - does the buffered content fit?
+			int used = pptr() - pbase();
+			if ( used > ( n - 1 ) ) {
+				return 0;
+			}
+
+			// carry over the buffered content
+			memcpy( s, pbase(), used );
+
 			// cleanup existing output buffer
-			delete [] pbase();
+			if ( pbase() != _base ) {
+				pool_release( pbase(), ( epptr() - pbase() ) + 1 );
+			}
+
+			delete [] _base;
 
 			// setup new output buffer
-			setp( s, s + ( n - 1 ) );
+			_base = s;
+			_size = n;
+			setp( _base, _base + ( _size - 1 ) );
+			pbump( used );
 
 		}
 
@@ -249,6 +904,75 @@ namespace logstreamxx {
 	}
 
 
+	bool logstreambuf::lbuffer( size_t size, size_t limit ) throw() {
+
+		// sanity check
+		if ( size < 2 ) {
+			return false;
+		}
+
+		// sync existing buffer content, nothing is dropped if it fails
+		if ( ( sync() != 0 ) && ( pptr() != pbase() ) ) {
+			return false;
+		}
+
+		// setup new output buffer
+		char * buffer = new char[size];
+		if ( setbuf( buffer, size ) == 0 ) {
+			delete [] buffer;
+			return false;
+		}
+
+		// update
+		_limit = limit;
+
+		return true;
+
+	}
+
+
+	logstreambuf::flush_policy_t logstreambuf::lflush( const flush_policy_t &policy ) throw() {
+
+		// backup the current policy
+		flush_policy_t prev_policy = _policy;
+
+		// stop the timer thread from writing out the batch
+		if ( _policy.interval > 0 ) {
+			logflusher::detach( this );
+		}
+
+		// sync existing buffer content and write out the batch
+		sync();
+		drain();
+
+		// update
+		_policy = policy;
+
+		if ( _policy.interval > 0 ) {
+			logflusher::attach( &logstreambuf::tflush, this );
+		}
+
+		return prev_policy;
+
+	}
+
+
+	logsink * logstreambuf::lsink() const throw() {
+		return _sink;
+	}
+
+
+	bool logstreambuf::drain() throw() {
+
+		pthread_mutex_lock( &_batch_mutex );
+		bool ret = wflush();
+		pthread_mutex_unlock( &_batch_mutex );
+
+		return ret;
+
+	}
+
+
 	std::string logstreambuf::lprefix( const std::string &prefix ) throw() {
 
 		// backup the current prefix
@@ -257,9 +981,172 @@ namespace logstreamxx {
 		// update
 		_prefix = prefix;
 
+		// the prefix is a part of the static header text
+		compile( _pattern );
+
 		return prev_prefix;
 
 	}
 
+
+	bool logstreambuf::lpattern( const std::string &pattern ) throw() {
+		return compile( pattern );
+	}
+
+
+	bool logstreambuf::vpattern( const std::string &pattern ) throw() {
+
+		layout_t layout;
+		return compile( pattern, "", layout );
+
+	}
+
+
+	bool logstreambuf::compile( const std::string &pattern, const std::string &prefix, layout_t &layout ) throw() {
+
+		layout.nslots = 0;
+
+		for ( size_t i = 0; i < pattern.length(); i++ ) {
+
+			char c = pattern[i];
+
+			// check - literal text?
+			if ( c != '%' ) {
+
+				for ( int p = priority::emerg; p <= priority::debug; p++ ) {
+					layout.header[p] += c;
+				}
+
+				continue;
+
+			}
+
+			// sanity check - trailing '%'
+			if ( ++i == pattern.length() ) {
+				return false;
+			}
+
+			c = pattern[i];
+
+			switch ( c ) {
+
+				case 't':
+				case 'P':
+				case 'T':
+				case 'n':
+
+					// sanity check - too many dynamic parts
+					if ( layout.nslots == LOGSTREAMBUF_SLOTS ) {
+						return false;
+					}
+
+					for ( int p = priority::emerg; p <= priority::debug; p++ ) {
+						layout.offsets[p][layout.nslots] = layout.header[p].length();
+					}
+
+					layout.slots[layout.nslots++] = c;
+					break;
+
+				case 'p':
+					for ( int p = priority::emerg; p <= priority::debug; p++ ) {
+						layout.header[p].append( priority::text( (priority::log_priority_t) p ), 4 );
+					}
+					break;
+
+				case 'l':
+					for ( int p = priority::emerg; p <= priority::debug; p++ ) {
+						layout.header[p].append( priority::name( (priority::log_priority_t) p ) );
+					}
+					break;
+
+				case 'x':
+					if ( prefix.length() > 0 ) {
+						for ( int p = priority::emerg; p <= priority::debug; p++ ) {
+							layout.header[p].append( prefix );
+							layout.header[p] += ' ';
+						}
+					}
+					break;
+
+				case '%':
+					for ( int p = priority::emerg; p <= priority::debug; p++ ) {
+						layout.header[p] += '%';
+					}
+					break;
+
+				default:
+					// unknown directive
+					return false;
+
+			}
+
+			// setup the process / thread id caches
+			if ( ( c == 'P' ) || ( c == 'T' ) ) {
+				pthread_once( &ids_once, ids_init );
+			}
+
+		}
+
+		return true;
+
+	}
+
+
+	bool logstreambuf::compile( const std::string &pattern ) throw() {
+
+		layout_t layout;
+
+		// check - valid pattern?
+		if (! compile( pattern, _prefix, layout ) ) {
+			return false;
+		}
+
+		// update
+		for ( int p = priority::emerg; p <= priority::debug; p++ ) {
+			_header[p].swap( layout.header[p] );
+			memcpy( _offsets[p], layout.offsets[p], layout.nslots * sizeof( size_t ) );
+		}
+
+		memcpy( _slots, layout.slots, layout.nslots );
+		_nslots  = layout.nslots;
+		_pattern = pattern;
+
+		return true;
+
+	}
+
+
+	size_t logstreambuf::lslot( char type, char * buffer ) const throw() {
+
+		unsigned long long v;
+
+		switch ( type ) {
+
+			case 't':
+				return lstamp( buffer );
+
+			case 'P':
+				v = __atomic_load_n( &cached_pid, __ATOMIC_RELAXED );
+				break;
+
+			case 'T':
+				v = thread_id();
+				break;
+
+			default:
+				v = _sequence;
+				break;
+
+		}
+
+		// digits are written backwards from the end of the buffer
+		char * end   = buffer + logstamp::size + 2;
+		char * start = lognumput::utoa( end, v );
+		memmove( buffer, start, end - start );
+
+		return end - start;
+
+	}
+
 } /* end of namespace logstreamxx */
 
@@ -22,15 +22,42 @@
 
 #include <logstreamxx/priority.h>
 #include <logstreamxx/logexception.h>
+#include <logstreamxx/logsink.h>
+#include <logstreamxx/logfdsink.h>
+#include <logstreamxx/logwriter.h>
+#include <logstreamxx/logmmap.h>
+#include <logstreamxx/logstamp.h>
+#include <logstreamxx/logfield.h>
 
 #include <streambuf>
+#include <climits>
 #include <cstdio>
 #include <string>
+#include <utility>
+#include <vector>
+#include <pthread.h>
+#include <sys/uio.h>
 
 #ifndef LOGSTREAMBUF_SIZE
 #define LOGSTREAMBUF_SIZE 1024
 #endif
 
+#ifndef LOGSTREAMBUF_LIMIT
+#define LOGSTREAMBUF_LIMIT PIPE_BUF
+#endif
+
+#ifndef LOGSTREAMBUF_POOL_SIZE
+#define LOGSTREAMBUF_POOL_SIZE 8
+#endif
+
+#ifndef LOGSTREAMBUF_PATTERN
+#define LOGSTREAMBUF_PATTERN "%t [%p] %x"
+#endif
+
+#ifndef LOGSTREAMBUF_SLOTS
+#define LOGSTREAMBUF_SLOTS 8
+#endif
+
 
 namespace logstreamxx {
 
@@ -38,7 +65,8 @@ namespace logstreamxx {
 	*   @brief Log stream buffer class
 	*
 	*   Stream buffer class with only an output sequence and the output
-	*   sequence will be associated with a file destination.
+	*   sequence will be associated with a log sink ( logsink ), which
+	*   defaults to a file descriptor destination.
 	*
 	*/
 	class logstreambuf : public std::streambuf {
@@ -49,6 +77,53 @@ namespace logstreamxx {
 			eof = EOF       /*!< end of file */
 		};
 
+		/**
+		*   @brief log record format type
+		*/
+		enum format_t {
+			text    = 0,    //!< free text ( "%b %e %T.usec [PRIO] prefix message key=value" )
+			json    = 1,    //!< JSON lines ( {"time":...,"level":...,"prefix":...,"msg":...,"key":value} )
+			logfmt  = 2     //!< logfmt ( time="..." level=... prefix=... msg="..." key=value )
+		};
+
+		/**
+		*   @brief flush policy type
+		*
+		*   Completed log records ( e.g. on @c std::endl ) are written out
+		*   to the log sink immediately by default. With a flush policy
+		*   they are batched in memory and written out together once the
+		*   batch reaches @c bytes characters or @c interval milliseconds
+		*   after the first batched log record, whichever comes first.
+		*   Log records with the @c threshold priority or higher are
+		*   always written out immediately, after the batched records.
+		*
+		*   A policy with neither @c bytes nor @c interval set is the
+		*   immediate ( default ) policy.
+		*
+		*/
+		struct flush_policy_t {
+
+			/**
+			*   @brief constructor
+			*   @param bytes batch size to flush at ( 0 to disable )
+			*   @param interval flush interval in milliseconds ( 0 to disable )
+			*   @param threshold log priority to flush immediately at
+			*/
+			explicit flush_policy_t( size_t bytes = 0, unsigned int interval = 0,
+					const priority::log_priority_t &threshold = priority::err ) throw() :
+					bytes( bytes ), interval( interval ), threshold( threshold ) { }
+
+			/** batch size to flush at ( 0 to disable ) */
+			size_t bytes;
+
+			/** flush interval in milliseconds ( 0 to disable ) */
+			unsigned int interval;
+
+			/** log priority to flush immediately at ( or higher ) */
+			priority::log_priority_t threshold;
+
+		};
+
 		/**
 		*   @brief constructor
 		*
@@ -68,6 +143,35 @@ namespace logstreamxx {
 		*/
 		logstreambuf( int output_fd ) throw( logexception );
 
+		/**
+		*   @brief overloaded constructor
+		*   @param rotator log file rotator
+		*
+		*   Initialise a log stream buffer with the log file owned by
+		*   @c rotator as the log output destination. The log file is
+		*   rotated in between the log records.
+		*
+		*   @note The log rotator is not owned by the log stream buffer
+		*         and must outlive it.
+		*
+		*/
+		logstreambuf( logrotator * rotator ) throw( logexception );
+
+		/**
+		*   @brief overloaded constructor
+		*   @param sink log sink
+		*
+		*   Initialise a log stream buffer which hands over completed log
+		*   records to @c sink. e.g. a logwriter to write them out on a
+		*   background thread, a logmmap to copy them into a memory-mapped
+		*   log file or a logfanout to write them to multiple destinations.
+		*
+		*   @note The log sink is not owned by the log stream buffer and
+		*         must outlive it.
+		*
+		*/
+		logstreambuf( logsink * sink ) throw( logexception );
+
 		/**
 		*   @brief destructor
 		*
@@ -106,6 +210,18 @@ namespace logstreamxx {
 		*/
 		int setlogmask( int mask ) throw();
 
+		/**
+		*   @brief check whether logging is enabled for a priority
+		*   @param p log priority
+		*   @return boolean @c true if log records with priority @c p
+		*           will be written out or @c false otherwise
+		*
+		*   This is a cheap check against the log-mask which can be used
+		*   to skip formatting log records that would be discarded.
+		*
+		*/
+		bool enabled( const priority::log_priority_t &p ) const throw();
+
 		/**
 		*   @brief set an additional prefix for the log lines
 		*   @param prefix log prefix
@@ -118,6 +234,148 @@ namespace logstreamxx {
 		*/
 		std::string lprefix( const std::string &prefix ) throw();
 
+		/**
+		*   @brief change the log record header layout
+		*   @param pattern header layout pattern
+		*   @return boolean @c true on success or @c false if @c pattern
+		*           is invalid, in which case the layout is not changed
+		*
+		*   Set the layout of the header written out before the log
+		*   message of the free text log records. The pattern is copied
+		*   as is apart from the following directives.
+		*
+		*   @li @c %t log timestamp ( "%b %e %T.usec" )
+		*   @li @c %p log priority ( e.g. @c INFO )
+		*   @li @c %l log priority name ( e.g. @c info )
+		*   @li @c %x log prefix followed by a space, if set
+		*   @li @c %P process id
+		*   @li @c %T thread id
+		*   @li @c %n log record sequence number of this buffer
+		*   @li @c %% a literal @c %
+		*
+		*   The pattern is compiled into a header template for each log
+		*   priority ( and recompiled when the prefix changes ) so only
+		*   the dynamic parts, at most LOGSTREAMBUF_SLOTS of them, are
+		*   formatted for each log record.
+		*
+		*   @note The pattern defaults to LOGSTREAMBUF_PATTERN
+		*         ( @c "%t [%p] %x" ) on initialisation. Structured
+		*         log records ( see lformat() ) are not affected.
+		*
+		*/
+		bool lpattern( const std::string &pattern ) throw();
+
+		/**
+		*   @brief check whether a log record header layout is valid
+		*   @param pattern header layout pattern
+		*   @return boolean @c true if @c pattern would be accepted by
+		*           lpattern() or @c false otherwise
+		*/
+		static bool vpattern( const std::string &pattern ) throw();
+
+		/**
+		*   @brief change the buffer size
+		*   @param size buffer size
+		*   @param limit maximum buffer size a single log record can
+		*                grow the buffer to
+		*
+		*   @return boolean @c true on success or @c false if @c size is
+		*           less than 2 or the existing buffer content couldn't
+		*           be written out, in which case the buffer is not changed
+		*
+		*   Replace the buffer with one of @c size characters after
+		*   syncing the existing buffer content. If @c limit is larger
+		*   than @c size then the buffer grows (doubling, up to @c limit)
+		*   instead of flushing in the middle of a log record, so log
+		*   records up to @c limit characters are written out at once.
+		*
+		*   Grown buffers are taken from and given back to a process-wide
+		*   pool, and the buffer reverts to @c size characters once the
+		*   log record is written out.
+		*
+		*   @note The buffer size defaults to LOGSTREAMBUF_SIZE and the
+		*         limit to LOGSTREAMBUF_LIMIT ( @c PIPE_BUF ) on
+		*         initialisation, so log records up to @c PIPE_BUF
+		*         characters written to a pipe or an @c O_APPEND file are
+		*         never interleaved with other writers.
+		*
+		*/
+		bool lbuffer( size_t size, size_t limit = 0 ) throw();
+
+		/**
+		*   @brief change the flush policy
+		*   @param policy flush policy
+		*   @return previous flush policy
+		*
+		*   Set the policy deciding when completed log records are
+		*   written out to the log sink, after writing out any batched
+		*   log records. Batched log records are handed over to the log
+		*   sink with a single write for each run of log records with
+		*   the same priority, so sinks filtering or routing by priority
+		*   see the priority of every log record.
+		*
+		*   Time based policies are served by a process-wide timer thread
+		*   and the batch is guarded by a mutex since it is written out
+		*   from the timer thread as well.
+		*
+		*   @note The flush policy defaults to immediate on initialisation.
+		*
+		*/
+		flush_policy_t lflush( const flush_policy_t &policy ) throw();
+
+		/**
+		*   @brief change the log record format
+		*   @param format log record format
+		*   @return previous log record format
+		*
+		*   With the structured formats ( JSON lines or logfmt ) the log
+		*   timestamp, priority and prefix become fields of their own
+		*   ( @c time, @c level and @c prefix ) and the log message is
+		*   escaped into the @c msg field, followed by any fields
+		*   attached with lfield(). The log records are encoded straight
+		*   from the buffer when they are written out.
+		*
+		*   @note The format defaults to text on initialisation.
+		*
+		*/
+		format_t lformat( const format_t &format ) throw();
+
+		/**
+		*   @brief attach a field to the current log record
+		*   @param field field
+		*
+		*   The field is encoded right away and added after the log
+		*   message when the log record is written out.
+		*
+		*   @sa logfield
+		*
+		*/
+		void lfield( const logfield &field ) throw();
+
+		/**
+		*   @brief encode a field
+		*   @param out output string to append to
+		*   @param format log record format
+		*   @param field field
+		*
+		*   Append @c field to @c out as @c ,"key":value ( JSON ) or
+		*   @c " key=value" ( text and logfmt ).
+		*
+		*/
+		static void encode( std::string &out, const format_t &format, const logfield &field ) throw();
+
+		/**
+		*   @brief get the log sink
+		*   @return log sink the log records are handed over to
+		*/
+		logsink * lsink() const throw();
+
+		/**
+		*   @brief write out the batched log records
+		*   @return boolean @c true on success or @c false otherwise
+		*/
+		bool drain() throw();
+
 
 	protected:
 
@@ -133,18 +391,24 @@ namespace logstreamxx {
 		virtual int flush() throw();
 
 		/**
-		*   @brief write the log line prefix to destination
+		*   @brief write log data along with the log line prefix
+		*   @param data log data
+		*   @param n log data size
 		*   @return boolean @c true or @c false to indicate success or
 		*           failure
 		*
-		*   Write the log line prefix to the associated destination only
-		*   if needed. i.e. continuation flag is not set.
+		*   Write @c n characters of log data pointed by @c data to the
+		*   associated destination. The log line prefix is prepended only
+		*   if needed. i.e. continuation flag is not set. The prefix and
+		*   the log data are written out with a single system call so log
+		*   records are not interleaved with other writers appending to
+		*   the same destination.
 		*
 		*   @note This will set the continuation flag after writing the
 		*   prefix.
 		*
 		*/
-		virtual bool wlprefix() throw();
+		virtual bool wlprefix( const char * data, size_t n ) throw();
 
 		/**
 		*   @brief consume the buffer
@@ -154,6 +418,9 @@ namespace logstreamxx {
 		*   Consumes the buffer content by writing out to the destination.
 		*   if @a c is not logstreambuf::eof then @a c is also consumed.
 		*
+		*   If the buffer is allowed to grow (see lbuffer()) then the
+		*   buffer is grown instead until it reaches the size limit.
+		*
 		*   @note If the buffer overflows then the written out log lines
 		*         could be out of order on a multi-process environment.
 		*
@@ -174,26 +441,32 @@ namespace logstreamxx {
 
 		/**
 		*   @brief get the log timestamp value
-		*   @return log timestamp
+		*   @param buffer output buffer of at least logstamp::size characters
+		*   @return number of characters written to @c buffer
 		*
-		*   This is a helper method to return the current log timestamp
-		*   value as a std::string object.
+		*   This is a helper method to format the current log timestamp
+		*   value into @c buffer. The output is not null terminated.
 		*
 		*/
-		const std::string lstamp() const throw();
+		size_t lstamp( char * buffer ) const throw();
 
 		/**
 		*   @brief set buffer space
 		*   @param s pointer to a allocated buffer space
 		*   @param n allocated buffer size
-		*   @return @c this
+		*   @return @c this or @c 0 if the buffered content doesn't fit
+		*           into @c s
 		*
 		*   Set the array of @c n characters pointed by @c s as the internal
 		*   character sequence to be used by the log stream buffer object.
 		*   If @c s is 0 or @n is less than 2, this method has no effect.
+		*   Any buffered content is carried over, if it doesn't fit then
+		*   @c s is not used ( nor deallocated ) and 0 is returned.
 		*
 		*   @note The buffer space pointed by @c s will be deallocated
 		*         by the destructor and any successive calls to this method.
+		*         It is also used as the base buffer size when growing the
+		*         buffer.
 		*
 		*/
 		virtual logstreambuf * setbuf( char * s, std::streamsize n ) throw();
@@ -201,8 +474,11 @@ namespace logstreamxx {
 
 	private:
 
-		/** log file descriptor */
-		int _logfd;
+		/** log sink */
+		logsink * _sink;
+
+		/** flag to indicate whether the log sink is owned */
+		bool _owned;
 
 		/** log entry/line continuation flag */
 		bool _continue;
@@ -216,11 +492,115 @@ namespace logstreamxx {
 		/** additional log prefix to add to the log lines */
 		std::string _prefix;
 
+		/** log timestamp formatter */
+		mutable logstamp _stamp;
+
+		/** log record header layout pattern */
+		std::string _pattern;
+
+		/** precompiled static header text for each log priority */
+		std::string _header[priority::debug + 1];
+
+		/** number of dynamic header parts */
+		size_t _nslots;
+
+		/** dynamic header part types ( pattern directives ) */
+		char _slots[LOGSTREAMBUF_SLOTS];
+
+		/** offsets of the dynamic header parts into the static header text */
+		size_t _offsets[priority::debug + 1][LOGSTREAMBUF_SLOTS];
+
+		/** log record sequence number */
+		unsigned long long _sequence;
+
+		/** base buffer space */
+		char * _base;
+
+		/** base buffer size */
+		size_t _size;
+
+		/** maximum size to grow the buffer to */
+		size_t _limit;
+
+		/** flush policy */
+		flush_policy_t _policy;
+
+		/** batched log records */
+		std::string _batch;
+
+		/** runs of batched log records with the same priority ( priority and end offset into the batch ) */
+		std::vector<std::pair<priority::log_priority_t, size_t> > _batch_runs;
+
+		/** time the first log record was batched ( logflusher::now() ) */
+		long long _batch_time;
+
+		/** mutex to guard the batch */
+		pthread_mutex_t _batch_mutex;
+
+		/** log record format */
+		format_t _format;
+
+		/** encoded fields of the current log record */
+		std::string _fields;
+
+		/** structured log record encoding space */
+		std::string _scratch;
+
+		/** flag to indicate the current log record is being closed */
+		bool _closing;
+
 		/** initialise buffer space */
-		void init_buf() throw();
+		void init_buf( size_t size ) throw();
+
+		/** grow the buffer to fit more of the current log record */
+		bool grow() throw();
+
+		/** give back any grown buffer and revert to the base buffer */
+		void shrink() throw();
+
+		/** compiled header layout */
+		struct layout_t {
+			std::string header[priority::debug + 1];
+			size_t offsets[priority::debug + 1][LOGSTREAMBUF_SLOTS];
+			char slots[LOGSTREAMBUF_SLOTS];
+			size_t nslots;
+		};
+
+		/** compile a header layout pattern into @c layout, without applying it */
+		static bool compile( const std::string &pattern, const std::string &prefix, layout_t &layout ) throw();
+
+		/** compile the header layout pattern into the header templates */
+		bool compile( const std::string &pattern ) throw();
+
+		/** format a dynamic header part into @c buffer, returns the length */
+		size_t lslot( char type, char * buffer ) const throw();
+
+		/** hand over @c iovcnt parts to the log sink */
+		bool wdata( iovec * iov, int iovcnt ) throw();
+
+		/** write a structured log record ( or a part of it ) */
+		bool wstructured( const char * data, size_t n ) throw();
+
+		/** append a logfmt value, quoted if needed */
+		static void lvalue( std::string &out, const char * data, size_t n ) throw();
+
+		/** batch @c iovcnt parts according to the flush policy */
+		bool wbatch( iovec * iov, int iovcnt ) throw();
+
+		/** write out the batch, must be called with the batch mutex held */
+		bool wflush() throw();
+
+		/** flush timer callback, write out the batch if due at @c now
+		    and return the next due time */
+		static long long tflush( void * arg, long long now ) throw();
 
 	};
 
+
+	inline bool logstreambuf::enabled( const priority::log_priority_t &p ) const throw() {
+		return ( ( 1 << p ) & _mask ) != 0;
+	}
+
 } /* end of namespace logstreamxx */
 
 #endif /* !LOGSTREAMXX_LOGSTREAMBUF_H */
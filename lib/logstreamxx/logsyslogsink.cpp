@@ -0,0 +1,381 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logsyslogsink.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+
+namespace logstreamxx {
+
+	namespace {
+
+		/** number of times the process was forked ( as seen by the child ) */
+		unsigned int forks = 0;
+
+		/** once control to register the fork handler */
+		pthread_once_t forks_once = PTHREAD_ONCE_INIT;
+
+
+		/** fork handler, the process id in the message headers changes */
+		void forked() {
+			__atomic_add_fetch( &forks, 1, __ATOMIC_RELAXED );
+		}
+
+
+		/** register the fork handler */
+		void forks_init() {
+			pthread_atfork( 0, 0, forked );
+		}
+
+	} /* end of anonymous namespace */
+
+
+	logsyslogsink::logsyslogsink( const char * ident, const format_t &format, int facility,
+			size_t batch, const char * path ) throw( logexception ) :
+			_fd( -1 ), _owned( true ), _path( path ), _format( format ),
+			_forks( 0 ), _batch( 0 ), _pending( 0 ), _dropped( 0 ), _sec( -1 ) {
+
+		// sanity check
+		if ( _path.length() >= sizeof( ( (sockaddr_un *) 0 )->sun_path ) ) {
+			throw logexception( "Invalid socket path" );
+		}
+
+		// connect to the syslog daemon
+		if (! sconnect() ) {
+			// throw a log exception with system message
+			throw logexception();
+		}
+
+		init( ident, facility, batch );
+
+	}
+
+
+	logsyslogsink::logsyslogsink( int fd, const char * ident, const format_t &format,
+			int facility, size_t batch ) throw( logexception ) :
+			_fd( fd ), _owned( false ), _format( format ),
+			_forks( 0 ), _batch( 0 ), _pending( 0 ), _dropped( 0 ), _sec( -1 ) {
+
+		// sanity check
+		if ( _fd < 0 ) {
+			throw logexception( "Invalid file descriptor" );
+		}
+
+		init( ident, facility, batch );
+
+	}
+
+
+	logsyslogsink::~logsyslogsink() throw() {
+
+		// send any batched messages
+		flush();
+
+		if ( _owned && ( _fd != -1 ) ) {
+			::close( _fd );
+		}
+
+		pthread_mutex_destroy( &_mutex );
+
+	}
+
+
+	void logsyslogsink::init( const char * ident, int facility, size_t batch ) throw() {
+
+		char buffer[64];
+
+		// per-priority templates ( "<PRI>" or "<PRI>1 " )
+		for ( int p = 0; p < 8; p++ ) {
+			snprintf( buffer, sizeof( buffer ), ( _format == rfc5424 ) ? "<%d>1 " : "<%d>",
+					( facility & LOG_FACMASK ) | p );
+			_templates[p] = buffer;
+		}
+
+		// identity, limited so the message header always fits ( RFC 3164
+		// TAG and RFC 5424 APP-NAME lengths )
+		_ident = ident;
+		_ident = _ident.substr( 0, ( _format == rfc5424 ) ? 48 : 32 );
+
+		// message header part following the timestamp
+		pthread_once( &forks_once, forks_init );
+		suffix();
+
+		// batch buffers
+		_batch = ( batch > 0 ) ? batch : 1;
+		_data.resize( _batch * LOGSYSLOGSINK_MSG_SIZE );
+		_lengths.resize( _batch );
+
+		pthread_mutex_init( &_mutex, 0 );
+
+	}
+
+
+	void logsyslogsink::suffix() throw() {
+
+		char buffer[16];
+		snprintf( buffer, sizeof( buffer ), "%d", (int) getpid() );
+
+		_forks = __atomic_load_n( &forks, __ATOMIC_RELAXED );
+
+		if ( _format == rfc5424 ) {
+
+			char hostname[256] = "-";
+			gethostname( hostname, sizeof( hostname ) - 1 );
+			hostname[sizeof( hostname ) - 1] = '\0';
+
+			_suffix = std::string( " " ) + hostname + " " + _ident + " " + buffer + " - - ";
+
+		} else {
+			_suffix = std::string( " " ) + _ident + "[" + buffer + "]: ";
+		}
+
+	}
+
+
+	bool logsyslogsink::sconnect() throw() {
+
+		// close any existing socket
+		if ( _fd != -1 ) {
+			::close( _fd );
+			_fd = -1;
+		}
+
+		int fd = socket( AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0 );
+
+		if ( fd == -1 ) {
+			return false;
+		}
+
+		sockaddr_un addr;
+		memset( &addr, 0, sizeof( addr ) );
+		addr.sun_family = AF_UNIX;
+		memcpy( addr.sun_path, _path.c_str(), _path.length() );
+
+		if ( connect( fd, (sockaddr *) &addr, sizeof( addr ) ) != 0 ) {
+			int e = errno;
+			::close( fd );
+			errno = e;
+			return false;
+		}
+
+		_fd = fd;
+
+		return true;
+
+	}
+
+
+	size_t logsyslogsink::stamp( char * buffer ) throw() {
+
+		// RFC 3164 timestamp ( "Mmm dd hh:mm:ss" ) is the log timestamp
+		// without the microseconds
+		if ( _format == rfc3164 ) {
+			char s[logstamp::size];
+			_stamp.now( s );
+			memcpy( buffer, s, 15 );
+			return 15;
+		}
+
+		// RFC 5424 timestamp ( "YYYY-MM-DDThh:mm:ss.uuuuuu+hh:mm" )
+		timeval tv;
+		gettimeofday( &tv, 0 );
+
+		// check - do we need to update the cached date and time?
+		if ( tv.tv_sec != _sec ) {
+
+			struct tm tm;
+			localtime_r( &tv.tv_sec, &tm );
+			strftime( _cache, sizeof( _cache ), "%Y-%m-%dT%H:%M:%S.", &tm );
+
+			int offset = (int) ( labs( tm.tm_gmtoff ) / 60 );
+			snprintf( _zone, sizeof( _zone ), "%c%02d:%02d", ( tm.tm_gmtoff < 0 ) ? '-' : '+',
+					( offset / 60 ) % 100, offset % 60 );
+
+			_sec = tv.tv_sec;
+
+		}
+
+		size_t n = 20;
+		memcpy( buffer, _cache, n );
+
+		// patch in the microseconds
+		long usec = tv.tv_usec;
+		for ( int i = 5; i >= 0; i-- ) {
+			buffer[n + i] = '0' + ( usec % 10 );
+			usec /= 10;
+		}
+
+		n += 6;
+		memcpy( buffer + n, _zone, 6 );
+
+		return n + 6;
+
+	}
+
+
+	bool logsyslogsink::write( const priority::log_priority_t &p, const iovec * iov, int iovcnt ) throw() {
+
+		pthread_mutex_lock( &_mutex );
+
+		// check - forked since the message header was prepared?
+		if ( _forks != __atomic_load_n( &forks, __ATOMIC_RELAXED ) ) {
+			suffix();
+		}
+
+		char * msg = &_data[_pending * LOGSYSLOGSINK_MSG_SIZE];
+		const size_t size = LOGSYSLOGSINK_MSG_SIZE;
+
+		// header ( template, timestamp and suffix )
+		size_t n = _templates[p].length();
+		memcpy( msg, _templates[p].data(), n );
+
+		n += stamp( msg + n );
+
+		memcpy( msg + n, _suffix.data(), _suffix.length() );
+		n += _suffix.length();
+
+		// log record ( truncated if too long )
+		for ( int i = 0; ( i < iovcnt ) && ( n < size ); i++ ) {
+
+			size_t c = iov[i].iov_len;
+			if ( c > ( size - n ) ) {
+				c = size - n;
+			}
+
+			memcpy( msg + n, iov[i].iov_base, c );
+			n += c;
+
+		}
+
+		// strip the trailing new line
+		if ( msg[n - 1] == '\n' ) {
+			n--;
+		}
+
+		_lengths[_pending++] = n;
+
+		// send if the batch is full
+		bool ret = true;
+		if ( _pending == _batch ) {
+			ret = send();
+		}
+
+		pthread_mutex_unlock( &_mutex );
+
+		return ret;
+
+	}
+
+
+	bool logsyslogsink::flush() throw() {
+
+		pthread_mutex_lock( &_mutex );
+		bool ret = send();
+		pthread_mutex_unlock( &_mutex );
+
+		return ret;
+
+	}
+
+
+	bool logsyslogsink::send() throw() {
+
+		// sanity check
+		if ( _pending == 0 ) {
+			return true;
+		}
+
+		std::vector<mmsghdr> msgs( _pending );
+		std::vector<iovec> iovs( _pending );
+
+		for ( size_t i = 0; i < _pending; i++ ) {
+
+			iovs[i].iov_base = &_data[i * LOGSYSLOGSINK_MSG_SIZE];
+			iovs[i].iov_len  = _lengths[i];
+
+			memset( &msgs[i], 0, sizeof( mmsghdr ) );
+			msgs[i].msg_hdr.msg_iov    = &iovs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+
+		}
+
+		bool ret = true;
+		bool reconnected = false;
+		size_t sent = 0;
+
+		while ( sent < _pending ) {
+
+			int n = sendmmsg( _fd, &msgs[sent], _pending - sent, MSG_NOSIGNAL );
+
+			if ( n > 0 ) {
+				sent += n;
+				continue;
+			}
+
+			// retry if interrupted
+			if ( ( n < 0 ) && ( errno == EINTR ) ) {
+				continue;
+			}
+
+			// reconnect once if the syslog daemon was restarted
+			if ( _owned && (! reconnected ) && ( n < 0 ) &&
+					( ( errno == ECONNREFUSED ) || ( errno == ENOTCONN ) ) ) {
+
+				reconnected = true;
+
+				if ( sconnect() ) {
+					continue;
+				}
+
+			}
+
+			// drop the current message and carry on with the rest
+			_dropped++;
+			sent++;
+			ret = false;
+
+		}
+
+		_pending = 0;
+
+		return ret;
+
+	}
+
+
+	size_t logsyslogsink::dropped() const throw() {
+
+		pthread_mutex_lock( &_mutex );
+		size_t dropped = _dropped;
+		pthread_mutex_unlock( &_mutex );
+
+		return dropped;
+
+	}
+
+} /* end of namespace logstreamxx */
+
@@ -0,0 +1,220 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTREAMXX_LOGSYSLOGSINK_H
+#define LOGSTREAMXX_LOGSYSLOGSINK_H
+
+#include <logstreamxx/logsink.h>
+#include <logstreamxx/logexception.h>
+#include <logstreamxx/logstamp.h>
+
+#include <ctime>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <syslog.h>
+
+#ifndef LOGSYSLOGSINK_MSG_SIZE
+#define LOGSYSLOGSINK_MSG_SIZE 2048
+#endif
+
+// room for the longest message header ( the hostname and the ident are
+// limited to 255 and 48 characters ) and some of the log record
+#if LOGSYSLOGSINK_MSG_SIZE < 512
+#error "LOGSYSLOGSINK_MSG_SIZE must be at least 512"
+#endif
+
+
+namespace logstreamxx {
+
+	/**
+	*   @brief Syslog log sink class
+	*
+	*   Writes log records as syslog messages ( RFC 3164 or RFC 5424
+	*   frames ) directly to a Unix datagram socket, @c /dev/log by
+	*   default, without going through syslog(3). The message headers
+	*   are built from per-priority templates prepared up-front, only
+	*   the timestamp is formatted per message ( and cached per second ).
+	*
+	*   Log priorities map directly to syslog severities and the PRI
+	*   value is @c facility + severity. The trailing new line of a log
+	*   record is not sent and messages longer than
+	*   LOGSYSLOGSINK_MSG_SIZE characters are truncated.
+	*
+	*   Messages can be batched and sent with a single @c sendmmsg()
+	*   system call. Batched messages are sent when the batch is full,
+	*   on flush() or on destruction.
+	*
+	*   @note RFC 3164 frames follow syslog(3) and omit the host name,
+	*         which is added by the syslog daemon for local messages.
+	*
+	*/
+	class logsyslogsink : public logsink {
+	public:
+
+		/**
+		*   @brief syslog message format type
+		*/
+		enum format_t {
+			rfc3164  = 0,       //!< BSD syslog ( "<PRI>Mmm dd hh:mm:ss ident[pid]: msg" )
+			rfc5424  = 1        //!< syslog protocol ( "<PRI>1 timestamp host ident pid - - msg" )
+		};
+
+		/**
+		*   @brief constructor
+		*   @param ident identity ( application name ) to tag messages with
+		*   @param format syslog message format
+		*   @param facility syslog facility ( e.g. @c LOG_USER, @c LOG_LOCAL0 )
+		*   @param batch number of messages to batch before sending
+		*   @param path Unix datagram socket path
+		*
+		*   Connect to the syslog daemon listening on @c path.
+		*
+		*   @note @c ident is truncated to 32 ( RFC 3164 ) or 48
+		*         ( RFC 5424 ) characters.
+		*
+		*/
+		logsyslogsink( const char * ident, const format_t &format = rfc3164, int facility = LOG_USER,
+				size_t batch = 1, const char * path = "/dev/log" ) throw( logexception );
+
+		/**
+		*   @brief overloaded constructor
+		*   @param fd connected datagram socket
+		*   @param ident identity ( application name ) to tag messages with
+		*   @param format syslog message format
+		*   @param facility syslog facility ( e.g. @c LOG_USER, @c LOG_LOCAL0 )
+		*   @param batch number of messages to batch before sending
+		*
+		*   @note The socket is not owned by the log sink.
+		*   @note @c ident is truncated to 32 ( RFC 3164 ) or 48
+		*         ( RFC 5424 ) characters.
+		*
+		*/
+		logsyslogsink( int fd, const char * ident, const format_t &format = rfc3164,
+				int facility = LOG_USER, size_t batch = 1 ) throw( logexception );
+
+		/**
+		*   @brief destructor
+		*
+		*   Send any batched messages and close the socket ( if owned ).
+		*
+		*/
+		virtual ~logsyslogsink() throw();
+
+		/**
+		*   @brief write a log record as a syslog message
+		*   @sa logsink::write()
+		*/
+		virtual bool write( const priority::log_priority_t &p, const iovec * iov, int iovcnt ) throw();
+
+		/**
+		*   @brief send any batched messages
+		*   @return boolean @c true on success or @c false if messages
+		*           were dropped
+		*/
+		bool flush() throw();
+
+		/**
+		*   @brief get the number of dropped messages
+		*   @return number of messages that couldn't be sent
+		*/
+		size_t dropped() const throw();
+
+
+	private:
+
+		/** socket */
+		int _fd;
+
+		/** flag to indicate whether the socket is owned */
+		bool _owned;
+
+		/** socket path ( if owned ) */
+		std::string _path;
+
+		/** message format */
+		format_t _format;
+
+		/** per-priority message header templates ( up to the timestamp ) */
+		std::string _templates[8];
+
+		/** message header part following the timestamp */
+		std::string _suffix;
+
+		/** identity ( truncated ) */
+		std::string _ident;
+
+		/** process fork count the message header suffix was prepared at */
+		unsigned int _forks;
+
+		/** number of messages to batch */
+		size_t _batch;
+
+		/** batched messages */
+		std::vector<char> _data;
+
+		/** batched message lengths */
+		std::vector<size_t> _lengths;
+
+		/** number of batched messages */
+		size_t _pending;
+
+		/** dropped messages count */
+		size_t _dropped;
+
+		/** RFC 3164 timestamp formatter */
+		logstamp _stamp;
+
+		/** seconds value of the cached RFC 5424 timestamp */
+		time_t _sec;
+
+		/** cached RFC 5424 date and time ( @c "%Y-%m-%dT%H:%M:%S." ) */
+		char _cache[24];
+
+		/** cached RFC 5424 time zone offset ( @c "+hh:mm" ) */
+		char _zone[16];
+
+		/** mutex to serialise writers */
+		mutable pthread_mutex_t _mutex;
+
+		/** prepare the message header templates */
+		void init( const char * ident, int facility, size_t batch ) throw();
+
+		/** prepare the message header part following the timestamp */
+		void suffix() throw();
+
+		/** connect to the syslog daemon */
+		bool sconnect() throw();
+
+		/** format the current time into @c buffer */
+		size_t stamp( char * buffer ) throw();
+
+		/** send the batched messages, must be called with the mutex held */
+		bool send() throw();
+
+		// disallow copying
+		logsyslogsink( const logsyslogsink & );
+		logsyslogsink &operator =( const logsyslogsink & );
+
+	};
+
+} /* end of namespace logstreamxx */
+
+#endif /* !LOGSTREAMXX_LOGSYSLOGSINK_H */
+
@@ -0,0 +1,239 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "loguring.h"
+
+#include <config.h>
+
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
+
+
+namespace logstreamxx {
+
+	loguring::loguring( int fd, const iovec * buffers, int count ) throw( logexception ) :
+			_fd( fd ), _ring_fd( -1 ), _buffers( 0 ),
+			_sq_ring( MAP_FAILED ), _cq_ring( MAP_FAILED ), _sq_ring_size( 0 ), _cq_ring_size( 0 ),
+			_sqes( MAP_FAILED ), _sqes_size( 0 ), _sq_tail( 0 ), _sq_mask( 0 ), _sq_array( 0 ),
+			_cq_head( 0 ), _cq_tail( 0 ), _cq_mask( 0 ), _cqes( 0 ),
+			_index( -1 ), _offset( 0 ), _remaining( 0 ) {
+
+#ifdef HAVE_IO_URING
+		// keep a copy of the buffers to register
+		_buffers = new iovec[count];
+		memcpy( _buffers, buffers, count * sizeof( iovec ) );
+
+		io_uring_params p;
+		memset( &p, 0, sizeof( p ) );
+
+		// setup
+		_ring_fd = syscall( __NR_io_uring_setup, 4, &p );
+
+		if ( _ring_fd < 0 ) {
+			// throw a log exception with system message
+			logexception e;
+			release();
+			throw e;
+		}
+
+		// sanity check - writes at the current file position are needed
+		// for pipes and files opened with O_APPEND
+		if ( (! ( p.features & IORING_FEAT_RW_CUR_POS ) ) || (! ( p.features & IORING_FEAT_SINGLE_MMAP ) ) ) {
+			release();
+			throw logexception( "io_uring features not supported" );
+		}
+
+		// map the rings ( single mapping for both )
+		_sq_ring_size = p.sq_off.array + ( p.sq_entries * sizeof( unsigned int ) );
+		_cq_ring_size = p.cq_off.cqes + ( p.cq_entries * sizeof( io_uring_cqe ) );
+
+		if ( _cq_ring_size > _sq_ring_size ) {
+			_sq_ring_size = _cq_ring_size;
+		}
+
+		_sq_ring = mmap( 0, _sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+				_ring_fd, IORING_OFF_SQ_RING );
+
+		_sqes_size = p.sq_entries * sizeof( io_uring_sqe );
+		_sqes = mmap( 0, _sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+				_ring_fd, IORING_OFF_SQES );
+
+		if ( ( _sq_ring == MAP_FAILED ) || ( _sqes == MAP_FAILED ) ) {
+			logexception e;
+			release();
+			throw e;
+		}
+
+		char * sq = (char *) _sq_ring;
+
+		_sq_tail  = (unsigned int *) ( sq + p.sq_off.tail );
+		_sq_mask  = (unsigned int *) ( sq + p.sq_off.ring_mask );
+		_sq_array = (unsigned int *) ( sq + p.sq_off.array );
+		_cq_head  = (unsigned int *) ( sq + p.cq_off.head );
+		_cq_tail  = (unsigned int *) ( sq + p.cq_off.tail );
+		_cq_mask  = (unsigned int *) ( sq + p.cq_off.ring_mask );
+		_cqes     = sq + p.cq_off.cqes;
+
+		// register fixed buffers
+		if ( syscall( __NR_io_uring_register, _ring_fd, IORING_REGISTER_BUFFERS, buffers, count ) < 0 ) {
+			logexception e;
+			release();
+			throw e;
+		}
+#else
+		throw logexception( "io_uring is not supported" );
+#endif
+
+	}
+
+
+	loguring::~loguring() throw() {
+
+		// wait for the write in flight
+		wait();
+
+		release();
+
+	}
+
+
+	void loguring::release() throw() {
+
+#ifdef HAVE_IO_URING
+		if ( _sqes != MAP_FAILED ) {
+			munmap( _sqes, _sqes_size );
+		}
+
+		if ( _sq_ring != MAP_FAILED ) {
+			munmap( _sq_ring, _sq_ring_size );
+		}
+
+		if ( _ring_fd >= 0 ) {
+			::close( _ring_fd );
+		}
+
+		delete [] _buffers;
+#endif
+
+	}
+
+
+	bool loguring::queue( int index, size_t offset, size_t n ) throw() {
+
+#ifdef HAVE_IO_URING
+		// populate the submission queue entry
+		unsigned int tail = *_sq_tail;
+		unsigned int i = tail & *_sq_mask;
+
+		io_uring_sqe * sqe = ( (io_uring_sqe *) _sqes ) + i;
+		memset( sqe, 0, sizeof( *sqe ) );
+
+		sqe->opcode    = IORING_OP_WRITE_FIXED;
+		sqe->fd        = _fd;
+		sqe->off       = (__u64) -1;
+		sqe->addr      = (__u64) (unsigned long) ( (char *) _buffers[index].iov_base + offset );
+		sqe->len       = n;
+		sqe->buf_index = index;
+
+		_sq_array[i] = i;
+		__atomic_store_n( _sq_tail, tail + 1, __ATOMIC_RELEASE );
+
+		// submit
+		int ret;
+		while ( ( ( ret = syscall( __NR_io_uring_enter, _ring_fd, 1, 0, 0, 0, 0 ) ) < 0 ) && ( errno == EINTR ) ) { }
+
+		if ( ret != 1 ) {
+			// reclaim the submission queue entry
+			__atomic_store_n( _sq_tail, tail, __ATOMIC_RELEASE );
+			return false;
+		}
+
+		_index     = index;
+		_offset    = offset;
+		_remaining = n;
+
+		return true;
+#else
+		return false;
+#endif
+
+	}
+
+
+	bool loguring::submit( int index, size_t n ) throw() {
+
+		// sanity check
+		if ( _index != -1 ) {
+			return false;
+		}
+
+		return queue( index, 0, n );
+
+	}
+
+
+	bool loguring::wait() throw() {
+
+#ifdef HAVE_IO_URING
+		while ( _index != -1 ) {
+
+			// reap the completion
+			unsigned int head = *_cq_head;
+
+			if ( head == __atomic_load_n( _cq_tail, __ATOMIC_ACQUIRE ) ) {
+				syscall( __NR_io_uring_enter, _ring_fd, 0, 1, IORING_ENTER_GETEVENTS, 0, 0 );
+				continue;
+			}
+
+			int res = ( ( (io_uring_cqe *) _cqes ) + ( head & *_cq_mask ) )->res;
+			__atomic_store_n( _cq_head, head + 1, __ATOMIC_RELEASE );
+
+			int index = _index;
+			_index = -1;
+
+			// check - retry if interrupted
+			if ( ( res == -EINTR ) || ( res == -EAGAIN ) ) {
+				res = 0;
+			} else if ( res <= 0 ) {
+				return false;
+			}
+
+			// resubmit the remainder of short writes
+			if ( (size_t) res < _remaining ) {
+				if (! queue( index, _offset + res, _remaining - res ) ) {
+					return false;
+				}
+			}
+
+		}
+#endif
+
+		return true;
+
+	}
+
+} /* end of namespace logstreamxx */
+
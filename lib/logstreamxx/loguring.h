@@ -0,0 +1,144 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTREAMXX_LOGURING_H
+#define LOGSTREAMXX_LOGURING_H
+
+#include <logstreamxx/logexception.h>
+
+#include <cstddef>
+#include <sys/uio.h>
+
+
+namespace logstreamxx {
+
+	/**
+	*   @brief io_uring write backend class
+	*
+	*   Minimal io_uring ( Linux ) interface used by the log writer to
+	*   write out record batches from fixed registered buffers. Only a
+	*   single write is in flight at a time so writes complete in order,
+	*   while the caller carries on preparing the next batch.
+	*
+	*   @note This is an internal class and is only functional if the
+	*         library is built with io_uring support.
+	*
+	*/
+	class loguring {
+	public:
+
+		/**
+		*   @brief constructor
+		*   @param fd file descriptor to write to
+		*   @param buffers buffers to register
+		*   @param count number of buffers
+		*
+		*   Setup an io_uring instance and register @c buffers as fixed
+		*   buffers. This throws a logexception if io_uring is not
+		*   available, in which case the caller should fall back to
+		*   @c write().
+		*
+		*/
+		loguring( int fd, const iovec * buffers, int count ) throw( logexception );
+
+		/**
+		*   @brief destructor
+		*
+		*   Wait for any write in flight and release the io_uring instance.
+		*
+		*/
+		virtual ~loguring() throw();
+
+		/**
+		*   @brief submit a write
+		*   @param index registered buffer index
+		*   @param n number of characters to write from the buffer
+		*   @return boolean @c true if the write was submitted or @c false
+		*           otherwise
+		*
+		*   @note The previous write must be reaped with wait() first.
+		*
+		*/
+		bool submit( int index, size_t n ) throw();
+
+		/**
+		*   @brief wait for the write in flight
+		*   @return boolean @c true if all the characters were written
+		*           out or @c false otherwise
+		*
+		*   Reap the completion of the write in flight, resubmitting the
+		*   remainder on short or interrupted writes.
+		*
+		*/
+		bool wait() throw();
+
+
+	private:
+
+		/** file descriptor to write to */
+		int _fd;
+
+		/** io_uring file descriptor */
+		int _ring_fd;
+
+		/** registered buffers */
+		iovec * _buffers;
+
+		/** submission and completion queue ring mappings */
+		void * _sq_ring;
+		void * _cq_ring;
+		size_t _sq_ring_size;
+		size_t _cq_ring_size;
+
+		/** submission queue entries mapping */
+		void * _sqes;
+		size_t _sqes_size;
+
+		/** submission queue pointers */
+		unsigned int * _sq_tail;
+		unsigned int * _sq_mask;
+		unsigned int * _sq_array;
+
+		/** completion queue pointers */
+		unsigned int * _cq_head;
+		unsigned int * _cq_tail;
+		unsigned int * _cq_mask;
+		void * _cqes;
+
+		/** write in flight ( buffer index, offset and remaining size ) */
+		int _index;
+		size_t _offset;
+		size_t _remaining;
+
+		/** queue a write of @c n characters from @c index at @c offset */
+		bool queue( int index, size_t offset, size_t n ) throw();
+
+		/** release the io_uring instance */
+		void release() throw();
+
+		// disallow copying
+		loguring( const loguring & );
+		loguring &operator =( const loguring & );
+
+	};
+
+} /* end of namespace logstreamxx */
+
+#endif /* !LOGSTREAMXX_LOGURING_H */
+
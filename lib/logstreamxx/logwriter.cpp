@@ -0,0 +1,508 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logwriter.h"
+#include "loguring.h"
+
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <sched.h>
+
+
+namespace logstreamxx {
+
+	logwriter::logwriter( int output_fd, const overflow_t &overflow, size_t capacity ) throw( logexception ) :
+			_logfd( output_fd ), _rotator( 0 ), _overflow( overflow ), _ring( capacity ), _batch( 0 ),
+			_current( 0 ), _uring( 0 ), _inflight( 0 ), _inflight_n( 0 ),
+			_written( 0 ), _dropped( 0 ), _overflows( 0 ),
+				_side( 0 ), _side_n( 0 ), _side_position( 0 ), _stop( 0 ), _sleeping( 0 ) {
+
+		// sanity check
+		if ( _logfd < 0 ) {
+			throw logexception( "Invalid file descriptor" );
+		}
+
+		// initialise and start the writer thread
+		init( capacity );
+
+	}
+
+
+	logwriter::logwriter( logrotator * rotator, const overflow_t &overflow, size_t capacity ) throw( logexception ) :
+			_logfd( -1 ), _rotator( rotator ), _overflow( overflow ), _ring( capacity ), _batch( 0 ),
+			_current( 0 ), _uring( 0 ), _inflight( 0 ), _inflight_n( 0 ),
+			_written( 0 ), _dropped( 0 ), _overflows( 0 ),
+				_side( 0 ), _side_n( 0 ), _side_position( 0 ), _stop( 0 ), _sleeping( 0 ) {
+
+		// sanity check
+		if ( _rotator == 0 ) {
+			throw logexception( "Invalid log rotator" );
+		}
+
+		_logfd = _rotator->fd();
+
+		// initialise and start the writer thread
+		init( capacity );
+
+	}
+
+
+	void logwriter::init( size_t capacity ) throw( logexception ) {
+
+		// sanity check
+		if ( capacity == 0 ) {
+			throw logexception( "Invalid queue capacity" );
+		}
+
+		// allocate batch buffer space ( double buffered )
+		_batch = new char[_ring.capacity() * 2];
+
+		// io_uring write backend, fall back to write() if not available
+		iovec buffers[2];
+		for ( int i = 0; i < 2; i++ ) {
+			buffers[i].iov_base = _batch + ( i * _ring.capacity() );
+			buffers[i].iov_len  = _ring.capacity();
+		}
+
+		try {
+			_uring = new loguring( _logfd, buffers, 2 );
+		} catch ( logexception &e ) {
+			_uring = 0;
+		}
+
+		// synchronisation primitives
+		pthread_mutex_init( &_mutex, 0 );
+		pthread_mutex_init( &_side_mutex, 0 );
+		pthread_cond_init( &_cond, 0 );
+
+		// start the writer thread
+		if ( ( errno = pthread_create( &_thread, 0, &logwriter::start, this ) ) != 0 ) {
+
+			// cleanup
+			pthread_cond_destroy( &_cond );
+			pthread_mutex_destroy( &_side_mutex );
+			pthread_mutex_destroy( &_mutex );
+			delete _uring;
+			delete [] _batch;
+
+			// throw a log exception with system message
+			throw logexception();
+
+		}
+
+	}
+
+
+	logwriter::~logwriter() throw() {
+
+		// signal the writer thread to stop, it will drain the queue first
+		pthread_mutex_lock( &_mutex );
+		__atomic_store_n( &_stop, 1, __ATOMIC_SEQ_CST );
+		pthread_cond_signal( &_cond );
+		pthread_mutex_unlock( &_mutex );
+
+		// wait for the writer thread
+		pthread_join( _thread, 0 );
+
+		// cleanup
+		pthread_cond_destroy( &_cond );
+		pthread_mutex_destroy( &_side_mutex );
+		pthread_mutex_destroy( &_mutex );
+		delete _uring;
+		delete [] _batch;
+
+	}
+
+
+	void * logwriter::start( void * arg ) throw() {
+
+		// writer instance
+		logwriter * w = (logwriter *) arg;
+		w->run();
+
+		return 0;
+
+	}
+
+
+	void logwriter::run() throw() {
+
+		for (;;) {
+
+			// check - oversized record handed over? the records queued
+			// before it are written out first
+			char * side = __atomic_load_n( &_side, __ATOMIC_ACQUIRE );
+			uint64_t limit = ( side != 0 ) ? _side_position : ~( (uint64_t) 0 );
+
+			// copy out and write all the published records
+			size_t n = _ring.pop( _batch + ( _current * _ring.capacity() ), limit );
+			uint64_t h = _ring.head();
+
+			if ( n > 0 ) {
+
+				// check - submitted to be written out asynchronously?
+				if ( wsubmit( n, h ) ) {
+					continue;
+				}
+
+				if ( wfd( _batch + ( _current * _ring.capacity() ), n ) ) {
+					wrote( n );
+				}
+
+			}
+
+			// wait for any batch in flight
+			wreap();
+			__atomic_store_n( &_written, h, __ATOMIC_RELEASE );
+
+			// write out the oversized record once its turn has come
+			if ( ( side != 0 ) && ( h >= limit ) ) {
+
+				if ( wfd( side, _side_n ) ) {
+					wrote( _side_n );
+				}
+
+				delete [] side;
+				__atomic_store_n( &_side, (char *) 0, __ATOMIC_RELEASE );
+
+				continue;
+
+			}
+
+			if ( n > 0 ) {
+				continue;
+			}
+
+			// check - records reserved but not published yet?
+			if ( _ring.tail() != h ) {
+				sched_yield();
+				continue;
+			}
+
+			// check - oversized record waiting for the queue?
+			if ( side != 0 ) {
+				continue;
+			}
+
+			// check - queue drained and asked to stop?
+			if ( __atomic_load_n( &_stop, __ATOMIC_SEQ_CST ) && ( __atomic_load_n( &_side, __ATOMIC_ACQUIRE ) == 0 ) ) {
+				break;
+			}
+
+			// wait for data, producers only signal if we are sleeping
+			pthread_mutex_lock( &_mutex );
+			__atomic_store_n( &_sleeping, 1, __ATOMIC_SEQ_CST );
+
+			if ( ( _ring.tail() == _ring.head() ) && ( __atomic_load_n( &_side, __ATOMIC_SEQ_CST ) == 0 )
+					&& (! __atomic_load_n( &_stop, __ATOMIC_SEQ_CST ) ) ) {
+
+				// time limited as a safety net
+				timespec ts;
+				clock_gettime( CLOCK_REALTIME, &ts );
+				ts.tv_nsec += 100000000;
+
+				if ( ts.tv_nsec >= 1000000000 ) {
+					ts.tv_sec++;
+					ts.tv_nsec -= 1000000000;
+				}
+
+				pthread_cond_timedwait( &_cond, &_mutex, &ts );
+
+			}
+
+			__atomic_store_n( &_sleeping, 0, __ATOMIC_SEQ_CST );
+			pthread_mutex_unlock( &_mutex );
+
+		}
+
+	}
+
+
+	bool logwriter::wsubmit( size_t n, uint64_t position ) throw() {
+
+		// sanity check
+		if ( _uring == 0 ) {
+			return false;
+		}
+
+		// previous batch must be written out first to preserve the order
+		wreap();
+
+		if (! _uring->submit( _current, n ) ) {
+			return false;
+		}
+
+		_inflight   = position;
+		_inflight_n = n;
+
+		// copy out the next batch into the other buffer
+		_current ^= 1;
+
+		return true;
+
+	}
+
+
+	void logwriter::wreap() throw() {
+
+		// sanity check - anything in flight?
+		if ( _inflight == 0 ) {
+			return;
+		}
+
+		if ( _uring->wait() ) {
+			wrote( _inflight_n );
+		}
+
+		__atomic_store_n( &_written, _inflight, __ATOMIC_RELEASE );
+		_inflight = 0;
+
+	}
+
+
+	void logwriter::wside( const iovec * iov, int iovcnt, size_t n ) throw() {
+
+		// copy the record so it is written out with a single write
+		char * record = new char[n];
+		size_t offset = 0;
+
+		for ( int i = 0; i < iovcnt; i++ ) {
+			memcpy( record + offset, iov[i].iov_base, iov[i].iov_len );
+			offset += iov[i].iov_len;
+		}
+
+		pthread_mutex_lock( &_side_mutex );
+
+		// wait for the writer thread to write out the previous one
+		for ( unsigned int attempt = 0; __atomic_load_n( &_side, __ATOMIC_ACQUIRE ) != 0; attempt++ ) {
+			wake();
+			backoff( attempt );
+		}
+
+		_side_n        = n;
+		_side_position = _ring.tail();
+		__atomic_store_n( &_side, record, __ATOMIC_SEQ_CST );
+
+		pthread_mutex_unlock( &_side_mutex );
+
+		// signal the writer thread
+		wake();
+
+	}
+
+
+	void logwriter::wrote( size_t n ) throw() {
+
+		// account for the written out data, this may rotate the log file
+		if ( _rotator != 0 ) {
+			_rotator->written( n );
+		}
+
+	}
+
+
+	void logwriter::wake() throw() {
+
+		// pairs with the writer thread setting the sleeping flag before
+		// checking the queue, one of us is guaranteed to see the other
+		__atomic_thread_fence( __ATOMIC_SEQ_CST );
+
+		if ( __atomic_load_n( &_sleeping, __ATOMIC_SEQ_CST ) ) {
+			pthread_mutex_lock( &_mutex );
+			pthread_cond_signal( &_cond );
+			pthread_mutex_unlock( &_mutex );
+		}
+
+	}
+
+
+	void logwriter::wait( uint64_t position ) throw() {
+
+		for ( unsigned int attempt = 0; __atomic_load_n( &_written, __ATOMIC_ACQUIRE ) < position; attempt++ ) {
+			wake();
+			backoff( attempt );
+		}
+
+	}
+
+
+	void logwriter::backoff( unsigned int attempt ) throw() {
+
+		if ( attempt < 16 ) {
+#if defined( __i386__ ) || defined( __x86_64__ )
+			__builtin_ia32_pause();
+#endif
+		} else if ( attempt < 64 ) {
+			sched_yield();
+		} else {
+			timespec ts = { 0, 50000 };
+			nanosleep( &ts, 0 );
+		}
+
+	}
+
+
+	bool logwriter::wfd( const char * data, size_t n ) throw() {
+
+		while ( n > 0 ) {
+
+			ssize_t w = ::write( _logfd, data, n );
+
+			if ( w < 0 ) {
+
+				// retry if interrupted
+				if ( errno == EINTR ) {
+					continue;
+				}
+
+				return false;
+
+			}
+
+			data += w;
+			n    -= w;
+
+		}
+
+		return true;
+
+	}
+
+
+	bool logwriter::push( const char * data, size_t n ) throw() {
+
+		iovec iov;
+		iov.iov_base = (void *) data;
+		iov.iov_len  = n;
+
+		return push( &iov, 1 );
+
+	}
+
+
+	bool logwriter::push( const iovec * iov, int iovcnt ) throw() {
+
+		// record size
+		size_t n = 0;
+		for ( int i = 0; i < iovcnt; i++ ) {
+			n += iov[i].iov_len;
+		}
+
+		// sanity check
+		if ( n == 0 ) {
+			return true;
+		}
+
+		// check - will this ever fit into the queue?
+		if (! _ring.fits( n ) ) {
+
+			__atomic_fetch_add( &_overflows, 1, __ATOMIC_RELAXED );
+
+			if ( ( _overflow == drop ) || ( _overflow == drop_oldest ) ) {
+				__atomic_fetch_add( &_dropped, 1, __ATOMIC_RELAXED );
+				return false;
+			}
+
+			// the writer thread writes it out after the records
+			// queued so far to preserve the record order
+			wside( iov, iovcnt, n );
+
+			return true;
+
+		}
+
+		for ( unsigned int attempt = 0; (! _ring.push( iov, iovcnt, n ) ); attempt++ ) {
+
+			if ( attempt == 0 ) {
+				__atomic_fetch_add( &_overflows, 1, __ATOMIC_RELAXED );
+			}
+
+			switch ( _overflow ) {
+
+				case drop:
+					__atomic_fetch_add( &_dropped, 1, __ATOMIC_RELAXED );
+					return false;
+
+				case drop_oldest:
+					{
+						int d = _ring.discard( n );
+						if ( d > 0 ) {
+							__atomic_fetch_add( &_dropped, d, __ATOMIC_RELAXED );
+						}
+					}
+					break;
+
+				case spin:
+					backoff( 0 );
+					break;
+
+				default:
+					wake();
+					backoff( attempt );
+					break;
+
+			}
+
+		}
+
+		// signal the writer thread
+		wake();
+
+		return true;
+
+	}
+
+
+	bool logwriter::write( const priority::log_priority_t &, const iovec * iov, int iovcnt ) throw() {
+
+		// dropped records are accounted for by the writer and
+		// shouldn't put the stream into a failed state
+		push( iov, iovcnt );
+
+		return true;
+
+	}
+
+
+	void logwriter::drain() throw() {
+
+		wait( _ring.tail() );
+
+		// wait for any oversized record handed over
+		for ( unsigned int attempt = 0; __atomic_load_n( &_side, __ATOMIC_ACQUIRE ) != 0; attempt++ ) {
+			wake();
+			backoff( attempt );
+		}
+
+	}
+
+
+	size_t logwriter::dropped() const throw() {
+		return __atomic_load_n( &_dropped, __ATOMIC_RELAXED );
+	}
+
+
+	size_t logwriter::overflows() const throw() {
+		return __atomic_load_n( &_overflows, __ATOMIC_RELAXED );
+	}
+
+} /* end of namespace logstreamxx */
+
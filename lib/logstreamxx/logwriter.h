@@ -0,0 +1,294 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTREAMXX_LOGWRITER_H
+#define LOGSTREAMXX_LOGWRITER_H
+
+#include <logstreamxx/logsink.h>
+#include <logstreamxx/logexception.h>
+#include <logstreamxx/logring.h>
+#include <logstreamxx/logrotator.h>
+
+#include <cstddef>
+#include <pthread.h>
+#include <sys/uio.h>
+
+#ifndef LOGWRITER_QUEUE_SIZE
+#define LOGWRITER_QUEUE_SIZE 65536
+#endif
+
+
+namespace logstreamxx {
+
+	// forward declarations
+	class loguring;
+
+
+	/**
+	*   @brief Asynchronous log writer class
+	*
+	*   Background writer which owns a bounded in-memory queue and a
+	*   dedicated thread that drains the queue to a file descriptor.
+	*   Log stream buffers push completed log records into the queue
+	*   instead of writing to the destination on the caller's thread.
+	*
+	*   The queue is a lock-free multi-producer/single-consumer ring
+	*   ( logring ) so producers never take a lock to queue a record.
+	*   The writer thread copies out all the published records at once
+	*   and writes them out with a single system call. On Linux, if the
+	*   library is built with io_uring support and it is available at
+	*   runtime, batches are written out asynchronously through io_uring
+	*   from two fixed registered buffers so the writer thread copies out
+	*   the next batch while the previous one is being written out.
+	*   Otherwise this falls back to @c write().
+	*
+	*/
+	class logwriter : public logsink {
+	public:
+
+		/**
+		*   @brief queue overflow policy type
+		*
+		*   These define what happens to a log record pushed into
+		*   a full queue.
+		*
+		*/
+		enum overflow_t {
+			block        = 0,       //!< wait (sleep) until there is space in the queue
+			drop         = 1,       //!< discard the new record and count it as dropped
+			drop_newest  = drop,    //!< same as logwriter::drop
+			drop_oldest  = 2,       //!< discard the oldest queued records to make space
+			spin         = 3        //!< busy-wait until there is space in the queue
+		};
+
+		/**
+		*   @brief constructor
+		*   @param output_fd log output file descriptor
+		*   @param overflow queue overflow policy
+		*   @param capacity queue capacity in bytes (rounded up to a power of 2)
+		*
+		*   Initialise the queue and start the background writer thread
+		*   which writes queued log records to @c output_fd.
+		*
+		*/
+		logwriter( int output_fd, const overflow_t &overflow = block,
+				size_t capacity = LOGWRITER_QUEUE_SIZE ) throw( logexception );
+
+		/**
+		*   @brief overloaded constructor
+		*   @param rotator log file rotator
+		*   @param overflow queue overflow policy
+		*   @param capacity queue capacity in bytes (rounded up to a power of 2)
+		*
+		*   Initialise the queue and start the background writer thread
+		*   which writes queued log records to the log file owned by
+		*   @c rotator. Log files are rotated in between the writes so
+		*   producers never wait for a rotation.
+		*
+		*   @note The log rotator is not owned by the log writer and
+		*         must outlive it.
+		*
+		*/
+		logwriter( logrotator * rotator, const overflow_t &overflow = block,
+				size_t capacity = LOGWRITER_QUEUE_SIZE ) throw( logexception );
+
+		/**
+		*   @brief destructor
+		*
+		*   Write out all the queued log records, stop the background
+		*   writer thread and deallocate the queue.
+		*
+		*/
+		virtual ~logwriter() throw();
+
+		/**
+		*   @brief push a log record into the queue
+		*   @param data log record
+		*   @param n log record size
+		*   @return boolean @c true if the record was queued or @c false
+		*           if it was dropped
+		*
+		*   Copy @c n characters pointed by @c data into the queue. If
+		*   there isn't enough space then the overflow policy decides
+		*   whether to wait or to drop the record.
+		*
+		*   @note Records larger than the queue capacity are copied
+		*         and handed over to the writer thread to be written out
+		*         after the records queued before them (in block and
+		*         spin modes).
+		*
+		*/
+		bool push( const char * data, size_t n ) throw();
+
+		/**
+		*   @brief push a log record into the queue
+		*   @param iov log record parts
+		*   @param iovcnt number of log record parts
+		*   @return boolean @c true if the record was queued or @c false
+		*           if it was dropped
+		*
+		*   Gather the @c iovcnt parts described by @c iov into the queue
+		*   as a single log record. The parts are never separated by
+		*   records pushed from other threads.
+		*
+		*/
+		bool push( const iovec * iov, int iovcnt ) throw();
+
+		/**
+		*   @brief push a log record into the queue
+		*   @return boolean @c true, dropped log records are accounted
+		*           for by the log writer instead
+		*
+		*   @sa logsink::write(), push()
+		*
+		*/
+		virtual bool write( const priority::log_priority_t &p, const iovec * iov, int iovcnt ) throw();
+
+		/**
+		*   @brief wait until the queue is drained
+		*
+		*   Block the caller until all the log records queued so far have
+		*   been written out to the destination.
+		*
+		*/
+		void drain() throw();
+
+		/**
+		*   @brief get the number of dropped log records
+		*   @return number of log records dropped due to a full queue
+		*/
+		size_t dropped() const throw();
+
+		/**
+		*   @brief get the number of queue overflows
+		*   @return number of times a log record was pushed into a full
+		*           queue, irrespective of the overflow policy
+		*/
+		size_t overflows() const throw();
+
+
+	private:
+
+		/** log file descriptor */
+		int _logfd;
+
+		/** log file rotator (if any) */
+		logrotator * _rotator;
+
+		/** queue overflow policy */
+		overflow_t _overflow;
+
+		/** queue */
+		logring _ring;
+
+		/** writer thread batch buffers */
+		char * _batch;
+
+		/** batch buffer to copy out the next batch into */
+		int _current;
+
+		/** io_uring write backend (if available) */
+		loguring * _uring;
+
+		/** queue position of the batch in flight ( 0 if none ) */
+		uint64_t _inflight;
+
+		/** size of the batch in flight */
+		size_t _inflight_n;
+
+		/** queue position written out so far */
+		uint64_t _written;
+
+		/** dropped records count */
+		size_t _dropped;
+
+		/** queue overflows count */
+		size_t _overflows;
+
+		/** oversized log record handed over to the writer thread ( 0 if none ) */
+		char * _side;
+
+		/** size of the oversized log record */
+		size_t _side_n;
+
+		/** queue position to write out the oversized log record at */
+		uint64_t _side_position;
+
+		/** mutex to serialise handing over oversized log records */
+		pthread_mutex_t _side_mutex;
+
+		/** flag to indicate the writer thread to stop */
+		int _stop;
+
+		/** flag to indicate the writer thread is waiting for data */
+		int _sleeping;
+
+		/** writer thread wake up mutex */
+		pthread_mutex_t _mutex;
+
+		/** condition to signal new data in the queue */
+		pthread_cond_t _cond;
+
+		/** writer thread */
+		pthread_t _thread;
+
+		/** initialise and start the writer thread */
+		void init( size_t capacity ) throw( logexception );
+
+		/** writer thread main loop */
+		void run() throw();
+
+		/** wake up the writer thread if it is waiting for data */
+		void wake() throw();
+
+		/** wait until the queue is written out up to @c position */
+		void wait( uint64_t position ) throw();
+
+		/** write all @c n characters to the log file descriptor */
+		bool wfd( const char * data, size_t n ) throw();
+
+		/** submit the current batch of @c n characters, up to queue
+		    position @c position, to be written out asynchronously */
+		bool wsubmit( size_t n, uint64_t position ) throw();
+
+		/** wait for the batch in flight to be written out */
+		void wreap() throw();
+
+		/** hand over an oversized log record to the writer thread */
+		void wside( const iovec * iov, int iovcnt, size_t n ) throw();
+
+		/** account for @c n characters written out */
+		void wrote( size_t n ) throw();
+
+		/** writer thread entry point */
+		static void * start( void * arg ) throw();
+
+		/** back off while waiting, spinning first and then sleeping */
+		static void backoff( unsigned int attempt ) throw();
+
+		// disallow copying
+		logwriter( const logwriter & );
+		logwriter &operator =( const logwriter & );
+
+	};
+
+} /* end of namespace logstreamxx */
+
+#endif /* !LOGSTREAMXX_LOGWRITER_H */
+
@@ -20,6 +20,27 @@
 #ifndef LOGSTREAMXX_PRIORITY_H
 #define LOGSTREAMXX_PRIORITY_H
 
+/**
+*   @brief compile-time log level
+*
+*   Numeric value of the highest logstreamxx::priority::log_priority_t
+*   (i.e. the least severe) to compile log statements in for. Log
+*   statements above this level compile away completely irrespective
+*   of the runtime log-mask. e.g. @c -DLOGSTREAMXX_LOGLEVEL=5 removes
+*   @c info and @c debug log statements from the build.
+*
+*   Defaults to 7 ( logstreamxx::priority::debug ) which keeps all
+*   log statements.
+*
+*/
+#ifndef LOGSTREAMXX_LOGLEVEL
+#define LOGSTREAMXX_LOGLEVEL 7
+#endif
+
+#if ( LOGSTREAMXX_LOGLEVEL < 0 ) || ( LOGSTREAMXX_LOGLEVEL > 7 )
+#error "LOGSTREAMXX_LOGLEVEL must be between 0 (emerg) and 7 (debug)"
+#endif
+
 
 namespace logstreamxx {
 
@@ -107,6 +128,33 @@ namespace logstreamxx {
 
 		}
 
+
+		/**
+		*   @brief convert log priority value into its syslog(3) name
+		*   @return name of the log priority ( e.g. @c "info" )
+		*
+		*   This is used as the level field value of structured log
+		*   records.
+		*
+		*/
+		static const char * name( const log_priority_t &p ) {
+
+			// priority value to name mapping
+			static const char * priority_name[8] = {
+				"emerg",
+				"alert",
+				"crit",
+				"err",
+				"warning",
+				"notice",
+				"info",
+				"debug"
+			};
+
+			return priority_name[p];
+
+		}
+
 	};
 
 } /* end of namespace logstreamxx */
@@ -0,0 +1,348 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "sharedlogstream.h"
+#include "lognumput.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
+
+namespace logstreamxx {
+
+	sharedlogstream::tstream::tstream( sharedlogstream * owner, logstreambuf * sb ) throw() :
+			owner( owner ), sb( sb ), os( sb ), generation( 0 ),
+			buffer_size( LOGSTREAMBUF_SIZE ), buffer_limit( LOGSTREAMBUF_LIMIT ) {
+
+		// locale-free number formatting
+		os.imbue( std::locale( os.getloc(), new lognumput() ) );
+
+	}
+
+
+	sharedlogstream::tstream::~tstream() throw() {
+
+		// cleanup, this will sync any buffered content
+		delete sb;
+
+	}
+
+
+	sharedlogstream::sharedlogstream() throw( logexception ) :
+			_fd( -1 ), _writer( 0 ), _sink( 0 ), _mask( 1 ), _pattern( LOGSTREAMBUF_PATTERN ),
+			_buffer_size( LOGSTREAMBUF_SIZE ), _buffer_limit( LOGSTREAMBUF_LIMIT ), _generation( 1 ) {
+
+		// initialise thread specific data
+		init();
+
+	}
+
+
+	sharedlogstream::sharedlogstream( const char * filename, bool append, mode_t mode ) throw( logexception ) :
+			_fd( -1 ), _writer( 0 ), _sink( 0 ), _mask( 1 ), _pattern( LOGSTREAMBUF_PATTERN ),
+			_buffer_size( LOGSTREAMBUF_SIZE ), _buffer_limit( LOGSTREAMBUF_LIMIT ), _generation( 1 ) {
+
+		// open file
+		lopen( filename, append, mode );
+
+		// initialise thread specific data
+		try {
+			init();
+		} catch ( logexception &e ) {
+			::close( _fd );
+			throw;
+		}
+
+	}
+
+
+	sharedlogstream::sharedlogstream( const char * filename, const logwriter::overflow_t &overflow,
+			size_t capacity, bool append, mode_t mode ) throw( logexception ) :
+			_fd( -1 ), _writer( 0 ), _sink( 0 ), _mask( 1 ), _pattern( LOGSTREAMBUF_PATTERN ),
+			_buffer_size( LOGSTREAMBUF_SIZE ), _buffer_limit( LOGSTREAMBUF_LIMIT ), _generation( 1 ) {
+
+		// open file
+		lopen( filename, append, mode );
+
+		try {
+
+			// background log writer
+			_writer = new logwriter( _fd, overflow, capacity );
+			_sink   = _writer;
+
+			// initialise thread specific data
+			init();
+
+		} catch ( logexception &e ) {
+			delete _writer;
+			::close( _fd );
+			throw;
+		}
+
+	}
+
+
+	sharedlogstream::sharedlogstream( logsink * sink ) throw( logexception ) :
+			_fd( -1 ), _writer( 0 ), _sink( sink ), _mask( 1 ), _pattern( LOGSTREAMBUF_PATTERN ),
+			_buffer_size( LOGSTREAMBUF_SIZE ), _buffer_limit( LOGSTREAMBUF_LIMIT ), _generation( 1 ) {
+
+		// sanity check
+		if ( _sink == 0 ) {
+			throw logexception( "Invalid log sink" );
+		}
+
+		// initialise thread specific data
+		init();
+
+	}
+
+
+	sharedlogstream::~sharedlogstream() throw() {
+
+		// no more thread exit handler calls
+		pthread_key_delete( _key );
+
+		// cleanup per-thread streams
+		pthread_mutex_lock( &_mutex );
+
+		for ( std::set<tstream *>::iterator it = _streams.begin(); it != _streams.end(); ++it ) {
+			delete *it;
+		}
+
+		_streams.clear();
+		pthread_mutex_unlock( &_mutex );
+		pthread_mutex_destroy( &_mutex );
+
+		// write out queued log records and stop the writer
+		delete _writer;
+
+		// close any open files
+		if ( _fd != -1 ) {
+			::close( _fd );
+		}
+
+	}
+
+
+	void sharedlogstream::init() throw( logexception ) {
+
+		// thread specific data key
+		if ( ( errno = pthread_key_create( &_key, &sharedlogstream::release ) ) != 0 ) {
+			// throw a log exception with system message
+			throw logexception();
+		}
+
+		pthread_mutex_init( &_mutex, 0 );
+
+	}
+
+
+	void sharedlogstream::lopen( const char * filename, bool append, mode_t mode ) throw( logexception ) {
+
+		// set file open flags
+		int flags = O_WRONLY | O_CREAT | O_APPEND;
+
+		// truncate file?
+		if (! append ) {
+			flags |= O_TRUNC;
+		}
+
+		// open file
+		_fd = ::open( filename, flags, mode );
+
+		// check - was the open file successful?
+		if ( _fd == -1 ) {
+			// throw a log exception with system message
+			throw logexception();
+		}
+
+	}
+
+
+	void sharedlogstream::release( void * arg ) throw() {
+
+		// per-thread stream of the exiting thread
+		tstream * ts = (tstream *) arg;
+		sharedlogstream * owner = ts->owner;
+
+		pthread_mutex_lock( &owner->_mutex );
+		owner->_streams.erase( ts );
+		pthread_mutex_unlock( &owner->_mutex );
+
+		// cleanup, this will sync any buffered content
+		delete ts;
+
+	}
+
+
+	void sharedlogstream::configure( tstream * ts ) throw() {
+
+		pthread_mutex_lock( &_mutex );
+
+		ts->sb->setlogmask( _mask );
+		ts->sb->lprefix( _prefix );
+		ts->sb->lpattern( _pattern );
+
+		// check - buffer changed? ( replacing the buffer syncs it so
+		// only do so when needed )
+		if ( ( ts->buffer_size != _buffer_size ) || ( ts->buffer_limit != _buffer_limit ) ) {
+			if ( ts->sb->lbuffer( _buffer_size, _buffer_limit ) ) {
+				ts->buffer_size  = _buffer_size;
+				ts->buffer_limit = _buffer_limit;
+			}
+		}
+
+		ts->generation = _generation;
+
+		pthread_mutex_unlock( &_mutex );
+
+	}
+
+
+	std::ostream &sharedlogstream::stream() throw() {
+
+		// per-thread stream
+		tstream * ts = (tstream *) pthread_getspecific( _key );
+
+		// check - first use in this thread?
+		if ( ts == 0 ) {
+
+			// log stream buffer instance
+			logstreambuf * sb;
+
+			if ( _sink != 0 ) {
+				sb = new logstreambuf( _sink );
+			} else if ( _fd != -1 ) {
+				sb = new logstreambuf( _fd );
+			} else {
+				sb = new logstreambuf();
+			}
+
+			ts = new tstream( this, sb );
+			pthread_setspecific( _key, ts );
+
+			pthread_mutex_lock( &_mutex );
+			_streams.insert( ts );
+			pthread_mutex_unlock( &_mutex );
+
+		}
+
+		// check - shared configuration changed?
+		if ( ts->generation != __atomic_load_n( &_generation, __ATOMIC_ACQUIRE ) ) {
+			configure( ts );
+		}
+
+		return ts->os;
+
+	}
+
+
+	std::ostream &sharedlogstream::operator <<( const priority::log_priority_t &p ) throw() {
+
+		// per-thread stream
+		std::ostream &os = stream();
+
+		// set priority for the calling thread's log stream buffer
+		( (logstreambuf *) os.rdbuf() )->lpriority( p );
+
+		return os;
+
+	}
+
+
+	std::ostream &sharedlogstream::operator <<( std::ostream &( *pf )( std::ostream & ) ) {
+		return pf( stream() );
+	}
+
+
+	int sharedlogstream::loglevel( const priority::log_priority_t &level ) throw() {
+
+		// create bit mask
+		int mask = 1 << level;
+		mask = ( mask - 1 ) | mask;
+
+		pthread_mutex_lock( &_mutex );
+
+		// update
+		__atomic_store_n( &_mask, mask, __ATOMIC_RELAXED );
+		__atomic_store_n( &_generation, _generation + 1, __ATOMIC_RELEASE );
+
+		pthread_mutex_unlock( &_mutex );
+
+		return mask;
+
+	}
+
+
+	void sharedlogstream::logprefix( const std::string &p ) throw() {
+
+		pthread_mutex_lock( &_mutex );
+
+		// update
+		_prefix = p;
+		__atomic_store_n( &_generation, _generation + 1, __ATOMIC_RELEASE );
+
+		pthread_mutex_unlock( &_mutex );
+
+	}
+
+
+	bool sharedlogstream::logpattern( const std::string &pattern ) throw() {
+
+		// check - valid pattern? ( per-thread buffers are updated on
+		// their next use )
+		if (! logstreambuf::vpattern( pattern ) ) {
+			return false;
+		}
+
+		pthread_mutex_lock( &_mutex );
+
+		// update
+		_pattern = pattern;
+		__atomic_store_n( &_generation, _generation + 1, __ATOMIC_RELEASE );
+
+		pthread_mutex_unlock( &_mutex );
+
+		return true;
+
+	}
+
+
+	bool sharedlogstream::logbuffer( size_t size, size_t limit ) throw() {
+
+		// sanity check
+		if ( size < 2 ) {
+			return false;
+		}
+
+		pthread_mutex_lock( &_mutex );
+
+		// update
+		_buffer_size  = size;
+		_buffer_limit = limit;
+		__atomic_store_n( &_generation, _generation + 1, __ATOMIC_RELEASE );
+
+		pthread_mutex_unlock( &_mutex );
+
+		return true;
+
+	}
+
+} /* end of namespace logstreamxx */
@@ -0,0 +1,301 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTREAMXX_SHAREDLOGSTREAM_H
+#define LOGSTREAMXX_SHAREDLOGSTREAM_H
+
+#include <logstreamxx/logstreambuf.h>
+
+#include <ostream>
+#include <set>
+#include <pthread.h>
+#include <sys/stat.h>
+
+
+namespace logstreamxx {
+
+	/**
+	*   @brief Thread-safe log stream class
+	*
+	*   A log stream which can be shared between threads. Each thread
+	*   gets its own output stream and log stream buffer (put area,
+	*   priority and continuation state) on first use and completed log
+	*   records are committed to the shared destination as whole lines,
+	*   either with a single write or through a shared background log
+	*   writer. Log records longer than the per-thread buffer limit
+	*   ( see logbuffer() ) are written out in parts.
+	*
+	*   The log-mask and prefix are shared by all the threads. Apart from
+	*   the first use in a thread, logging does not take any locks within
+	*   this class.
+	*
+	*   @code
+	*   logstreamxx::sharedlogstream logger( "/var/log/app.log" );
+	*   logger << logstreamxx::priority::info << "from any thread" << std::endl;
+	*   @endcode
+	*
+	*   @note Stream state (formatting flags etc.) is per-thread as well.
+	*
+	*/
+	class sharedlogstream {
+	public:
+
+		/**
+		*   @brief constructor
+		*
+		*   Initialise a shared log stream with standard output ( @c STDOUT )
+		*   as the destination.
+		*
+		*/
+		sharedlogstream() throw( logexception );
+
+		/**
+		*   @brief overloaded constructor
+		*   @param filename log destination filename
+		*   @param append boolean flag to indicate whether to append to
+		*                 the log file or truncate the file if already
+		*                 exists
+		*
+		*   @param mode file mode to open the log file with
+		*
+		*   Initialise a shared log stream with @c filename as the output
+		*   destination. Destination file will be created if it doesn't exist.
+		*
+		*/
+		sharedlogstream( const char * filename, bool append = true, mode_t mode = 00644 ) throw( logexception );
+
+		/**
+		*   @brief overloaded constructor (asynchronous)
+		*   @param filename log destination filename
+		*   @param overflow queue overflow policy
+		*   @param capacity queue capacity in bytes
+		*   @param append boolean flag to indicate whether to append to
+		*                 the log file or truncate the file if already
+		*                 exists
+		*
+		*   @param mode file mode to open the log file with
+		*
+		*   Initialise a shared log stream with @c filename as the output
+		*   destination and a background log writer shared by all the
+		*   threads to write out the log records.
+		*
+		*   @sa logwriter
+		*
+		*/
+		sharedlogstream( const char * filename, const logwriter::overflow_t &overflow,
+				size_t capacity = LOGWRITER_QUEUE_SIZE, bool append = true,
+				mode_t mode = 00644 ) throw( logexception );
+
+		/**
+		*   @brief overloaded constructor
+		*   @param sink log sink
+		*
+		*   Initialise a shared log stream which hands over log records
+		*   from all the threads to @c sink.
+		*
+		*   @note The log sink is not owned by the shared log stream,
+		*         must be thread-safe and must outlive it.
+		*
+		*/
+		sharedlogstream( logsink * sink ) throw( logexception );
+
+		/**
+		*   @brief destructor
+		*
+		*   Sync and deallocate all the per-thread buffers, write out
+		*   any queued log records and close the log file.
+		*
+		*   @note No thread should be using the shared log stream when
+		*         it is destroyed.
+		*
+		*/
+		virtual ~sharedlogstream() throw();
+
+		/**
+		*   @brief get the output stream for the calling thread
+		*   @return calling thread's output stream
+		*/
+		std::ostream &stream() throw();
+
+		/**
+		*   @brief overloaded output stream operator for log priorities
+		*/
+		std::ostream &operator <<( const priority::log_priority_t &p ) throw();
+
+		/**
+		*   @brief overloaded output stream operator for manipulators
+		*/
+		std::ostream &operator <<( std::ostream &( *pf )( std::ostream & ) );
+
+		/**
+		*   @brief output stream operator
+		*
+		*   Insert @c v into the calling thread's output stream.
+		*
+		*/
+		template <typename T>
+		std::ostream &operator <<( const T &v ) {
+			return stream() << v;
+		}
+
+		/**
+		*   @brief set log output level
+		*   @param level log output level
+		*   @return log priority bit mask
+		*
+		*   @sa logstream::loglevel()
+		*
+		*/
+		int loglevel( const priority::log_priority_t &level ) throw();
+
+		/**
+		*   @brief check whether logging is enabled for a priority
+		*   @param p log priority
+		*   @return boolean @c true if log records with priority @c p
+		*           will be written out or @c false otherwise
+		*/
+		bool enabled( const priority::log_priority_t &p ) const throw();
+
+		/**
+		*   @brief set an extra prefix for the log lines
+		*   @param p prefix
+		*
+		*   @sa logstream::logprefix()
+		*
+		*/
+		void logprefix( const std::string &p ) throw();
+
+		/**
+		*   @brief set the log line header layout
+		*   @param pattern header layout pattern
+		*   @return boolean @c true on success or @c false if @c pattern
+		*           is invalid
+		*
+		*   @sa logstream::logpattern()
+		*
+		*/
+		bool logpattern( const std::string &pattern ) throw();
+
+		/**
+		*   @brief change the per-thread buffer size
+		*   @param size buffer size
+		*   @param limit maximum buffer size a single log record can
+		*                grow the buffer to
+		*
+		*   @return boolean @c true on success or @c false if @c size is
+		*           less than 2
+		*
+		*   Log records up to @c limit characters are committed to the
+		*   shared destination with a single write, so they are never
+		*   interleaved with log records from other threads.
+		*
+		*   @note The buffer size defaults to LOGSTREAMBUF_SIZE and the
+		*         limit to LOGSTREAMBUF_LIMIT ( @c PIPE_BUF ).
+		*
+		*   @sa logstreambuf::lbuffer()
+		*
+		*/
+		bool logbuffer( size_t size, size_t limit = LOGSTREAMBUF_LIMIT ) throw();
+
+
+	private:
+
+		/** per-thread output stream */
+		struct tstream {
+
+			tstream( sharedlogstream * owner, logstreambuf * sb ) throw();
+			~tstream() throw();
+
+			/** shared log stream owning this instance */
+			sharedlogstream * owner;
+
+			/** per-thread log stream buffer */
+			logstreambuf * sb;
+
+			/** per-thread output stream */
+			std::ostream os;
+
+			/** configuration generation applied to the buffer */
+			unsigned int generation;
+
+			/** buffer size and limit applied to the buffer */
+			size_t buffer_size;
+			size_t buffer_limit;
+
+		};
+
+		/** file descriptor */
+		int _fd;
+
+		/** asynchronous log writer (if any) */
+		logwriter * _writer;
+
+		/** log sink (if any) */
+		logsink * _sink;
+
+		/** log priority mask */
+		int _mask;
+
+		/** additional log prefix to add to the log lines */
+		std::string _prefix;
+
+		/** log line header layout pattern */
+		std::string _pattern;
+
+		/** per-thread buffer size */
+		size_t _buffer_size;
+
+		/** per-thread buffer growth limit */
+		size_t _buffer_limit;
+
+		/** configuration generation, updated when the mask, prefix, pattern or buffer changes */
+		unsigned int _generation;
+
+		/** thread specific data key for the per-thread streams */
+		pthread_key_t _key;
+
+		/** per-thread streams */
+		std::set<tstream *> _streams;
+
+		/** mutex for the per-thread streams, the prefix, the pattern and the buffer */
+		pthread_mutex_t _mutex;
+
+		/** initialise thread specific data */
+		void init() throw( logexception );
+
+		/** open the log file */
+		void lopen( const char * filename, bool append, mode_t mode ) throw( logexception );
+
+		/** apply the shared configuration to a per-thread stream */
+		void configure( tstream * ts ) throw();
+
+		/** thread exit handler for the per-thread streams */
+		static void release( void * arg ) throw();
+
+	};
+
+
+	inline bool sharedlogstream::enabled( const priority::log_priority_t &p ) const throw() {
+		return ( ( 1 << p ) & __atomic_load_n( &_mask, __ATOMIC_RELAXED ) ) != 0;
+	}
+
+} /* end of namespace logstreamxx */
+
+#endif /* !LOGSTREAMXX_SHAREDLOGSTREAM_H */
+
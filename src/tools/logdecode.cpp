@@ -0,0 +1,89 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include <logstreamxx/logdecoder.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+int main( int argc, char * argv[] ) {
+
+	// sanity check
+	if ( ( argc > 2 ) || ( ( argc == 2 ) && ( strcmp( argv[1], "-h" ) == 0 ) ) ) {
+		fprintf( stderr, "Usage: %s [binary log file]\n", argv[0] );
+		fprintf( stderr, "Render a binary log written by logstreamxx::logrecorder as text.\n" );
+		return 1;
+	}
+
+	// input file (or STDIN)
+	int fd = STDIN_FILENO;
+
+	if ( argc == 2 ) {
+
+		fd = open( argv[1], O_RDONLY );
+
+		if ( fd == -1 ) {
+			perror( argv[1] );
+			return 1;
+		}
+
+	}
+
+	logstreamxx::logdecoder decoder;
+	std::vector<char> buffer( 65536 + 65536 );
+	std::string out;
+	size_t pending = 0;
+	ssize_t n;
+
+	try {
+
+		while ( ( n = read( fd, &buffer[pending], buffer.size() - pending ) ) > 0 ) {
+
+			pending += n;
+
+			// decode complete records and keep the rest for the next read
+			size_t consumed = decoder.decode( &buffer[0], pending, out );
+			memmove( &buffer[0], &buffer[consumed], pending - consumed );
+			pending -= consumed;
+
+			fwrite( out.data(), 1, out.length(), stdout );
+			out.clear();
+
+		}
+
+	} catch ( logstreamxx::logexception &e ) {
+		fprintf( stderr, "%s\n", e.what() );
+		return 1;
+	}
+
+	if ( pending > 0 ) {
+		fprintf( stderr, "Truncated binary log record at the end of input\n" );
+	}
+
+	close( fd );
+
+	return 0;
+
+}
+
@@ -0,0 +1,416 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include <logstreamxx/logencoder.h>
+#include <logstreamxx/logmacros.h>
+#include <logstreamxx/logmmap.h>
+#include <logstreamxx/logrecorder.h>
+#include <logstreamxx/logstream.h>
+#include <logstreamxx/sharedlogstream.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <ctime>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+using namespace logstreamxx;
+
+
+/**
+*   Logging hot path micro-benchmarks.
+*
+*   Results are written to stdout as one JSON object per line, e.g.
+*
+*   {"benchmark":"logstream_devnull","threads":1,"records":1000000,
+*    "seconds":0.512,"records_per_sec":1953125,"ns_per_record":512.0}
+*
+*   Usage: bench-runner [-n records] [-t max threads] [-d tmpfs directory]
+*
+*/
+
+
+/** benchmark options */
+static long records  = 1000000;
+static long threads  = 0;
+static std::string tmpdir;
+
+
+/** get a monotonic time value in seconds */
+static double now() {
+
+	timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+
+	return ts.tv_sec + ( ts.tv_nsec / 1e9 );
+
+}
+
+
+/** write out a benchmark result */
+static void report( const char * name, long nthreads, long n, double seconds ) {
+
+	printf( "{\"benchmark\":\"%s\",\"threads\":%ld,\"records\":%ld,"
+			"\"seconds\":%.6f,\"records_per_sec\":%.0f,\"ns_per_record\":%.2f}\n",
+			name, nthreads, n, seconds, n / seconds, ( seconds * 1e9 ) / n );
+	fflush( stdout );
+
+}
+
+
+/** log to a file, batching up to @c batch bytes if set */
+static void bench_logstream( const char * name, const char * filename, bool async, size_t batch = 0 ) {
+
+	logstream * logger;
+	if ( async ) {
+		logger = new logstream( filename, logwriter::block );
+	} else {
+		logger = new logstream( filename );
+	}
+
+	logger->loglevel( priority::info );
+
+	if ( batch > 0 ) {
+		logger->logflush( logstreambuf::flush_policy_t( batch, 100 ) );
+	}
+
+	double start = now();
+	for ( long i = 0; i < records; i++ ) {
+		LOGSTREAMXX_INFO( *logger ) << "benchmark record " << i << " value " << 3.14159 << std::endl;
+	}
+
+	// include the time to write out queued records
+	delete logger;
+	report( name, 1, records, now() - start );
+
+}
+
+
+#if __cplusplus >= 201103L
+/** same log records as logstream_devnull with a compile-time format string */
+static void bench_format() {
+
+	logstream logger( "/dev/null" );
+	logger.loglevel( priority::info );
+
+	double start = now();
+	for ( long i = 0; i < records; i++ ) {
+		LOGSTREAMXX_INFOF( logger, "benchmark record {} value {}", i, 3.14159 );
+	}
+
+	report( "logstream_format_devnull", 1, records, now() - start );
+
+}
+#endif
+
+
+/** metrics style log records, mostly numbers */
+static void bench_numbers() {
+
+	logstream logger( "/dev/null" );
+	logger.loglevel( priority::info );
+
+	double start = now();
+	for ( long i = 0; i < records; i++ ) {
+		LOGSTREAMXX_INFO( logger ) << "requests " << i << " bytes " << ( i * 1237 ) << " latency "
+				<< ( ( i % 1000 ) / 8.0 ) << " ratio " << 0.75 << std::endl;
+	}
+
+	report( "logstream_numbers_devnull", 1, records, now() - start );
+
+}
+
+
+/** log with the priority disabled */
+static void bench_disabled() {
+
+	logstream logger( "/dev/null" );
+	logger.loglevel( priority::warning );
+
+	double start = now();
+	for ( long i = 0; i < records; i++ ) {
+		LOGSTREAMXX_INFO( logger ) << "benchmark record " << i << " value " << 3.14159 << std::endl;
+	}
+
+	report( "logstream_disabled", 1, records, now() - start );
+
+}
+
+
+/** copy into a memory-mapped log file */
+static void bench_logmmap( const char * filename ) {
+
+	double start = now();
+	{
+		logmmap map( filename, false );
+		logstreambuf sb( &map );
+		std::ostream os( &sb );
+
+		sb.setlogmask( priority::mask::info );
+		sb.lpriority( priority::info );
+
+		for ( long i = 0; i < records; i++ ) {
+			os << "benchmark record " << i << " value " << 3.14159 << std::endl;
+		}
+	}
+
+	report( "logmmap_tmpfs", 1, records, now() - start );
+
+}
+
+
+/** deferred binary formatting */
+static void bench_logrecorder() {
+
+	int fd = open( "/dev/null", O_WRONLY );
+
+	double start = now();
+	{
+		logrecorder recorder( fd );
+		recorder.loglevel( priority::info );
+
+		for ( long i = 0; i < records; i++ ) {
+			LOGSTREAMXX_RECORD( recorder, priority::info, "benchmark record %ld value %f", i, 3.14159 );
+		}
+	}
+
+	report( "logrecorder_devnull", 1, records, now() - start );
+	close( fd );
+
+}
+
+
+/** escape and validate a multi-KB payload, per instruction set */
+static void bench_logencoder() {
+
+	// request body like payload, mostly ASCII text with a few quotes,
+	// new lines and non-ASCII characters
+	std::string payload;
+	while ( payload.length() < 4096 ) {
+		payload += "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor "
+			"incididunt ut labore et dolore magna aliqua. \"Ut enim\" ad minim veniam, quis nostrud "
+			"exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat - caf\xc3\xa9\n";
+	}
+
+	const char * names[] = { "scalar", "sse2", "avx2" };
+	long n = ( records / 100 ) + 1;
+	volatile size_t sink = 0;
+
+	for ( int isa = logencoder::scalar; isa <= logencoder::isa(); isa++ ) {
+
+		char name[64];
+		double start = now();
+
+		for ( long i = 0; i < n; i++ ) {
+			sink ^= logencoder::utf8( payload.data(), payload.length(), (logencoder::isa_t) isa );
+		}
+
+		snprintf( name, sizeof( name ), "logencoder_utf8_4k_%s", names[isa] );
+		report( name, 1, n, now() - start );
+
+		start = now();
+
+		for ( long i = 0; i < n; i++ ) {
+			for ( size_t pos = 0; pos < payload.length(); pos++ ) {
+				pos += logencoder::scan( payload.data() + pos, payload.length() - pos, (logencoder::isa_t) isa );
+				sink ^= pos;
+			}
+		}
+
+		snprintf( name, sizeof( name ), "logencoder_scan_4k_%s", names[isa] );
+		report( name, 1, n, now() - start );
+
+	}
+
+	std::string out;
+	double start = now();
+
+	for ( long i = 0; i < n; i++ ) {
+		out.clear();
+		logencoder::escape( out, payload.data(), payload.length() );
+	}
+
+	report( "logencoder_escape_4k", 1, n, now() - start );
+
+}
+
+
+/** timestamp formatting */
+static void bench_logstamp() {
+
+	logstamp stamp;
+	char buffer[logstamp::size];
+	volatile char sink = 0;
+
+	double start = now();
+	for ( long i = 0; i < records; i++ ) {
+		stamp.now( buffer );
+		sink ^= buffer[logstamp::size - 1];
+	}
+
+	report( "logstamp_now", 1, records, now() - start );
+
+}
+
+
+/** per thread arguments for the multi-thread benchmark */
+struct bench_thread_t {
+	sharedlogstream * logger;
+	long n;
+};
+
+
+static void * bench_thread( void * arg ) {
+
+	bench_thread_t * t = (bench_thread_t *) arg;
+
+	for ( long i = 0; i < t->n; i++ ) {
+		LOGSTREAMXX_INFO( *t->logger ) << "benchmark record " << i << " value " << 3.14159 << std::endl;
+	}
+
+	return 0;
+
+}
+
+
+/** get the next thread count, doubling up to and including the maximum */
+static long next_threads( long n ) {
+
+	if ( ( n < threads ) && ( ( n * 2 ) > threads ) ) {
+		return threads;
+	}
+
+	return n * 2;
+
+}
+
+
+/** multi-thread scaling */
+static void bench_threads( const char * name, bool async ) {
+
+	for ( long nthreads = 1; nthreads <= threads; nthreads = next_threads( nthreads ) ) {
+
+		sharedlogstream * logger;
+		if ( async ) {
+			logger = new sharedlogstream( "/dev/null", logwriter::block );
+		} else {
+			logger = new sharedlogstream( "/dev/null" );
+		}
+
+		logger->loglevel( priority::info );
+
+		pthread_t * tids = new pthread_t[nthreads];
+		bench_thread_t t = { logger, records / nthreads };
+
+		double start = now();
+		for ( long i = 0; i < nthreads; i++ ) {
+			pthread_create( &tids[i], 0, &bench_thread, &t );
+		}
+
+		for ( long i = 0; i < nthreads; i++ ) {
+			pthread_join( tids[i], 0 );
+		}
+
+		delete logger;
+		report( name, nthreads, t.n * nthreads, now() - start );
+
+		delete [] tids;
+
+	}
+
+}
+
+
+int main( int argc, char * argv[] ) {
+
+	int opt;
+	while ( ( opt = getopt( argc, argv, "n:t:d:" ) ) != -1 ) {
+		switch ( opt ) {
+
+			case 'n':
+				records = atol( optarg );
+				break;
+
+			case 't':
+				threads = atol( optarg );
+				break;
+
+			case 'd':
+				tmpdir = optarg;
+				break;
+
+			default:
+				fprintf( stderr, "Usage: %s [-n records] [-t max threads] [-d tmpfs directory]\n", argv[0] );
+				return 1;
+
+		}
+	}
+
+	// sanity checks
+	if ( records <= 0 ) {
+		records = 1000000;
+	}
+
+	if ( threads <= 0 ) {
+		threads = sysconf( _SC_NPROCESSORS_ONLN );
+		if ( threads <= 0 ) {
+			threads = 1;
+		}
+	}
+
+	if ( tmpdir.empty() ) {
+		tmpdir = ( access( "/dev/shm", W_OK ) == 0 ) ? "/dev/shm" : "/tmp";
+	}
+
+	// temporary log file
+	std::string filename = tmpdir + "/logstreamxx-bench.XXXXXX";
+	int fd = mkstemp( &filename[0] );
+	if ( fd == -1 ) {
+		perror( filename.c_str() );
+		return 1;
+	}
+
+	close( fd );
+
+	bench_logstamp();
+	bench_logencoder();
+	bench_disabled();
+	bench_logstream( "logstream_devnull", "/dev/null", false );
+	bench_numbers();
+#if __cplusplus >= 201103L
+	bench_format();
+#endif
+	bench_logstream( "logstream_tmpfs", filename.c_str(), false );
+	bench_logstream( "logstream_batched_devnull", "/dev/null", false, 65536 );
+	bench_logstream( "logstream_batched_tmpfs", filename.c_str(), false, 65536 );
+	bench_logstream( "logstream_async_devnull", "/dev/null", true );
+	bench_logstream( "logstream_async_tmpfs", filename.c_str(), true );
+	bench_logmmap( filename.c_str() );
+	bench_logrecorder();
+	bench_threads( "sharedlogstream_devnull", false );
+	bench_threads( "sharedlogstream_async_devnull", true );
+
+	unlink( filename.c_str() );
+
+	return 0;
+
+}
+
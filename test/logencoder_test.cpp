@@ -0,0 +1,334 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logencoder_test.h"
+
+#include <logstreamxx/logencoder.h>
+
+#include <climits>
+#include <cstdlib>
+#include <string>
+
+
+// register the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( logencoder_test );
+
+// use namespace logstreamxx
+using namespace logstreamxx;
+
+
+// buffer sizes to cover the vector loops and the scalar tails
+static const size_t sizes[] = { 0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 4096 };
+
+
+static std::string escaped( const std::string &s ) {
+
+	std::string out;
+	logencoder::escape( out, s.data(), s.length() );
+
+	return out;
+
+}
+
+
+void logencoder_test::test_escape() {
+
+	// assert - copied as is
+	CPPUNIT_ASSERT( escaped( "" ) == "" );
+	CPPUNIT_ASSERT( escaped( "plain text" ) == "plain text" );
+	CPPUNIT_ASSERT( escaped( "caf\xc3\xa9" ) == "caf\xc3\xa9" );
+
+	// assert - escaped
+	CPPUNIT_ASSERT( escaped( "say \"hi\"" ) == "say \\\"hi\\\"" );
+	CPPUNIT_ASSERT( escaped( "C:\\tmp" ) == "C:\\\\tmp" );
+	CPPUNIT_ASSERT( escaped( "a\nb\tc\r" ) == "a\\nb\\tc\\r" );
+	CPPUNIT_ASSERT( escaped( "\"" ) == "\\\"" );
+
+	// assert - appended
+	std::string out = "x=";
+	logencoder::escape( out, "\"y\"", 3 );
+	CPPUNIT_ASSERT( out == "x=\\\"y\\\"" );
+
+}
+
+
+void logencoder_test::test_escape_control() {
+
+	// assert
+	CPPUNIT_ASSERT( escaped( std::string( "\0", 1 ) ) == "\\u0000" );
+	CPPUNIT_ASSERT( escaped( "\x1b[0m" ) == "\\u001b[0m" );
+	CPPUNIT_ASSERT( escaped( "\x7f" ) == "\\u007f" );
+	CPPUNIT_ASSERT( escaped( "\b\f" ) == "\\b\\f" );
+
+}
+
+
+void logencoder_test::test_escape_utf8() {
+
+	// assert - valid sequences copied as is
+	CPPUNIT_ASSERT( escaped( "\xe2\x82\xac \xf0\x9f\x98\x80" ) == "\xe2\x82\xac \xf0\x9f\x98\x80" );
+
+	// assert - invalid bytes replaced
+	CPPUNIT_ASSERT( escaped( "a\xff" "b" ) == "a\\ufffdb" );
+	CPPUNIT_ASSERT( escaped( "\xc0\xaf" ) == "\\ufffd\\ufffd" );
+	CPPUNIT_ASSERT( escaped( "\xed\xa0\x80" ) == "\\ufffd\\ufffd\\ufffd" );
+	CPPUNIT_ASSERT( escaped( "end \xe2\x82" ) == "end \\ufffd\\ufffd" );
+
+	// assert - escapes past the vector loops
+	std::string s( 100, 'x' );
+	s[70] = '"';
+	s[99] = '\n';
+
+	std::string expected( 100, 'x' );
+	expected.replace( 99, 1, "\\n" );
+	expected.replace( 70, 1, "\\\"" );
+
+	CPPUNIT_ASSERT( escaped( s ) == expected );
+
+}
+
+
+void logencoder_test::test_quote() {
+
+	// assert - bare values
+	CPPUNIT_ASSERT(! logencoder::quote( "value", 5 ) );
+	CPPUNIT_ASSERT(! logencoder::quote( "/path/to-file.log", 17 ) );
+	CPPUNIT_ASSERT(! logencoder::quote( "caf\xc3\xa9", 5 ) );
+
+	// assert - quoted values
+	CPPUNIT_ASSERT( logencoder::quote( "", 0 ) );
+	CPPUNIT_ASSERT( logencoder::quote( "two words", 9 ) );
+	CPPUNIT_ASSERT( logencoder::quote( "a=b", 3 ) );
+	CPPUNIT_ASSERT( logencoder::quote( "\"a\"", 3 ) );
+	CPPUNIT_ASSERT( logencoder::quote( "a\\b", 3 ) );
+	CPPUNIT_ASSERT( logencoder::quote( "a\nb", 3 ) );
+
+}
+
+
+void logencoder_test::test_integer() {
+
+	std::string out;
+
+	logencoder::integer( out, 0LL );
+	out += ' ';
+	logencoder::integer( out, -42LL );
+	out += ' ';
+	logencoder::integer( out, (long long) LLONG_MIN );
+	out += ' ';
+	logencoder::integer( out, (unsigned long long) ULLONG_MAX );
+
+	// assert
+	CPPUNIT_ASSERT( out == "0 -42 -9223372036854775808 18446744073709551615" );
+
+}
+
+
+void logencoder_test::test_real() {
+
+	std::string out;
+
+	logencoder::real( out, 1.5 );
+	CPPUNIT_ASSERT( out == "1.5" );
+
+	out.clear();
+	logencoder::real( out, -0.25 );
+	CPPUNIT_ASSERT( out == "-0.25" );
+
+	// assert - non-finite values
+	out.clear();
+	logencoder::real( out, strtod( "inf", 0 ) );
+	CPPUNIT_ASSERT( out == "null" );
+
+	out.clear();
+	logencoder::real( out, strtod( "nan", 0 ) );
+	CPPUNIT_ASSERT( out == "null" );
+
+	// assert - round trip
+	double values[] = { 0.1, 1.0 / 3.0, 2.2250738585072014e-308, 1e300, 123456789.123456789 };
+
+	for ( size_t i = 0; i < ( sizeof( values ) / sizeof( values[0] ) ); i++ ) {
+		out.clear();
+		logencoder::real( out, values[i] );
+		CPPUNIT_ASSERT( strtod( out.c_str(), 0 ) == values[i] );
+	}
+
+}
+
+
+void logencoder_test::test_scan() {
+
+	// assert
+	CPPUNIT_ASSERT( logencoder::scan( "", 0, logencoder::scalar ) == 0 );
+	CPPUNIT_ASSERT( logencoder::scan( "plain", 5, logencoder::scalar ) == 5 );
+	CPPUNIT_ASSERT( logencoder::scan( "a\"b", 3, logencoder::scalar ) == 1 );
+	CPPUNIT_ASSERT( logencoder::scan( "ab\\", 3, logencoder::scalar ) == 2 );
+	CPPUNIT_ASSERT( logencoder::scan( "\x7f", 1, logencoder::scalar ) == 0 );
+	CPPUNIT_ASSERT( logencoder::scan( "caf\xc3\xa9", 5, logencoder::scalar ) == 3 );
+
+	// assert - best supported instruction set
+	CPPUNIT_ASSERT( logencoder::isa() == logencoder::isa() );
+	CPPUNIT_ASSERT( logencoder::isa() <= logencoder::avx2 );
+
+}
+
+
+void logencoder_test::test_scan_isa() {
+
+	// differential test, the vector kernels should agree with the scalar
+	// kernel for every interesting byte at every position
+	const unsigned char specials[] = { 0x00, 0x1f, 0x20, '"', '\\', 0x7e, 0x7f, 0x80, 0xc3, 0xff };
+	const logencoder::isa_t isas[] = { logencoder::sse2, logencoder::avx2 };
+
+	for ( size_t s = 0; s < ( sizeof( sizes ) / sizeof( sizes[0] ) ); s++ ) {
+
+		std::string data( sizes[s], 'a' );
+
+		for ( size_t pos = 0; pos < data.length(); pos += ( data.length() > 100 ) ? 61 : 1 ) {
+			for ( size_t c = 0; c < sizeof( specials ); c++ ) {
+
+				data[pos] = specials[c];
+
+				size_t expected = logencoder::scan( data.data(), data.length(), logencoder::scalar );
+				CPPUNIT_ASSERT( expected == ( ( specials[c] == 0x20 || specials[c] == 0x7e ) ? data.length() : pos ) );
+
+				for ( size_t i = 0; i < 2; i++ ) {
+					CPPUNIT_ASSERT( logencoder::scan( data.data(), data.length(), isas[i] ) == expected );
+				}
+
+				data[pos] = 'a';
+
+			}
+		}
+
+	}
+
+	// random data
+	srand( 42 );
+
+	for ( int round = 0; round < 1000; round++ ) {
+
+		std::string data( rand() % 200, 'a' );
+		for ( size_t i = 0; i < data.length(); i++ ) {
+			data[i] = ( ( rand() % 8 ) == 0 ) ? ( rand() % 256 ) : ( 0x20 + ( rand() % 95 ) );
+		}
+
+		size_t expected = logencoder::scan( data.data(), data.length(), logencoder::scalar );
+
+		for ( size_t i = 0; i < 2; i++ ) {
+			CPPUNIT_ASSERT( logencoder::scan( data.data(), data.length(), isas[i] ) == expected );
+		}
+
+	}
+
+}
+
+
+void logencoder_test::test_utf8() {
+
+	// assert - valid
+	CPPUNIT_ASSERT( logencoder::utf8( "", 0 ) == 0 );
+	CPPUNIT_ASSERT( logencoder::utf8( "ascii", 5 ) == 5 );
+	CPPUNIT_ASSERT( logencoder::utf8( "\xc2\x80", 2 ) == 2 );
+	CPPUNIT_ASSERT( logencoder::utf8( "\xe0\xa0\x80", 3 ) == 3 );
+	CPPUNIT_ASSERT( logencoder::utf8( "\xef\xbf\xbf", 3 ) == 3 );
+	CPPUNIT_ASSERT( logencoder::utf8( "\xf0\x90\x80\x80", 4 ) == 4 );
+	CPPUNIT_ASSERT( logencoder::utf8( "\xf4\x8f\xbf\xbf", 4 ) == 4 );
+
+	// assert - invalid
+	CPPUNIT_ASSERT( logencoder::utf8( "ab\x80", 3 ) == 2 );         // stray continuation byte
+	CPPUNIT_ASSERT( logencoder::utf8( "\xc1\xbf", 2 ) == 0 );       // overlong
+	CPPUNIT_ASSERT( logencoder::utf8( "\xe0\x9f\xbf", 3 ) == 0 );   // overlong
+	CPPUNIT_ASSERT( logencoder::utf8( "\xf0\x8f\xbf\xbf", 4 ) == 0 );   // overlong
+	CPPUNIT_ASSERT( logencoder::utf8( "\xed\xa0\x80", 3 ) == 0 );   // surrogate
+	CPPUNIT_ASSERT( logencoder::utf8( "\xf4\x90\x80\x80", 4 ) == 0 );   // above U+10FFFF
+	CPPUNIT_ASSERT( logencoder::utf8( "\xf5\x80\x80\x80", 4 ) == 0 );
+	CPPUNIT_ASSERT( logencoder::utf8( "a\xe2\x82", 3 ) == 1 );      // truncated
+	CPPUNIT_ASSERT( logencoder::utf8( "\xe2\x28\xa1", 3 ) == 0 );
+
+}
+
+
+void logencoder_test::test_utf8_isa() {
+
+	const logencoder::isa_t isas[] = { logencoder::sse2, logencoder::avx2 };
+	const char * sequences[] = { "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\x80", "\xc3", "\xed\xa0\x80" };
+
+	// differential test, multi-byte sequences at every position
+	for ( size_t s = 0; s < ( sizeof( sizes ) / sizeof( sizes[0] ) ); s++ ) {
+		for ( size_t pos = 0; pos < sizes[s]; pos += ( sizes[s] > 100 ) ? 61 : 1 ) {
+			for ( size_t q = 0; q < ( sizeof( sequences ) / sizeof( sequences[0] ) ); q++ ) {
+
+				std::string data( sizes[s], 'a' );
+				data.insert( pos, sequences[q] );
+
+				size_t expected = logencoder::utf8( data.data(), data.length(), logencoder::scalar );
+				CPPUNIT_ASSERT( expected == ( ( q < 3 ) ? data.length() : pos ) );
+
+				for ( size_t i = 0; i < 2; i++ ) {
+					CPPUNIT_ASSERT( logencoder::utf8( data.data(), data.length(), isas[i] ) == expected );
+				}
+
+			}
+		}
+	}
+
+	// random data
+	srand( 42 );
+
+	for ( int round = 0; round < 1000; round++ ) {
+
+		std::string data;
+		size_t n = rand() % 40;
+
+		for ( size_t i = 0; i < n; i++ ) {
+			if ( ( rand() % 50 ) == 0 ) {
+				data += (char) ( rand() % 256 );
+			} else if ( ( rand() % 4 ) == 0 ) {
+				data += sequences[rand() % 3];
+			} else {
+				data.append( rand() % 8, 'x' );
+			}
+		}
+
+		size_t expected = logencoder::utf8( data.data(), data.length(), logencoder::scalar );
+
+		for ( size_t i = 0; i < 2; i++ ) {
+			CPPUNIT_ASSERT( logencoder::utf8( data.data(), data.length(), isas[i] ) == expected );
+		}
+
+	}
+
+}
+
+
+void logencoder_test::test_incomplete() {
+
+	// assert
+	CPPUNIT_ASSERT( logencoder::incomplete( "", 0 ) == 0 );
+	CPPUNIT_ASSERT( logencoder::incomplete( "abc", 3 ) == 0 );
+	CPPUNIT_ASSERT( logencoder::incomplete( "a\xc3\xa9", 3 ) == 0 );
+	CPPUNIT_ASSERT( logencoder::incomplete( "a\xc3", 2 ) == 1 );
+	CPPUNIT_ASSERT( logencoder::incomplete( "a\xe2\x82", 3 ) == 2 );
+	CPPUNIT_ASSERT( logencoder::incomplete( "\xf0\x9f\x98", 3 ) == 3 );
+	CPPUNIT_ASSERT( logencoder::incomplete( "\xf0\x9f\x98\x80", 4 ) == 0 );
+	CPPUNIT_ASSERT( logencoder::incomplete( "a\x80", 2 ) == 0 );
+
+}
+
@@ -0,0 +1,60 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGENCODER_TEST_H
+#define LOGENCODER_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+
+class logencoder_test : public CppUnit::TestFixture {
+
+	// setup the test suite
+	CPPUNIT_TEST_SUITE( logencoder_test );
+	CPPUNIT_TEST( test_escape );
+	CPPUNIT_TEST( test_escape_control );
+	CPPUNIT_TEST( test_escape_utf8 );
+	CPPUNIT_TEST( test_quote );
+	CPPUNIT_TEST( test_integer );
+	CPPUNIT_TEST( test_real );
+	CPPUNIT_TEST( test_scan );
+	CPPUNIT_TEST( test_scan_isa );
+	CPPUNIT_TEST( test_utf8 );
+	CPPUNIT_TEST( test_utf8_isa );
+	CPPUNIT_TEST( test_incomplete );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+
+	void test_escape();
+	void test_escape_control();
+	void test_escape_utf8();
+	void test_quote();
+	void test_integer();
+	void test_real();
+	void test_scan();
+	void test_scan_isa();
+	void test_utf8();
+	void test_utf8_isa();
+	void test_incomplete();
+
+};
+
+#endif
+
@@ -0,0 +1,156 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logflightrecorder_test.h"
+
+#include <logstreamxx/logflightrecorder.h>
+#include <logstreamxx/logmemsink.h>
+#include <logstreamxx/logstream.h>
+
+#include <cstring>
+
+
+// register the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( logflightrecorder_test );
+
+// use namespace logstreamxx
+using namespace logstreamxx;
+
+
+// write a single part log record to a log sink
+static bool wrecord( logsink &sink, const priority::log_priority_t &p, const char * record ) {
+
+	iovec iov;
+	iov.iov_base = (void *) record;
+	iov.iov_len  = strlen( record );
+
+	return sink.write( p, &iov, 1 );
+
+}
+
+
+void logflightrecorder_test::test_constructor_fail() {
+
+	logmemsink mem;
+
+	// these will throw invalid argument exceptions
+	CPPUNIT_ASSERT_THROW( logflightrecorder recorder( 0 ), logexception );
+	CPPUNIT_ASSERT_THROW( logflightrecorder recorder( &mem, 4 ), logexception );
+
+}
+
+
+void logflightrecorder_test::test_trigger() {
+
+	logmemsink mem;
+	mem.setlogmask( priority::mask::emerg | priority::mask::err | priority::mask::info );
+
+	logflightrecorder recorder( &mem );
+
+	wrecord( recorder, priority::debug, "debug 1\n" );
+	wrecord( recorder, priority::info, "info\n" );
+	wrecord( recorder, priority::debug, "debug 2\n" );
+
+	// assert - masked records recorded
+	CPPUNIT_ASSERT( "info\n" == mem.str() );
+	CPPUNIT_ASSERT( recorder.length() > 0 );
+
+	wrecord( recorder, priority::err, "error\n" );
+
+	// assert - recorded history written out ahead of the trigger record
+	CPPUNIT_ASSERT( "info\ndebug 1\ndebug 2\nerror\n" == mem.str() );
+	CPPUNIT_ASSERT( recorder.length() == 0 );
+
+}
+
+
+void logflightrecorder_test::test_wrap() {
+
+	logmemsink mem;
+	mem.setlogmask( priority::mask::emerg );
+
+	// room for two records ( 5 byte header + 7 byte record )
+	logflightrecorder recorder( &mem, 30 );
+
+	wrecord( recorder, priority::debug, "line 1\n" );
+	wrecord( recorder, priority::debug, "line 2\n" );
+	wrecord( recorder, priority::debug, "line 3\n" );
+	wrecord( recorder, priority::debug, "line 4\n" );
+	wrecord( recorder, priority::debug, "line 5\n" );
+
+	// assert - oldest records discarded as a whole
+	CPPUNIT_ASSERT( recorder.length() == 24 );
+	CPPUNIT_ASSERT( recorder.dump() );
+	CPPUNIT_ASSERT( "line 4\nline 5\n" == mem.str() );
+
+	// assert - records larger than the ring are not recorded
+	wrecord( recorder, priority::debug, "a log record too large for the ring\n" );
+	CPPUNIT_ASSERT( recorder.length() == 0 );
+
+}
+
+
+void logflightrecorder_test::test_dump() {
+
+	logmemsink mem;
+	mem.setlogmask( priority::mask::emerg );
+
+	logflightrecorder recorder( &mem, 1024, priority::emerg );
+
+	wrecord( recorder, priority::err, "error\n" );
+	wrecord( recorder, priority::debug, "debug\n" );
+
+	// assert - nothing written out until dumped
+	CPPUNIT_ASSERT( mem.str().empty() );
+	CPPUNIT_ASSERT( recorder.dump() );
+	CPPUNIT_ASSERT( "error\ndebug\n" == mem.str() );
+
+	// assert - cleared history
+	mem.clear();
+	wrecord( recorder, priority::debug, "debug\n" );
+	recorder.clear();
+
+	CPPUNIT_ASSERT( recorder.dump() );
+	CPPUNIT_ASSERT( mem.str().empty() );
+
+}
+
+
+void logflightrecorder_test::test_logstream() {
+
+	logmemsink mem;
+	mem.setlogmask( priority::mask::emerg | priority::mask::err );
+
+	logflightrecorder recorder( &mem );
+
+	{
+		logstream logger( &recorder );
+		logger.loglevel( priority::debug );
+
+		logger << priority::debug << "context " << 42 << std::endl;
+		logger << priority::err << "failure" << std::endl;
+	}
+
+	// assert
+	std::string data = mem.str();
+	CPPUNIT_ASSERT( data.find( " [DEBG] context 42\n" ) == 22 );
+	CPPUNIT_ASSERT( data.find( " [EROR] failure\n" ) != std::string::npos );
+
+}
+
@@ -0,0 +1,48 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGFLIGHTRECORDER_TEST_H
+#define LOGFLIGHTRECORDER_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+
+class logflightrecorder_test : public CppUnit::TestFixture {
+
+	// setup the test suite
+	CPPUNIT_TEST_SUITE( logflightrecorder_test );
+	CPPUNIT_TEST( test_constructor_fail );
+	CPPUNIT_TEST( test_trigger );
+	CPPUNIT_TEST( test_wrap );
+	CPPUNIT_TEST( test_dump );
+	CPPUNIT_TEST( test_logstream );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+
+	void test_constructor_fail();
+	void test_trigger();
+	void test_wrap();
+	void test_dump();
+	void test_logstream();
+
+};
+
+#endif
+
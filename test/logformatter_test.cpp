@@ -0,0 +1,237 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logformatter_test.h"
+
+#include <logstreamxx/logmacros.h>
+#include <logstreamxx/logfield.h>
+#include <logstreamxx/logmemsink.h>
+
+#include <cstring>
+#include <ostream>
+#include <string>
+
+
+// register the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( logformatter_test );
+
+// use namespace logstreamxx
+using namespace logstreamxx;
+
+
+#if __cplusplus >= 201103L
+
+// type with an output stream operator
+struct point_t {
+	int x;
+	int y;
+};
+
+static std::ostream &operator <<( std::ostream &os, const point_t &p ) {
+	return os << "(" << p.x << "," << p.y << ")";
+}
+
+
+// evaluation counter helper
+static int evaluated = 0;
+
+static int evaluate() {
+	return ++evaluated;
+}
+
+
+// log message without the timestamp and priority prefix
+static std::string message( const std::string &record ) {
+
+	// sanity check
+	if ( record.length() < ( logstamp::size + 8 ) ) {
+		return record;
+	}
+
+	return record.substr( logstamp::size + 8 );
+
+}
+
+
+void logformatter_test::test_placeholders() {
+
+	// assert - counted at compile time
+	static_assert( logformatter::placeholders( "", 0, 0 ) == 0, "empty" );
+	static_assert( logformatter::placeholders( "{} {}", 0, 5 ) == 2, "two" );
+
+	// assert
+	CPPUNIT_ASSERT( logformatter::placeholders( "no placeholders", 0, 15 ) == 0 );
+	CPPUNIT_ASSERT( logformatter::placeholders( "{}", 0, 2 ) == 1 );
+	CPPUNIT_ASSERT( logformatter::placeholders( "a{}b{}c{}", 0, 9 ) == 3 );
+	CPPUNIT_ASSERT( logformatter::placeholders( "{{}}", 0, 4 ) == 0 );
+	CPPUNIT_ASSERT( logformatter::placeholders( "{{{}}}", 0, 6 ) == 1 );
+
+	// assert - invalid
+	CPPUNIT_ASSERT( logformatter::placeholders( "{", 0, 1 ) < 0 );
+	CPPUNIT_ASSERT( logformatter::placeholders( "a } b", 0, 5 ) < 0 );
+	CPPUNIT_ASSERT( logformatter::placeholders( "{x}", 0, 3 ) < 0 );
+	CPPUNIT_ASSERT( logformatter::placeholders( "{} {", 0, 4 ) < 0 );
+
+	// assert - brace search
+	CPPUNIT_ASSERT( logformatter::find( "abc{}", 0, 5 ) == 3 );
+	CPPUNIT_ASSERT( logformatter::find( "abc{}", 4, 5 ) == 4 );
+	CPPUNIT_ASSERT( logformatter::find( "abcde", 0, 5 ) == 5 );
+
+}
+
+
+void logformatter_test::test_logf() {
+
+	logmemsink sink;
+	logstream logger( &sink );
+	logger.loglevel( priority::debug );
+
+	logger.logf( priority::info, LOGSTREAMXX_FMT( "user {} took {}ms" ), 42, 3.25 );
+
+	// assert - a whole log record
+	CPPUNIT_ASSERT( sink.str().find( " [INFO] " ) == logstamp::size );
+	CPPUNIT_ASSERT( message( sink.str() ) == "user 42 took 3.25ms\n" );
+
+	// assert - no placeholders, placeholders at both ends
+	sink.clear();
+	logger.info( LOGSTREAMXX_FMT( "started" ) );
+	CPPUNIT_ASSERT( message( sink.str() ) == "started\n" );
+
+	sink.clear();
+	logger.info( LOGSTREAMXX_FMT( "{}{}" ), 1, 2 );
+	CPPUNIT_ASSERT( message( sink.str() ) == "12\n" );
+
+	// assert - mixed with stream insertion
+	sink.clear();
+	logger << "stream " << 1 << std::endl;
+	logger.info( LOGSTREAMXX_FMT( "format {}" ), 2 );
+	logger << "stream " << 3 << std::endl;
+
+	std::string data = sink.str();
+	CPPUNIT_ASSERT( data.find( "stream 1\n" ) < data.find( "format 2\n" ) );
+	CPPUNIT_ASSERT( data.find( "format 2\n" ) < data.find( "stream 3\n" ) );
+
+}
+
+
+void logformatter_test::test_escape() {
+
+	logmemsink sink;
+	logstream logger( &sink );
+	logger.loglevel( priority::debug );
+
+	logger.info( LOGSTREAMXX_FMT( "{{}} {{{}}} }}" ), "x" );
+
+	// assert
+	CPPUNIT_ASSERT( message( sink.str() ) == "{} {x} }\n" );
+
+}
+
+
+void logformatter_test::test_types() {
+
+	logmemsink sink;
+	logstream logger( &sink );
+	logger.loglevel( priority::debug );
+
+	point_t p = { 1, -2 };
+	std::string s( "string" );
+	const char * null = 0;
+
+	logger.info( LOGSTREAMXX_FMT( "{} {} {} {} {} {} {} {} {} {} {}" ), true, false, 'c', s, "literal", null,
+			-9223372036854775807LL - 1, 18446744073709551615ULL, (short) -5, 0.1, p );
+
+	// assert
+	CPPUNIT_ASSERT( message( sink.str() ) ==
+			"true false c string literal  -9223372036854775808 18446744073709551615 -5 0.1 (1,-2)\n" );
+
+	// assert - stream format flags don't apply
+	sink.clear();
+	logger.setf( std::ios_base::hex, std::ios_base::basefield );
+	logger.info( LOGSTREAMXX_FMT( "{}" ), 255 );
+	logger.setf( std::ios_base::dec, std::ios_base::basefield );
+
+	CPPUNIT_ASSERT( message( sink.str() ) == "255\n" );
+
+	// assert - fields
+	sink.clear();
+	logger.info( LOGSTREAMXX_FMT( "request {}{}" ), 7, logfield( "status", 200 ) );
+
+	CPPUNIT_ASSERT( message( sink.str() ) == "request 7 status=200\n" );
+
+}
+
+
+void logformatter_test::test_priority() {
+
+	logmemsink sink;
+	logstream logger( &sink );
+	logger.loglevel( priority::warning );
+
+	logger.emerg( LOGSTREAMXX_FMT( "{}" ), 0 );
+	logger.alert( LOGSTREAMXX_FMT( "{}" ), 1 );
+	logger.crit( LOGSTREAMXX_FMT( "{}" ), 2 );
+	logger.err( LOGSTREAMXX_FMT( "{}" ), 3 );
+	logger.warning( LOGSTREAMXX_FMT( "{}" ), 4 );
+	logger.notice( LOGSTREAMXX_FMT( "{}" ), 5 );
+	logger.info( LOGSTREAMXX_FMT( "{}" ), 6 );
+	logger.debug( LOGSTREAMXX_FMT( "{}" ), 7 );
+
+	std::string data = sink.str();
+
+	// assert
+	CPPUNIT_ASSERT( data.find( "[EMRG] 0\n" ) != std::string::npos );
+	CPPUNIT_ASSERT( data.find( "[ALRT] 1\n" ) != std::string::npos );
+	CPPUNIT_ASSERT( data.find( "[CRIT] 2\n" ) != std::string::npos );
+	CPPUNIT_ASSERT( data.find( "[EROR] 3\n" ) != std::string::npos );
+	CPPUNIT_ASSERT( data.find( "[WARN] 4\n" ) != std::string::npos );
+	CPPUNIT_ASSERT( data.find( "[NTCE]" ) == std::string::npos );
+	CPPUNIT_ASSERT( data.find( "[INFO]" ) == std::string::npos );
+	CPPUNIT_ASSERT( data.find( "[DEBG]" ) == std::string::npos );
+
+}
+
+
+void logformatter_test::test_macros() {
+
+	logmemsink sink;
+	logstream logger( &sink );
+	logger.loglevel( priority::info );
+
+	evaluated = 0;
+
+	LOGSTREAMXX_DEBUGF( logger, "skipped {}", evaluate() );
+	LOGSTREAMXX_LOGF( logger, priority::debug, "skipped {}", evaluate() );
+
+	// assert - arguments not evaluated
+	CPPUNIT_ASSERT( 0 == evaluated );
+	CPPUNIT_ASSERT( sink.str().empty() );
+
+	LOGSTREAMXX_INFOF( logger, "evaluated {}", evaluate() );
+	LOGSTREAMXX_ERRF( logger, "no arguments" );
+
+	// assert
+	CPPUNIT_ASSERT( 1 == evaluated );
+	CPPUNIT_ASSERT( sink.str().find( "[INFO] evaluated 1\n" ) != std::string::npos );
+	CPPUNIT_ASSERT( sink.str().find( "[EROR] no arguments\n" ) != std::string::npos );
+
+}
+
+#endif /* __cplusplus >= 201103L */
+
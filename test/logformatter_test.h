@@ -0,0 +1,54 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGFORMAT_TEST_H
+#define LOGFORMAT_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+
+class logformatter_test : public CppUnit::TestFixture {
+
+	// setup the test suite
+	CPPUNIT_TEST_SUITE( logformatter_test );
+#if __cplusplus >= 201103L
+	CPPUNIT_TEST( test_placeholders );
+	CPPUNIT_TEST( test_logf );
+	CPPUNIT_TEST( test_escape );
+	CPPUNIT_TEST( test_types );
+	CPPUNIT_TEST( test_priority );
+	CPPUNIT_TEST( test_macros );
+#endif
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+
+#if __cplusplus >= 201103L
+	void test_placeholders();
+	void test_logf();
+	void test_escape();
+	void test_types();
+	void test_priority();
+	void test_macros();
+#endif
+
+};
+
+#endif
+
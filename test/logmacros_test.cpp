@@ -0,0 +1,64 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logmacros_test.h"
+
+// compile-time log level ( warning )
+#define LOGSTREAMXX_LOGLEVEL 4
+#include <logstreamxx/logmacros.h>
+
+
+// register the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( logmacros_test );
+
+// use namespace logstreamxx
+using namespace logstreamxx;
+
+
+// evaluation counter helper
+static int evaluated = 0;
+
+static int evaluate() {
+	return ++evaluated;
+}
+
+
+void logmacros_test::test_loglevel() {
+
+	// log stream with all priorities enabled at runtime
+	logstream logger( "/dev/null" );
+	logger.loglevel( priority::debug );
+
+	LOGSTREAMXX_DEBUG( logger ) << evaluate() << std::endl;
+	LOGSTREAMXX_INFO( logger ) << evaluate() << std::endl;
+	LOGSTREAMXX_NOTICE( logger ) << evaluate() << std::endl;
+	LOGSTREAMXX_LOG( logger, priority::info ) << evaluate() << std::endl;
+
+	// assert - compiled away
+	CPPUNIT_ASSERT( 0 == evaluated );
+
+	LOGSTREAMXX_WARNING( logger ) << evaluate() << std::endl;
+	LOGSTREAMXX_EMERG( logger ) << evaluate() << std::endl;
+	LOGSTREAMXX_LOG( logger, priority::err ) << evaluate() << std::endl;
+
+	// assert
+	CPPUNIT_ASSERT( 3 == evaluated );
+
+}
+
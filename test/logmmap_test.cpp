@@ -0,0 +1,150 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logmmap_test.h"
+#include "testutil.h"
+
+#include <logstreamxx/logmmap.h>
+#include <logstreamxx/logstreambuf.h>
+
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+
+// register the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( logmmap_test );
+
+// use namespace logstreamxx
+using namespace logstreamxx;
+
+
+void logmmap_test::setUp() {
+
+	// temporary log file
+	_filename = testutil::tempfile( "logmmap_test" );
+
+}
+
+
+void logmmap_test::tearDown() {
+	unlink( _filename.c_str() );
+}
+
+
+void logmmap_test::test_constructor_fail() {
+
+	// this will throw a system error exception
+	CPPUNIT_ASSERT_THROW( logmmap map( "/nonexistent/logmmap_test" ), logexception );
+
+}
+
+
+void logmmap_test::test_write() {
+
+	std::string expected;
+
+	{
+		// small chunks so records span multiple mappings
+		logmmap map( _filename.c_str(), false, 00644, 1 );
+
+		for ( int i = 0; i < 1000; i++ ) {
+
+			std::ostringstream ss;
+			ss << "record " << i;
+			std::string record = ss.str();
+
+			iovec iov[2];
+			iov[0].iov_base = (void *) record.data();
+			iov[0].iov_len  = record.length();
+			iov[1].iov_base = (void *) "\n";
+			iov[1].iov_len  = 1;
+
+			CPPUNIT_ASSERT( map.write( iov, 2 ) );
+			expected += record + "\n";
+
+		}
+
+		CPPUNIT_ASSERT( expected.length() == map.length() );
+	}
+
+	// assert - truncated to the real length on close
+	CPPUNIT_ASSERT( expected == testutil::read_all( _filename ) );
+
+}
+
+
+void logmmap_test::test_append() {
+
+	iovec iov;
+	iov.iov_base = (void *) "line\n";
+	iov.iov_len  = 5;
+
+	{
+		logmmap map( _filename.c_str() );
+		map.write( &iov, 1 );
+	}
+
+	{
+		logmmap map( _filename.c_str() );
+		map.write( &iov, 1 );
+	}
+
+	// assert
+	CPPUNIT_ASSERT( "line\nline\n" == testutil::read_all( _filename ) );
+
+	// log file left with the preallocated NUL padding ( e.g. a crash )
+	{
+		std::ofstream ofs( _filename.c_str(), std::ios::app | std::ios::binary );
+		ofs << std::string( 10000, '\0' );
+	}
+
+	{
+		logmmap map( _filename.c_str() );
+		map.write( &iov, 1 );
+	}
+
+	// assert - appended after the log data
+	CPPUNIT_ASSERT( "line\nline\nline\n" == testutil::read_all( _filename ) );
+
+}
+
+
+void logmmap_test::test_logstreambuf() {
+
+	{
+		logmmap map( _filename.c_str() );
+
+		// log stream buffer
+		logstreambuf sb( &map );
+		std::ostream os( &sb );
+
+		sb.setlogmask( priority::mask::info );
+		sb.lpriority( priority::info );
+
+		os << "message " << 42 << std::endl;
+	}
+
+	// assert - "%b %e %T.usec [INFO] message 42\n"
+	std::string content = testutil::read_all( _filename );
+	CPPUNIT_ASSERT( 22 == content.find( " [INFO] message 42\n" ) );
+	CPPUNIT_ASSERT( content.length() == 41 );
+
+}
+
@@ -0,0 +1,54 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGMMAP_TEST_H
+#define LOGMMAP_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+
+class logmmap_test : public CppUnit::TestFixture {
+
+	// setup the test suite
+	CPPUNIT_TEST_SUITE( logmmap_test );
+	CPPUNIT_TEST( test_constructor_fail );
+	CPPUNIT_TEST( test_write );
+	CPPUNIT_TEST( test_append );
+	CPPUNIT_TEST( test_logstreambuf );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+
+	void setUp();
+	void tearDown();
+
+	void test_constructor_fail();
+	void test_write();
+	void test_append();
+	void test_logstreambuf();
+
+private:
+
+	std::string _filename;
+
+};
+
+#endif
+
@@ -0,0 +1,279 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "lognumput_test.h"
+#include "testutil.h"
+
+#include <logstreamxx/lognumput.h>
+#include <logstreamxx/logstream.h>
+
+#include <climits>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+
+// register the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( lognumput_test );
+
+// use namespace logstreamxx
+using namespace logstreamxx;
+
+
+// output string streams with and without the facet, differential tests
+// compare the two with the same format flags
+struct streams_t {
+
+	streams_t() {
+		fast.imbue( std::locale( std::locale::classic(), new lognumput() ) );
+		reference.imbue( std::locale::classic() );
+	}
+
+	void flags( std::ios_base::fmtflags f, std::ios_base::fmtflags mask ) {
+		fast.setf( f, mask );
+		reference.setf( f, mask );
+	}
+
+	void precision( std::streamsize p ) {
+		fast.precision( p );
+		reference.precision( p );
+	}
+
+	template<typename T> bool same( T v ) {
+
+		fast.str( "" );
+		reference.str( "" );
+
+		fast << v;
+		reference << v;
+
+		return fast.str() == reference.str();
+
+	}
+
+	std::ostringstream fast;
+	std::ostringstream reference;
+
+};
+
+
+void lognumput_test::test_utoa() {
+
+	char buffer[24];
+	char * end = buffer + sizeof( buffer );
+
+	// assert
+	CPPUNIT_ASSERT( std::string( lognumput::utoa( end, 0 ), end ) == "0" );
+	CPPUNIT_ASSERT( std::string( lognumput::utoa( end, 7 ), end ) == "7" );
+	CPPUNIT_ASSERT( std::string( lognumput::utoa( end, 42 ), end ) == "42" );
+	CPPUNIT_ASSERT( std::string( lognumput::utoa( end, 100 ), end ) == "100" );
+	CPPUNIT_ASSERT( std::string( lognumput::utoa( end, 1234567 ), end ) == "1234567" );
+	CPPUNIT_ASSERT( std::string( lognumput::utoa( end, ULLONG_MAX ), end ) == "18446744073709551615" );
+
+}
+
+
+void lognumput_test::test_integers() {
+
+	streams_t s;
+
+	// assert - limits
+	CPPUNIT_ASSERT( s.same( 0 ) );
+	CPPUNIT_ASSERT( s.same( INT_MIN ) );
+	CPPUNIT_ASSERT( s.same( INT_MAX ) );
+	CPPUNIT_ASSERT( s.same( UINT_MAX ) );
+	CPPUNIT_ASSERT( s.same( LONG_MIN ) );
+	CPPUNIT_ASSERT( s.same( LONG_MAX ) );
+	CPPUNIT_ASSERT( s.same( ULONG_MAX ) );
+	CPPUNIT_ASSERT( s.same( LLONG_MIN ) );
+	CPPUNIT_ASSERT( s.same( ULLONG_MAX ) );
+	CPPUNIT_ASSERT( s.same( (short) -12345 ) );
+
+	// assert - powers of ten and neighbours
+	for ( unsigned long long p = 1; p < ( ULLONG_MAX / 10 ); p *= 10 ) {
+		CPPUNIT_ASSERT( s.same( p - 1 ) );
+		CPPUNIT_ASSERT( s.same( p ) );
+		CPPUNIT_ASSERT( s.same( -(long long) p ) );
+	}
+
+	// assert - random values
+	srand( 42 );
+
+	for ( int i = 0; i < 10000; i++ ) {
+		long long v = ( (long long) rand() << 32 ) ^ rand();
+		CPPUNIT_ASSERT( s.same( v >> ( rand() % 63 ) ) );
+	}
+
+}
+
+
+void lognumput_test::test_integers_base() {
+
+	streams_t s;
+	const long values[] = { 0, 1, 8, 15, 16, 24, 255, -1, -24, LONG_MIN, LONG_MAX };
+
+	s.flags( std::ios_base::hex, std::ios_base::basefield );
+
+	for ( size_t i = 0; i < ( sizeof( values ) / sizeof( values[0] ) ); i++ ) {
+		CPPUNIT_ASSERT( s.same( values[i] ) );
+		CPPUNIT_ASSERT( s.same( (int) values[i] ) );
+		CPPUNIT_ASSERT( s.same( (long long) values[i] ) );
+	}
+
+	s.flags( std::ios_base::uppercase, std::ios_base::uppercase );
+
+	for ( size_t i = 0; i < ( sizeof( values ) / sizeof( values[0] ) ); i++ ) {
+		CPPUNIT_ASSERT( s.same( values[i] ) );
+	}
+
+	s.flags( std::ios_base::oct, std::ios_base::basefield );
+
+	for ( size_t i = 0; i < ( sizeof( values ) / sizeof( values[0] ) ); i++ ) {
+		CPPUNIT_ASSERT( s.same( values[i] ) );
+		CPPUNIT_ASSERT( s.same( (int) values[i] ) );
+		CPPUNIT_ASSERT( s.same( (unsigned long long) values[i] ) );
+	}
+
+	// assert - README example
+	std::ostringstream os;
+	os.imbue( std::locale( std::locale::classic(), new lognumput() ) );
+	os << std::hex << 24 << " " << std::oct << 24 << " " << std::dec << 24;
+
+	CPPUNIT_ASSERT( os.str() == "18 30 24" );
+
+}
+
+
+void lognumput_test::test_integers_fallback() {
+
+	streams_t s;
+
+	s.flags( std::ios_base::showpos, std::ios_base::showpos );
+	CPPUNIT_ASSERT( s.same( 42 ) );
+
+	s.flags( std::ios_base::hex | std::ios_base::showbase, std::ios_base::basefield | std::ios_base::showpos | std::ios_base::showbase );
+	CPPUNIT_ASSERT( s.same( 42 ) );
+
+	// assert - field width and fill
+	std::ostringstream os;
+	os.imbue( std::locale( std::locale::classic(), new lognumput() ) );
+	os << std::setw( 6 ) << std::setfill( '0' ) << 42 << "|" << 42;
+
+	CPPUNIT_ASSERT( os.str() == "000042|42" );
+
+}
+
+
+void lognumput_test::test_doubles() {
+
+	streams_t s;
+	const double values[] = {
+		0.0, -0.0, 1.0, -1.0, 0.5, 3.14159, 3.141592653589793, 0.1, 0.3, 0.1 + 0.2, 1e-4, 1e-5,
+		0.00012345, 123456.0, 999999.0, 999999.5, 1e6, 1234567.0, 1e15, 1e16, 1e300, 5e-324,
+		2.5e-10, 100.25, -42.125, 1.0 / 3.0, 2.0 / 3.0, 9007199254740993.0
+	};
+
+	const int precisions[] = { 6, 0, 1, 3, 10, 15, 16 };
+
+	for ( size_t p = 0; p < ( sizeof( precisions ) / sizeof( precisions[0] ) ); p++ ) {
+
+		s.precision( precisions[p] );
+
+		for ( size_t i = 0; i < ( sizeof( values ) / sizeof( values[0] ) ); i++ ) {
+			CPPUNIT_ASSERT( s.same( values[i] ) );
+		}
+
+	}
+
+	// assert - random values
+	s.precision( 6 );
+	srand( 42 );
+
+	for ( int i = 0; i < 10000; i++ ) {
+
+		double v = ( rand() - ( RAND_MAX / 2 ) ) / (double) ( 1 << ( rand() % 30 ) );
+		CPPUNIT_ASSERT( s.same( v ) );
+		CPPUNIT_ASSERT( s.same( ( rand() % 100000 ) / 100.0 ) );
+
+	}
+
+	// assert - non-finite values and other formats fall back
+	CPPUNIT_ASSERT( s.same( strtod( "inf", 0 ) ) );
+	CPPUNIT_ASSERT( s.same( strtod( "-nan", 0 ) ) );
+
+	s.flags( std::ios_base::fixed, std::ios_base::floatfield );
+	CPPUNIT_ASSERT( s.same( 3.14159 ) );
+
+	s.flags( std::ios_base::scientific | std::ios_base::uppercase, std::ios_base::floatfield | std::ios_base::uppercase );
+	CPPUNIT_ASSERT( s.same( 3.14159 ) );
+
+}
+
+
+void lognumput_test::test_doubles_shortest() {
+
+	char buffer[32];
+
+	// assert - shortest round trip
+	CPPUNIT_ASSERT( std::string( buffer, lognumput::dtoa( buffer, 0.1, 17 ) ) == "0.1" );
+	CPPUNIT_ASSERT( std::string( buffer, lognumput::dtoa( buffer, 0.1 + 0.2, 17 ) ) == "0.30000000000000004" );
+	CPPUNIT_ASSERT( std::string( buffer, lognumput::dtoa( buffer, 1e22, 17 ) ) == "1e+22" );
+	CPPUNIT_ASSERT( std::string( buffer, lognumput::dtoa( buffer, -2.5, 17 ) ) == "-2.5" );
+
+	// assert - random values read back
+	srand( 42 );
+
+	for ( int i = 0; i < 10000; i++ ) {
+
+		double v = ( (double) rand() / rand() ) * ( ( rand() % 2 ) ? 1e-3 : 1e5 );
+		size_t n = lognumput::dtoa( buffer, v, 17 );
+		buffer[n] = 0;
+
+		CPPUNIT_ASSERT( strtod( buffer, 0 ) == v );
+
+	}
+
+}
+
+
+void lognumput_test::test_logstream() {
+
+	std::string filename = testutil::tempfile( "lognumput_test" );
+
+	{
+		logstream logger( filename.c_str(), false );
+		logger.loglevel( priority::debug );
+
+		logger << "24 in hex: " << std::hex << 24 << std::endl;
+		logger << "24 in oct: " << std::oct << 24 << std::endl;
+		logger << "" << std::dec << -7 << " " << 2.5 << " " << 1234567u << std::endl;
+	}
+
+	std::string data = testutil::read_all( filename );
+	unlink( filename.c_str() );
+
+	// assert
+	CPPUNIT_ASSERT( data.find( "] 24 in hex: 18\n" ) != std::string::npos );
+	CPPUNIT_ASSERT( data.find( "] 24 in oct: 30\n" ) != std::string::npos );
+	CPPUNIT_ASSERT( data.find( "] -7 2.5 1234567\n" ) != std::string::npos );
+
+}
+
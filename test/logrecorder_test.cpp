@@ -0,0 +1,250 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logrecorder_test.h"
+#include "testutil.h"
+
+#include <logstreamxx/logrecorder.h>
+#include <logstreamxx/logdecoder.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+
+// register the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( logrecorder_test );
+
+// use namespace logstreamxx
+using namespace logstreamxx;
+
+
+void logrecorder_test::setUp() {
+
+	// temporary log file
+	_fd = testutil::tempfd( "logrecorder_test" );
+
+}
+
+
+void logrecorder_test::tearDown() {
+	close( _fd );
+}
+
+
+std::string logrecorder_test::decode() {
+
+	logdecoder decoder;
+	std::string binary = testutil::read_all( _fd );
+	std::string out;
+
+	CPPUNIT_ASSERT( binary.length() == decoder.decode( binary.data(), binary.length(), out ) );
+
+	// strip timestamps
+	std::string lines;
+	size_t pos = 0;
+
+	while ( pos < out.length() ) {
+		size_t eol = out.find( '\n', pos );
+		lines += out.substr( pos + logstamp::size, eol - pos - logstamp::size + 1 );
+		pos = eol + 1;
+	}
+
+	return lines;
+
+}
+
+
+void logrecorder_test::test_record() {
+
+	{
+		logrecorder recorder( _fd );
+		recorder.loglevel( priority::debug );
+
+		LOGSTREAMXX_RECORD( recorder, priority::info, "no arguments" );
+		LOGSTREAMXX_RECORD( recorder, priority::debug, "user %d took %dms", 42, 7 );
+
+		for ( int i = 0; i < 2; i++ ) {
+			LOGSTREAMXX_RECORD( recorder, ( i == 0 ? priority::err : priority::warning ), "loop %d", i );
+		}
+	}
+
+	// assert
+	CPPUNIT_ASSERT_EQUAL( std::string(
+			" [INFO] no arguments\n"
+			" [DEBG] user 42 took 7ms\n"
+			" [EROR] loop 0\n"
+			" [WARN] loop 1\n" ), decode() );
+
+}
+
+
+void logrecorder_test::test_format() {
+
+	{
+		logrecorder recorder( _fd );
+		recorder.loglevel( priority::debug );
+
+		std::string name = "name";
+
+		LOGSTREAMXX_RECORD( recorder, priority::info, "%s=%s %c %5.2f%% %x %#o",
+				"key", name, 'c', 3.14159, 255, 8 );
+		LOGSTREAMXX_RECORD( recorder, priority::info, "%-4d| %lu %.3s %*d",
+				-1, 123456789UL, "truncate", 3, 7 );
+		LOGSTREAMXX_RECORD( recorder, priority::info, "missing %d %s", 1 );
+		LOGSTREAMXX_RECORD( recorder, priority::info, "%s %s", 1.5, 42 );
+	}
+
+	// assert
+	CPPUNIT_ASSERT_EQUAL( std::string(
+			" [INFO] key=name c  3.14% ff 010\n"
+			" [INFO] -1  | 123456789 tru   7\n"
+			" [INFO] missing 1 %s\n"
+			" [INFO] 1.5 42\n" ), decode() );
+
+}
+
+
+void logrecorder_test::test_prefix() {
+
+	{
+		logrecorder recorder( _fd );
+
+		LOGSTREAMXX_RECORD( recorder, priority::emerg, "before" );
+		recorder.lprefix( "prefix" );
+		LOGSTREAMXX_RECORD( recorder, priority::emerg, "after" );
+	}
+
+	// assert
+	CPPUNIT_ASSERT_EQUAL( std::string(
+			" [EMRG] before\n"
+			" [EMRG] prefix after\n" ), decode() );
+
+}
+
+
+// evaluation counter helper
+static int evaluated = 0;
+
+static int evaluate() {
+	return ++evaluated;
+}
+
+
+void logrecorder_test::test_loglevel() {
+
+	{
+		logrecorder recorder( _fd );
+		recorder.loglevel( priority::notice );
+
+		LOGSTREAMXX_RECORD( recorder, priority::info, "%d", evaluate() );
+		LOGSTREAMXX_RECORD( recorder, priority::notice, "%d", evaluate() );
+	}
+
+	// assert
+	CPPUNIT_ASSERT( 1 == evaluated );
+	CPPUNIT_ASSERT_EQUAL( std::string( " [NTCE] 1\n" ), decode() );
+
+}
+
+
+void logrecorder_test::test_async() {
+
+	std::string filename = testutil::tempfile( "logrecorder_test" );
+
+	{
+		logrecorder recorder( filename.c_str() );
+
+		for ( int i = 0; i < 1000; i++ ) {
+			LOGSTREAMXX_RECORD( recorder, priority::emerg, "record %d", i );
+		}
+	}
+
+	// replace the test file
+	close( _fd );
+	_fd = open( filename.c_str(), O_RDONLY );
+	unlink( filename.c_str() );
+
+	std::string lines = decode();
+
+	// assert
+	CPPUNIT_ASSERT( lines.find( " [EMRG] record 0\n [EMRG] record 1\n" ) == 0 );
+	CPPUNIT_ASSERT( lines.find( " [EMRG] record 999\n" ) == ( lines.length() - 19 ) );
+
+}
+
+
+void logrecorder_test::test_define_retry() {
+
+	int fd = dup( _fd );
+	int null = open( "/dev/null", O_RDONLY );
+
+	{
+		logrecorder recorder( fd );
+
+		for ( int i = 0; i < 2; i++ ) {
+
+			// fail the first write of the site definition
+			dup2( ( i == 0 ? null : _fd ), fd );
+			LOGSTREAMXX_RECORD( recorder, priority::emerg, "retry %d", i );
+
+		}
+	}
+
+	close( null );
+	close( fd );
+
+	// assert
+	CPPUNIT_ASSERT_EQUAL( std::string( " [EMRG] retry 1\n" ), decode() );
+
+}
+
+
+void logrecorder_test::test_decode_partial() {
+
+	{
+		logrecorder recorder( _fd );
+		LOGSTREAMXX_RECORD( recorder, priority::emerg, "%s", "partial" );
+	}
+
+	logdecoder decoder;
+	std::string binary = testutil::read_all( _fd );
+	std::string out;
+
+	// assert - last record is not consumed until it is complete
+	size_t consumed = decoder.decode( binary.data(), binary.length() - 1, out );
+	CPPUNIT_ASSERT( consumed < binary.length() );
+	CPPUNIT_ASSERT( out.empty() );
+
+	consumed += decoder.decode( binary.data() + consumed, binary.length() - consumed, out );
+	CPPUNIT_ASSERT( consumed == binary.length() );
+	CPPUNIT_ASSERT( out.find( " [EMRG] partial\n" ) == logstamp::size );
+
+}
+
+
+void logrecorder_test::test_decode_invalid() {
+
+	logdecoder decoder;
+	std::string out;
+
+	// assert - not a binary log
+	CPPUNIT_ASSERT_THROW( decoder.decode( "plain text\n", 11, out ), logexception );
+
+}
+
@@ -0,0 +1,63 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGRECORDER_TEST_H
+#define LOGRECORDER_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+
+class logrecorder_test : public CppUnit::TestFixture {
+
+	// setup the test suite
+	CPPUNIT_TEST_SUITE( logrecorder_test );
+	CPPUNIT_TEST( test_record );
+	CPPUNIT_TEST( test_format );
+	CPPUNIT_TEST( test_prefix );
+	CPPUNIT_TEST( test_loglevel );
+	CPPUNIT_TEST( test_async );
+	CPPUNIT_TEST( test_define_retry );
+	CPPUNIT_TEST( test_decode_partial );
+	CPPUNIT_TEST( test_decode_invalid );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+
+	void setUp();
+	void tearDown();
+
+	void test_record();
+	void test_format();
+	void test_prefix();
+	void test_loglevel();
+	void test_async();
+	void test_define_retry();
+	void test_decode_partial();
+	void test_decode_invalid();
+
+private:
+
+	int _fd;
+	std::string decode();
+
+};
+
+#endif
+
@@ -0,0 +1,227 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logring_test.h"
+
+#include <logstreamxx/logring.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <pthread.h>
+
+
+// register the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( logring_test );
+
+// use namespace logstreamxx
+using namespace logstreamxx;
+
+
+static bool push( logring &ring, const char * s ) {
+
+	iovec iov;
+	iov.iov_base = (void *) s;
+	iov.iov_len  = strlen( s );
+
+	return ring.push( &iov, 1, iov.iov_len );
+
+}
+
+
+static std::string pop( logring &ring ) {
+
+	std::string buffer( ring.capacity(), '\0' );
+	size_t n = ring.pop( &buffer[0] );
+
+	return buffer.substr( 0, n );
+
+}
+
+
+void logring_test::test_capacity() {
+
+	logring ring( 100 );
+
+	// assert - rounded up to a power of 2
+	CPPUNIT_ASSERT( 128 == ring.capacity() );
+
+	// assert - 8 byte header
+	CPPUNIT_ASSERT( ring.fits( 120 ) );
+	CPPUNIT_ASSERT(! ring.fits( 121 ) );
+
+}
+
+
+void logring_test::test_push_pop() {
+
+	logring ring( 128 );
+
+	CPPUNIT_ASSERT( push( ring, "record 1\n" ) );
+	CPPUNIT_ASSERT( push( ring, "record 2\n" ) );
+
+	// assert - records copied out in order
+	CPPUNIT_ASSERT( "record 1\nrecord 2\n" == pop( ring ) );
+	CPPUNIT_ASSERT( "" == pop( ring ) );
+	CPPUNIT_ASSERT( ring.head() == ring.tail() );
+
+}
+
+
+void logring_test::test_full() {
+
+	logring ring( 64 );
+
+	// 3 x 24 byte slots won't fit into 64 bytes
+	CPPUNIT_ASSERT( push( ring, "0123456789" ) );
+	CPPUNIT_ASSERT( push( ring, "0123456789" ) );
+	CPPUNIT_ASSERT(! push( ring, "0123456789" ) );
+
+	// assert - space is released after popping
+	CPPUNIT_ASSERT( "01234567890123456789" == pop( ring ) );
+	CPPUNIT_ASSERT( push( ring, "0123456789" ) );
+
+}
+
+
+void logring_test::test_wrap() {
+
+	logring ring( 64 );
+	std::string expected;
+	std::string output;
+
+	// records of varying sizes to pad around the end of the ring
+	for ( int i = 0; i < 1000; i++ ) {
+
+		char record[32];
+		snprintf( record, sizeof( record ), "%.*s%d\n", i % 17, "abcdefghijklmnopq", i );
+
+		CPPUNIT_ASSERT( push( ring, record ) );
+		expected += record;
+
+		output += pop( ring );
+
+	}
+
+	// assert
+	CPPUNIT_ASSERT( expected == output );
+
+}
+
+
+void logring_test::test_discard() {
+
+	logring ring( 64 );
+
+	CPPUNIT_ASSERT( push( ring, "oldest....\n" ) );
+	CPPUNIT_ASSERT( push( ring, "older.....\n" ) );
+	CPPUNIT_ASSERT(! push( ring, "newest....\n" ) );
+
+	// assert - only the oldest record is dropped
+	CPPUNIT_ASSERT( 1 == ring.discard( 11 ) );
+	CPPUNIT_ASSERT( push( ring, "newest....\n" ) );
+	CPPUNIT_ASSERT( "older.....\nnewest....\n" == pop( ring ) );
+
+}
+
+
+// producer thread helper
+static const int producers = 4;
+static const int records   = 20000;
+
+static void * produce( void * arg ) {
+
+	logring * ring = (logring *) arg;
+	char record[32];
+
+	for ( int i = 0; i < records; i++ ) {
+
+		int n = snprintf( record, sizeof( record ), "%lx:%d\n", (unsigned long) pthread_self(), i );
+
+		iovec iov;
+		iov.iov_base = record;
+		iov.iov_len  = n;
+
+		while (! ring->push( &iov, 1, n ) ) {
+			continue;
+		}
+
+	}
+
+	return 0;
+
+}
+
+
+void logring_test::test_producers() {
+
+	logring ring( 1024 );
+	pthread_t tids[producers];
+
+	for ( int i = 0; i < producers; i++ ) {
+		pthread_create( &tids[i], 0, &produce, &ring );
+	}
+
+	// consume
+	std::string output;
+	int lines = 0;
+
+	while ( lines < ( producers * records ) ) {
+
+		std::string batch = pop( ring );
+
+		for ( size_t i = 0; i < batch.length(); i++ ) {
+			if ( batch[i] == '\n' ) {
+				lines++;
+			}
+		}
+
+		output += batch;
+
+	}
+
+	for ( int i = 0; i < producers; i++ ) {
+		pthread_join( tids[i], 0 );
+	}
+
+	// assert - every record is intact and in order for its producer
+	for ( int p = 0; p < producers; p++ ) {
+
+		char prefix[32];
+		snprintf( prefix, sizeof( prefix ), "%lx:", (unsigned long) tids[p] );
+
+		int expected = 0;
+		size_t pos = 0;
+
+		while ( ( pos = output.find( prefix, pos ) ) != std::string::npos ) {
+
+			pos += strlen( prefix );
+			CPPUNIT_ASSERT( expected == atoi( output.c_str() + pos ) );
+			expected++;
+
+		}
+
+		CPPUNIT_ASSERT( records == expected );
+
+	}
+
+	CPPUNIT_ASSERT( ring.head() == ring.tail() );
+
+}
+
@@ -0,0 +1,251 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logrotator_test.h"
+#include "testutil.h"
+
+#include <config.h>
+
+#include <logstreamxx/logrotator.h>
+#include <logstreamxx/logstream.h>
+
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+
+// register the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( logrotator_test );
+
+// use namespace logstreamxx
+using namespace logstreamxx;
+
+
+void logrotator_test::setUp() {
+
+	// temporary log file
+	_filename = testutil::tempfile( "logrotator_test" );
+
+}
+
+
+void logrotator_test::tearDown() {
+
+	unlink( _filename.c_str() );
+
+	for ( int i = 1; i <= 8; i++ ) {
+		std::ostringstream ss;
+		ss << _filename << "." << i;
+		unlink( ss.str().c_str() );
+		unlink( ( ss.str() + ".gz" ).c_str() );
+	}
+
+}
+
+
+size_t logrotator_test::count_lines() {
+
+	std::string content = testutil::read_all( _filename );
+
+	for ( int i = 1; i <= 8; i++ ) {
+		std::ostringstream ss;
+		ss << _filename << "." << i;
+		content += testutil::read_all( ss.str() );
+	}
+
+	size_t lines = 0;
+	for ( size_t pos = 0; ( pos = content.find( " [INFO] record ", pos ) ) != std::string::npos; pos++ ) {
+		lines++;
+	}
+
+	return lines;
+
+}
+
+
+void logrotator_test::test_constructor_fail() {
+
+	// this will throw a system error exception
+	CPPUNIT_ASSERT_THROW( logrotator rotator( "/nonexistent/logrotator_test", logrotator::policy_t( 1024 ) ),
+			logexception );
+
+}
+
+
+void logrotator_test::test_rotate() {
+
+	logrotator rotator( _filename.c_str(), logrotator::policy_t() );
+	int fd = rotator.fd();
+
+	CPPUNIT_ASSERT( 5 == write( fd, "first", 5 ) );
+	CPPUNIT_ASSERT( rotator.rotate() );
+	CPPUNIT_ASSERT( 6 == write( fd, "second", 6 ) );
+
+	// assert - file descriptor didn't change
+	CPPUNIT_ASSERT( fd == rotator.fd() );
+	CPPUNIT_ASSERT( 1 == rotator.rotations() );
+
+	CPPUNIT_ASSERT( "second" == testutil::read_all( _filename ) );
+	CPPUNIT_ASSERT( "first" == testutil::read_all( _filename + ".1" ) );
+
+}
+
+
+void logrotator_test::test_keep() {
+
+	logrotator rotator( _filename.c_str(), logrotator::policy_t( 0, 0, 2 ) );
+
+	for ( int i = 0; i < 4; i++ ) {
+		CPPUNIT_ASSERT( 1 == write( rotator.fd(), "0123" + i, 1 ) );
+		CPPUNIT_ASSERT( rotator.rotate() );
+	}
+
+	// assert - only the last 2 rotated files are kept
+	CPPUNIT_ASSERT( "" == testutil::read_all( _filename ) );
+	CPPUNIT_ASSERT( "3" == testutil::read_all( _filename + ".1" ) );
+	CPPUNIT_ASSERT( "2" == testutil::read_all( _filename + ".2" ) );
+	CPPUNIT_ASSERT( access( ( _filename + ".3" ).c_str(), F_OK ) != 0 );
+
+}
+
+
+void logrotator_test::test_size() {
+
+	{
+		// log stream rotating every ~256 bytes
+		logstream logger( _filename.c_str(), logrotator::policy_t( 256, 0, 8 ) );
+		logger.loglevel( priority::info );
+
+		for ( int i = 0; i < 16; i++ ) {
+			logger << priority::info << "record " << i << std::endl;
+		}
+	}
+
+	// assert - rotated and no lines lost or split
+	CPPUNIT_ASSERT( testutil::read_all( _filename + ".1" ).length() >= 256 );
+	CPPUNIT_ASSERT( 16 == count_lines() );
+
+}
+
+
+void logrotator_test::test_size_async() {
+
+	{
+		// log stream rotating every ~256 bytes on the writer thread
+		logstream logger( _filename.c_str(), logrotator::policy_t( 256, 0, 8 ), logwriter::block );
+		logger.loglevel( priority::info );
+
+		for ( int i = 0; i < 16; i++ ) {
+			logger << priority::info << "record " << i << std::endl;
+		}
+	}
+
+	// assert - no lines lost or split
+	CPPUNIT_ASSERT( 16 == count_lines() );
+
+}
+
+
+
+void logrotator_test::test_compress() {
+
+#ifdef HAVE_ZLIB
+	{
+		logrotator rotator( _filename.c_str(), logrotator::policy_t( 0, 0, 2, true ) );
+
+		for ( int i = 0; i < 3; i++ ) {
+			CPPUNIT_ASSERT( 1 == write( rotator.fd(), "012" + i, 1 ) );
+			CPPUNIT_ASSERT( rotator.rotate() );
+		}
+
+		// destructor waits for the rotated files to be compressed
+	}
+
+	// assert - only the last 2 compressed files are kept
+	CPPUNIT_ASSERT( access( ( _filename + ".1" ).c_str(), F_OK ) != 0 );
+	CPPUNIT_ASSERT( access( ( _filename + ".3.gz" ).c_str(), F_OK ) != 0 );
+
+	const char * expected[] = { "2", "1" };
+	for ( int i = 0; i < 2; i++ ) {
+
+		std::ostringstream ss;
+		ss << _filename << "." << ( i + 1 ) << ".gz";
+
+		char buffer[16];
+		gzFile gz = gzopen( ss.str().c_str(), "rb" );
+		CPPUNIT_ASSERT( gz != 0 );
+
+		int n = gzread( gz, buffer, sizeof( buffer ) );
+		gzclose( gz );
+
+		CPPUNIT_ASSERT( std::string( expected[i] ) == std::string( buffer, ( n > 0 ) ? n : 0 ) );
+
+	}
+#else
+	// this will throw a not supported exception
+	CPPUNIT_ASSERT_THROW( logrotator rotator( _filename.c_str(), logrotator::policy_t( 0, 0, 2, true ) ),
+			logexception );
+#endif
+
+}
+
+
+void logrotator_test::test_recover() {
+
+	std::string pending = _filename + ".0000000001.0000000001.pending";
+	std::string tmp     = _filename + ".1.gz.tmp";
+
+	std::ofstream( pending.c_str() ) << "stale";
+	std::ofstream( tmp.c_str() ) << "partial";
+
+	{
+		logrotator rotator( _filename.c_str(), logrotator::policy_t() );
+	}
+
+	// assert - pending file is shifted in and the partial file is removed
+	CPPUNIT_ASSERT( access( pending.c_str(), F_OK ) != 0 );
+	CPPUNIT_ASSERT( access( tmp.c_str(), F_OK ) != 0 );
+	CPPUNIT_ASSERT( "stale" == testutil::read_all( _filename + ".1" ) );
+
+#ifdef HAVE_ZLIB
+	std::ofstream( pending.c_str() ) << "compress";
+
+	{
+		logrotator rotator( _filename.c_str(), logrotator::policy_t( 0, 0, 2, true ) );
+	}
+
+	// assert - pending file is compressed
+	CPPUNIT_ASSERT( access( pending.c_str(), F_OK ) != 0 );
+
+	char buffer[16];
+	gzFile gz = gzopen( ( _filename + ".1.gz" ).c_str(), "rb" );
+	CPPUNIT_ASSERT( gz != 0 );
+
+	int n = gzread( gz, buffer, sizeof( buffer ) );
+	gzclose( gz );
+
+	CPPUNIT_ASSERT( std::string( "compress" ) == std::string( buffer, ( n > 0 ) ? n : 0 ) );
+#endif
+
+}
+
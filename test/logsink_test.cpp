@@ -0,0 +1,322 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logsink_test.h"
+#include "testutil.h"
+
+#include <logstreamxx/logfanout.h>
+#include <logstreamxx/logfilesink.h>
+#include <logstreamxx/logmemsink.h>
+#include <logstreamxx/logstream.h>
+
+#include <cstring>
+#include <pthread.h>
+#include <unistd.h>
+
+
+// register the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( logsink_test );
+
+// use namespace logstreamxx
+using namespace logstreamxx;
+
+
+// log sink helper to count the log records
+class counting_logsink : public logsink {
+public:
+
+	counting_logsink() : records( 0 ) { }
+
+	int records;
+
+	virtual bool write( const priority::log_priority_t &p, const iovec * iov, int iovcnt ) throw() {
+		records++;
+		return true;
+	}
+
+};
+
+
+// write a single part log record to a log sink
+static bool wrecord( logsink &sink, const priority::log_priority_t &p, const char * record ) {
+
+	iovec iov;
+	iov.iov_base = (void *) record;
+	iov.iov_len  = strlen( record );
+
+	return sink.write( p, &iov, 1 );
+
+}
+
+
+void logsink_test::setUp() {
+
+	// temporary log file
+	_filename = testutil::tempfile( "logsink_test" );
+
+}
+
+
+void logsink_test::tearDown() {
+	unlink( _filename.c_str() );
+}
+
+
+void logsink_test::test_setlogmask() {
+
+	counting_logsink sink;
+
+	// assert - all priorities enabled by default
+	CPPUNIT_ASSERT( sink.enabled( priority::emerg ) );
+	CPPUNIT_ASSERT( sink.enabled( priority::debug ) );
+
+	// set mask and assert the previous mask
+	CPPUNIT_ASSERT( 0xff == sink.setlogmask( priority::mask::err ) );
+	CPPUNIT_ASSERT( priority::mask::err == sink.setlogmask( 0 ) );
+
+	// assert
+	CPPUNIT_ASSERT(! sink.enabled( priority::emerg ) );
+	CPPUNIT_ASSERT( sink.enabled( priority::err ) );
+
+}
+
+
+void logsink_test::test_fdsink_fail() {
+
+	// this will throw an invalid file descriptor exception
+	CPPUNIT_ASSERT_THROW( logfdsink sink( -1 ), logexception );
+
+}
+
+
+void logsink_test::test_filesink() {
+
+	{
+		logfilesink sink( _filename.c_str(), false );
+		CPPUNIT_ASSERT( wrecord( sink, priority::info, "line 1\n" ) );
+		CPPUNIT_ASSERT( wrecord( sink, priority::info, "line 2\n" ) );
+	}
+
+	// assert
+	CPPUNIT_ASSERT( "line 1\nline 2\n" == testutil::read_all( _filename ) );
+
+}
+
+
+void logsink_test::test_filesink_fail() {
+
+	// this will throw a system error exception
+	CPPUNIT_ASSERT_THROW( logfilesink sink( "/nonexistent/logsink_test" ), logexception );
+
+}
+
+
+void logsink_test::test_durability_group() {
+
+	logfilesink sink( _filename.c_str(), false );
+	sink.durability( logfdsink::durability_t( logfdsink::durability_t::group, 0, priority::crit ) );
+
+	// assert - only critical log records are synced before returning
+	CPPUNIT_ASSERT( wrecord( sink, priority::info, "info\n" ) );
+	CPPUNIT_ASSERT( 0 == sink.syncs() );
+
+	CPPUNIT_ASSERT( wrecord( sink, priority::crit, "critical\n" ) );
+	CPPUNIT_ASSERT( 1 == sink.syncs() );
+
+	// assert - nothing new to sync
+	CPPUNIT_ASSERT( sink.commit() );
+	CPPUNIT_ASSERT( 1 == sink.syncs() );
+
+	// assert - synced once more when leaving the group level
+	CPPUNIT_ASSERT( wrecord( sink, priority::info, "info\n" ) );
+	sink.durability( logfdsink::durability_t() );
+	CPPUNIT_ASSERT( 2 == sink.syncs() );
+
+	CPPUNIT_ASSERT( "info\ncritical\ninfo\n" == testutil::read_all( _filename ) );
+
+}
+
+
+void logsink_test::test_durability_periodic() {
+
+	logfilesink sink( _filename.c_str(), false );
+	sink.durability( logfdsink::durability_t( logfdsink::durability_t::periodic, 20 ) );
+
+	// assert - not synced before returning
+	CPPUNIT_ASSERT( wrecord( sink, priority::crit, "critical\n" ) );
+	CPPUNIT_ASSERT( 0 == sink.syncs() );
+
+	// assert - synced by the timer thread
+	for ( int i = 0; ( i < 200 ) && ( sink.syncs() == 0 ); i++ ) {
+		usleep( 10000 );
+	}
+
+	CPPUNIT_ASSERT( 1 == sink.syncs() );
+
+	// assert - periodic without an interval syncs every log record
+	sink.durability( logfdsink::durability_t( logfdsink::durability_t::periodic, 0 ) );
+	size_t syncs = sink.syncs();
+
+	CPPUNIT_ASSERT( wrecord( sink, priority::debug, "debug\n" ) );
+	CPPUNIT_ASSERT( ( syncs + 1 ) == sink.syncs() );
+
+}
+
+
+// thread helper to write critical log records
+static void * wcritical( void * arg ) {
+
+	for ( int i = 0; i < 20; i++ ) {
+		wrecord( *( (logsink *) arg ), priority::crit, "critical\n" );
+	}
+
+	return 0;
+
+}
+
+
+void logsink_test::test_durability_threads() {
+
+	logfilesink sink( _filename.c_str(), false );
+	sink.durability( logfdsink::durability_t( logfdsink::durability_t::group, 0 ) );
+
+	pthread_t threads[8];
+	for ( int i = 0; i < 8; i++ ) {
+		pthread_create( &threads[i], 0, &wcritical, &sink );
+	}
+
+	for ( int i = 0; i < 8; i++ ) {
+		pthread_join( threads[i], 0 );
+	}
+
+	// assert - at most one sync per log record, concurrent writers share syncs
+	CPPUNIT_ASSERT( sink.syncs() > 0 );
+	CPPUNIT_ASSERT( sink.syncs() <= 160 );
+	CPPUNIT_ASSERT( ( 160 * 9 ) == testutil::read_all( _filename ).length() );
+
+}
+
+
+void logsink_test::test_durability_logstream() {
+
+	logfdsink::durability_t policy( logfdsink::durability_t::group );
+
+	{
+		logstream logger( _filename.c_str(), false );
+		CPPUNIT_ASSERT( logger.logdurability( policy ) );
+	}
+
+	{
+		logstream logger( _filename.c_str(), logwriter::block );
+		CPPUNIT_ASSERT(! logger.logdurability( policy ) );
+	}
+
+}
+
+
+void logsink_test::test_memsink() {
+
+	logmemsink sink;
+
+	iovec iov[2];
+	iov[0].iov_base = (void *) "line ";
+	iov[0].iov_len  = 5;
+	iov[1].iov_base = (void *) "1\n";
+	iov[1].iov_len  = 2;
+
+	CPPUNIT_ASSERT( sink.write( priority::info, iov, 2 ) );
+
+	// assert
+	CPPUNIT_ASSERT( "line 1\n" == sink.str() );
+
+	sink.clear();
+	CPPUNIT_ASSERT( sink.str().empty() );
+
+}
+
+
+void logsink_test::test_memsink_capacity() {
+
+	logmemsink sink( 16 );
+
+	wrecord( sink, priority::info, "line 1\n" );
+	wrecord( sink, priority::info, "line 2\n" );
+	wrecord( sink, priority::info, "line 3\n" );
+
+	// assert - oldest records discarded as a whole
+	CPPUNIT_ASSERT( "line 2\nline 3\n" == sink.str() );
+
+}
+
+
+void logsink_test::test_fanout() {
+
+	logfanout fanout;
+	logmemsink all;
+	logmemsink errors;
+	counting_logsink counter;
+
+	errors.setlogmask( priority::mask::emerg | priority::mask::err );
+
+	fanout.attach( &all );
+	fanout.attach( &errors );
+	fanout.attach( &counter );
+	fanout.attach( &counter );
+
+	wrecord( fanout, priority::err, "error\n" );
+	wrecord( fanout, priority::info, "info\n" );
+
+	// assert - per sink masks
+	CPPUNIT_ASSERT( "error\ninfo\n" == all.str() );
+	CPPUNIT_ASSERT( "error\n" == errors.str() );
+
+	// assert - attached only once
+	CPPUNIT_ASSERT( 2 == counter.records );
+
+	fanout.detach( &counter );
+	wrecord( fanout, priority::info, "info\n" );
+
+	// assert
+	CPPUNIT_ASSERT( 2 == counter.records );
+
+}
+
+
+void logsink_test::test_logstream() {
+
+	logfanout fanout;
+	logmemsink mem;
+	logfilesink file( _filename.c_str(), false );
+
+	fanout.attach( &mem );
+	fanout.attach( &file );
+
+	{
+		logstream logger( &fanout );
+		logger.loglevel( priority::info );
+
+		logger << priority::info << "message " << 42 << std::endl;
+	}
+
+	// assert - same formatted log record in both destinations
+	CPPUNIT_ASSERT( mem.str().find( " [INFO] message 42\n" ) == 22 );
+	CPPUNIT_ASSERT( mem.str() == testutil::read_all( _filename ) );
+
+}
+
@@ -0,0 +1,70 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSINK_TEST_H
+#define LOGSINK_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+
+class logsink_test : public CppUnit::TestFixture {
+
+	// setup the test suite
+	CPPUNIT_TEST_SUITE( logsink_test );
+	CPPUNIT_TEST( test_setlogmask );
+	CPPUNIT_TEST( test_fdsink_fail );
+	CPPUNIT_TEST( test_filesink );
+	CPPUNIT_TEST( test_filesink_fail );
+	CPPUNIT_TEST( test_durability_group );
+	CPPUNIT_TEST( test_durability_periodic );
+	CPPUNIT_TEST( test_durability_threads );
+	CPPUNIT_TEST( test_durability_logstream );
+	CPPUNIT_TEST( test_memsink );
+	CPPUNIT_TEST( test_memsink_capacity );
+	CPPUNIT_TEST( test_fanout );
+	CPPUNIT_TEST( test_logstream );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+
+	void setUp();
+	void tearDown();
+
+	void test_setlogmask();
+	void test_fdsink_fail();
+	void test_filesink();
+	void test_filesink_fail();
+	void test_durability_group();
+	void test_durability_periodic();
+	void test_durability_threads();
+	void test_durability_logstream();
+	void test_memsink();
+	void test_memsink_capacity();
+	void test_fanout();
+	void test_logstream();
+
+private:
+
+	std::string _filename;
+
+};
+
+#endif
+
@@ -0,0 +1,281 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logsocketsink_test.h"
+#include "testutil.h"
+
+#include <logstreamxx/logsocketsink.h>
+#include <logstreamxx/logstream.h>
+
+#include <cstdio>
+#include <cstring>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+
+// register the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( logsocketsink_test );
+
+// use namespace logstreamxx
+using namespace logstreamxx;
+
+
+// write a single part log record to a log sink
+static bool wrecord( logsink &sink, const priority::log_priority_t &p, const char * record ) {
+
+	iovec iov;
+	iov.iov_base = (void *) record;
+	iov.iov_len  = strlen( record );
+
+	return sink.write( p, &iov, 1 );
+
+}
+
+
+void logsocketsink_test::setUp() {
+
+	// collector socket path
+	_path = testutil::temppath( "logsocketsink_test" );
+
+}
+
+
+void logsocketsink_test::tearDown() {
+	unlink( _path.c_str() );
+}
+
+
+int logsocketsink_test::listen_unix() {
+
+	int fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+
+	sockaddr_un addr;
+	memset( &addr, 0, sizeof( addr ) );
+	addr.sun_family = AF_UNIX;
+	strcpy( addr.sun_path, _path.c_str() );
+
+	CPPUNIT_ASSERT( bind( fd, (sockaddr *) &addr, sizeof( addr ) ) == 0 );
+	CPPUNIT_ASSERT( listen( fd, 4 ) == 0 );
+
+	return fd;
+
+}
+
+
+int logsocketsink_test::accept_wait( int fd ) {
+
+	pollfd pfd = { fd, POLLIN, 0 };
+	if ( poll( &pfd, 1, 5000 ) != 1 ) {
+		return -1;
+	}
+
+	return accept( fd, 0, 0 );
+
+}
+
+
+std::string logsocketsink_test::read_wait( int fd, size_t n ) {
+
+	std::string data;
+	char buffer[256];
+
+	while ( data.length() < n ) {
+
+		pollfd pfd = { fd, POLLIN, 0 };
+		if ( poll( &pfd, 1, 5000 ) != 1 ) {
+			break;
+		}
+
+		ssize_t r = read( fd, buffer, sizeof( buffer ) );
+		if ( r <= 0 ) {
+			break;
+		}
+
+		data.append( buffer, r );
+
+	}
+
+	return data;
+
+}
+
+
+void logsocketsink_test::test_constructor_fail() {
+
+	// these will throw invalid argument exceptions
+	CPPUNIT_ASSERT_THROW( logsocketsink sink( "localhost" ), logexception );
+	CPPUNIT_ASSERT_THROW( logsocketsink sink( "" ), logexception );
+	CPPUNIT_ASSERT_THROW( logsocketsink sink( _path.c_str(), logsocketsink::newline, 0 ), logexception );
+
+}
+
+
+void logsocketsink_test::test_unix() {
+
+	int lfd = listen_unix();
+
+	logsocketsink sink( _path.c_str() );
+	CPPUNIT_ASSERT( wrecord( sink, priority::info, "line 1\n" ) );
+	CPPUNIT_ASSERT( wrecord( sink, priority::info, "line 2" ) );
+
+	int fd = accept_wait( lfd );
+	CPPUNIT_ASSERT( fd != -1 );
+
+	// assert - newline-delimited records
+	CPPUNIT_ASSERT( "line 1\nline 2\n" == read_wait( fd, 14 ) );
+
+	CPPUNIT_ASSERT( sink.connected() );
+
+	logsocketsink::stats_t stats = sink.stats();
+	CPPUNIT_ASSERT( stats.spooled_records == 2 );
+	CPPUNIT_ASSERT( stats.spooled_bytes == 14 );
+	CPPUNIT_ASSERT( stats.dropped_records == 0 );
+	CPPUNIT_ASSERT( stats.connects == 1 );
+
+	close( fd );
+	close( lfd );
+
+}
+
+
+void logsocketsink_test::test_tcp_length() {
+
+	// collector listening on a loopback ephemeral port
+	int lfd = socket( AF_INET, SOCK_STREAM, 0 );
+
+	sockaddr_in addr;
+	memset( &addr, 0, sizeof( addr ) );
+	addr.sin_family      = AF_INET;
+	addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+
+	socklen_t len = sizeof( addr );
+	CPPUNIT_ASSERT( bind( lfd, (sockaddr *) &addr, sizeof( addr ) ) == 0 );
+	CPPUNIT_ASSERT( listen( lfd, 4 ) == 0 );
+	CPPUNIT_ASSERT( getsockname( lfd, (sockaddr *) &addr, &len ) == 0 );
+
+	char address[32];
+	snprintf( address, sizeof( address ), "127.0.0.1:%d", ntohs( addr.sin_port ) );
+
+	{
+		logsocketsink sink( address, logsocketsink::length );
+
+		logstream logger( &sink );
+		logger.loglevel( priority::info );
+
+		logger << priority::info << "message" << std::endl;
+
+		int fd = accept_wait( lfd );
+		CPPUNIT_ASSERT( fd != -1 );
+
+		// assert - 32-bit big-endian length prefix followed by the log record
+		std::string data = read_wait( fd, 4 );
+		CPPUNIT_ASSERT( data.length() >= 4 );
+
+		size_t n = ( (unsigned char) data[0] << 24 ) | ( (unsigned char) data[1] << 16 ) |
+				( (unsigned char) data[2] << 8 ) | (unsigned char) data[3];
+
+		data += read_wait( fd, n + 4 - data.length() );
+		CPPUNIT_ASSERT( data.length() == ( n + 4 ) );
+		CPPUNIT_ASSERT( data.substr( data.length() - 15 ) == "[INFO] message\n" );
+
+		close( fd );
+	}
+
+	close( lfd );
+
+}
+
+
+void logsocketsink_test::test_outage() {
+
+	logsocketsink sink( _path.c_str() );
+
+	// assert - writes don't block while the collector is down
+	for ( int i = 0; i < 100; i++ ) {
+		CPPUNIT_ASSERT( wrecord( sink, priority::info, "line\n" ) );
+	}
+
+	CPPUNIT_ASSERT(! sink.connected() );
+
+	// collector comes up, records are sent after reconnecting
+	int lfd = listen_unix();
+	int fd  = accept_wait( lfd );
+	CPPUNIT_ASSERT( fd != -1 );
+
+	CPPUNIT_ASSERT( read_wait( fd, 500 ).length() == 500 );
+
+	close( fd );
+	close( lfd );
+
+}
+
+
+void logsocketsink_test::test_drop() {
+
+	{
+		logsocketsink sink( _path.c_str(), logsocketsink::newline, 16 );
+
+		wrecord( sink, priority::info, "line 1\n" );
+		wrecord( sink, priority::info, "line 2\n" );
+		wrecord( sink, priority::info, "line 3\n" );
+
+		// assert - spool full
+		logsocketsink::stats_t stats = sink.stats();
+		CPPUNIT_ASSERT( stats.spooled_records == 2 );
+		CPPUNIT_ASSERT( stats.spooled_bytes == 14 );
+		CPPUNIT_ASSERT( stats.dropped_records == 1 );
+		CPPUNIT_ASSERT( stats.dropped_bytes == 7 );
+	}
+
+}
+
+
+void logsocketsink_test::test_reconnect() {
+
+	int lfd = listen_unix();
+
+	logsocketsink sink( _path.c_str() );
+	wrecord( sink, priority::info, "line 1\n" );
+
+	int fd = accept_wait( lfd );
+	CPPUNIT_ASSERT( fd != -1 );
+	CPPUNIT_ASSERT( "line 1\n" == read_wait( fd, 7 ) );
+
+	// collector closes the connection
+	close( fd );
+
+	wrecord( sink, priority::info, "line 2\n" );
+
+	// assert - record sent over a new connection
+	fd = accept_wait( lfd );
+	CPPUNIT_ASSERT( fd != -1 );
+	CPPUNIT_ASSERT( "line 2\n" == read_wait( fd, 7 ) );
+
+	CPPUNIT_ASSERT( sink.stats().connects == 2 );
+	CPPUNIT_ASSERT( sink.stats().dropped_records == 0 );
+
+	close( fd );
+	close( lfd );
+
+}
+
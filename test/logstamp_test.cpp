@@ -0,0 +1,99 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logstamp_test.h"
+
+#include <logstreamxx/logstamp.h>
+
+#include <cstdio>
+#include <string>
+
+
+// register the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( logstamp_test );
+
+// use namespace logstreamxx
+using namespace logstreamxx;
+
+
+static std::string reference( const timeval &tv ) {
+
+	// reference (uncached) formatting
+	char buffer[32];
+	tm ti;
+
+	localtime_r( &tv.tv_sec, &ti );
+	size_t n = strftime( buffer, 16, "%b %e %T", &ti );
+	sprintf( ( buffer + n ), ".%06d", (int) tv.tv_usec );
+
+	return buffer;
+
+}
+
+
+void logstamp_test::test_format() {
+
+	logstamp ls;
+	char buffer[logstamp::size];
+
+	timeval tv;
+	tv.tv_sec  = 1414108800;
+	tv.tv_usec = 1234;
+
+	// assert
+	CPPUNIT_ASSERT( logstamp::size == ls.format( buffer, tv ) );
+	CPPUNIT_ASSERT( reference( tv ) == std::string( buffer, logstamp::size ) );
+
+}
+
+
+void logstamp_test::test_format_cached() {
+
+	logstamp ls;
+	char buffer[logstamp::size];
+
+	timeval tv;
+	tv.tv_sec  = 1414108800;
+	tv.tv_usec = 999999;
+
+	// same second, different microseconds
+	ls.format( buffer, tv );
+	tv.tv_usec = 7;
+	ls.format( buffer, tv );
+	CPPUNIT_ASSERT( reference( tv ) == std::string( buffer, logstamp::size ) );
+
+	// next second
+	tv.tv_sec++;
+	ls.format( buffer, tv );
+	CPPUNIT_ASSERT( reference( tv ) == std::string( buffer, logstamp::size ) );
+
+}
+
+
+void logstamp_test::test_now() {
+
+	logstamp ls;
+	char buffer[logstamp::size];
+
+	// assert - fixed width
+	CPPUNIT_ASSERT( logstamp::size == ls.now( buffer ) );
+	CPPUNIT_ASSERT( '.' == buffer[15] );
+
+}
+
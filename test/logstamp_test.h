@@ -0,0 +1,44 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSTAMP_TEST_H
+#define LOGSTAMP_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+
+class logstamp_test : public CppUnit::TestFixture {
+
+	// setup the test suite
+	CPPUNIT_TEST_SUITE( logstamp_test );
+	CPPUNIT_TEST( test_format );
+	CPPUNIT_TEST( test_format_cached );
+	CPPUNIT_TEST( test_now );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+
+	void test_format();
+	void test_format_cached();
+	void test_now();
+
+};
+
+#endif
+
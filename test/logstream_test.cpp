@@ -0,0 +1,124 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logstream_test.h"
+#include "testutil.h"
+
+#include <logstreamxx/logmacros.h>
+
+#include <unistd.h>
+
+
+// register the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( logstream_test );
+
+// use namespace logstreamxx
+using namespace logstreamxx;
+
+
+// evaluation counter helper
+static int evaluated = 0;
+
+static int evaluate() {
+	return ++evaluated;
+}
+
+
+void logstream_test::setUp() {
+
+	// temporary log file
+	_filename  = testutil::tempfile( "logstream_test" );
+	evaluated  = 0;
+
+}
+
+
+void logstream_test::tearDown() {
+	unlink( _filename.c_str() );
+}
+
+
+void logstream_test::test_enabled() {
+
+	// log stream
+	logstream logger( _filename.c_str() );
+	logger.loglevel( priority::warning );
+
+	// assert
+	CPPUNIT_ASSERT( logger.enabled( priority::emerg ) );
+	CPPUNIT_ASSERT( logger.enabled( priority::warning ) );
+	CPPUNIT_ASSERT(! logger.enabled( priority::notice ) );
+	CPPUNIT_ASSERT(! logger.enabled( priority::debug ) );
+
+}
+
+
+void logstream_test::test_log_macro() {
+
+	{
+		// log stream
+		logstream logger( _filename.c_str() );
+		logger.loglevel( priority::info );
+
+		LOGSTREAMXX_DEBUG( logger ) << "debug " << evaluate() << std::endl;
+		LOGSTREAMXX_INFO( logger ) << "info " << evaluate() << std::endl;
+
+		// dangling else safety
+		if ( evaluated == 1 )
+			LOGSTREAMXX_DEBUG( logger ) << "debug " << evaluate() << std::endl;
+		else
+			evaluated = -1;
+	}
+
+	// assert - disabled log statement was not evaluated
+	CPPUNIT_ASSERT( 1 == evaluated );
+
+	std::string content = testutil::read_all( _filename );
+	CPPUNIT_ASSERT( content.find( "[DEBG]" ) == std::string::npos );
+	CPPUNIT_ASSERT( content.find( "[INFO] info 1\n" ) != std::string::npos );
+
+}
+
+
+
+void logstream_test::test_buffer_size() {
+
+	const std::string record( 8192, 'x' );
+
+	{
+		// log stream with a growable buffer
+		logstream logger( _filename.c_str(), true, 00644, 256, 16384 );
+		logger.loglevel( priority::info );
+
+		logger << priority::info << record << std::endl;
+	}
+
+	// assert
+	std::string content = testutil::read_all( _filename );
+	CPPUNIT_ASSERT( content.find( " [INFO] " + record + "\n" ) != std::string::npos );
+
+}
+
+
+void logstream_test::test_buffer_size_fail() {
+
+	// this will throw an invalid buffer size exception
+	CPPUNIT_ASSERT_THROW( logstream logger( _filename.c_str(), true, 00644, 1 ), logexception );
+
+}
@@ -20,6 +20,13 @@
 #include "logstreambuf_test.h"
 
 #include <logstreamxx/logstreambuf.h>
+#include <logstreamxx/logfield.h>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <pthread.h>
 #include <unistd.h>
 
 
@@ -30,6 +37,82 @@ CPPUNIT_TEST_SUITE_REGISTRATION( logstreambuf_test );
 using namespace logstreamxx;
 
 
+// log sink helper to collect the log records and count the writes,
+// written to from the flush timer thread as well
+class collecting_logsink : public logsink {
+public:
+
+	collecting_logsink() : writes( 0 ), failing( false ) {
+		pthread_mutex_init( &_mutex, 0 );
+	}
+
+	virtual ~collecting_logsink() throw() {
+		pthread_mutex_destroy( &_mutex );
+	}
+
+	virtual bool write( const priority::log_priority_t &p, const iovec * iov, int iovcnt ) throw() {
+
+		if ( failing ) {
+			return false;
+		}
+
+		pthread_mutex_lock( &_mutex );
+
+		for ( int i = 0; i < iovcnt; i++ ) {
+			data.append( (const char *) iov[i].iov_base, iov[i].iov_len );
+		}
+
+		priorities.push_back( p );
+		writes++;
+		pthread_mutex_unlock( &_mutex );
+
+		return true;
+
+	}
+
+	int count() {
+
+		pthread_mutex_lock( &_mutex );
+		int n = writes;
+		pthread_mutex_unlock( &_mutex );
+
+		return n;
+
+	}
+
+	std::string data;
+	std::vector<priority::log_priority_t> priorities;
+	int writes;
+	bool failing;
+
+private:
+
+	pthread_mutex_t _mutex;
+
+};
+
+
+// log stream buffer helper to count the writes
+class counting_logstreambuf : public logstreambuf {
+public:
+
+	counting_logstreambuf( int output_fd ) : logstreambuf( output_fd ), writes( 0 ) {
+		setlogmask( priority::mask::debug );
+	}
+	virtual ~counting_logstreambuf() throw() { sync(); }
+
+	int writes;
+
+protected:
+
+	virtual bool wlprefix( const char * data, size_t n ) throw() {
+		writes++;
+		return logstreambuf::wlprefix( data, n );
+	}
+
+};
+
+
 void logstreambuf_test::test_constructor() {
 
 	// log stream buffer
@@ -102,6 +185,27 @@ void logstreambuf_test::test_setlogmask_complex() {
 }
 
 
+void logstreambuf_test::test_enabled() {
+
+	// log stream buffer
+	logstreambuf sb;
+
+	// assert - default mask only enables 'emerg'
+	CPPUNIT_ASSERT( sb.enabled( priority::emerg ) );
+	CPPUNIT_ASSERT(! sb.enabled( priority::debug ) );
+
+	// set mask
+	sb.setlogmask( priority::mask::err | priority::mask::debug );
+
+	// assert
+	CPPUNIT_ASSERT(! sb.enabled( priority::emerg ) );
+	CPPUNIT_ASSERT( sb.enabled( priority::err ) );
+	CPPUNIT_ASSERT(! sb.enabled( priority::info ) );
+	CPPUNIT_ASSERT( sb.enabled( priority::debug ) );
+
+}
+
+
 void logstreambuf_test::test_lprefix() {
 
 	// log stream buffer
@@ -118,3 +222,465 @@ void logstreambuf_test::test_lprefix() {
 
 }
 
+
+void logstreambuf_test::test_lpattern() {
+
+	collecting_logsink sink;
+	logstreambuf sb( &sink );
+	std::ostream os( &sb );
+
+	sb.setlogmask( priority::mask::info | priority::mask::err );
+	sb.lpriority( priority::info );
+
+	// assert - static parts only
+	CPPUNIT_ASSERT( sb.lpattern( "<%l> 100%% %x" ) );
+	os << "one" << std::endl;
+	CPPUNIT_ASSERT( sink.data == "<info> 100% one\n" );
+
+	// assert - prefix change updates the header
+	sink.data.clear();
+	sb.lprefix( "app" );
+	sb.lpriority( priority::err );
+	os << "two" << std::endl;
+	CPPUNIT_ASSERT( sink.data == "<err> 100% app two\n" );
+
+	// assert - dynamic parts
+	sink.data.clear();
+	CPPUNIT_ASSERT( sb.lpattern( "#%n %P:%T [%p] %x" ) );
+	os << "three" << std::endl;
+	os << "four" << std::endl;
+
+	char pid[32];
+	snprintf( pid, sizeof( pid ), " %d:", (int) getpid() );
+
+	CPPUNIT_ASSERT( sink.data.compare( 0, 3, "#3 " ) == 0 );
+	CPPUNIT_ASSERT( sink.data.find( pid ) == 2 );
+	CPPUNIT_ASSERT( sink.data.find( " [EROR] app three\n#4 " ) != std::string::npos );
+	CPPUNIT_ASSERT( sink.data.find( " [EROR] app four\n" ) != std::string::npos );
+
+	// assert - default layout
+	sink.data.clear();
+	CPPUNIT_ASSERT( sb.lpattern( LOGSTREAMBUF_PATTERN ) );
+	os << "five" << std::endl;
+	CPPUNIT_ASSERT( sink.data.find( " [EROR] app five\n" ) == logstamp::size );
+
+}
+
+
+void logstreambuf_test::test_lpattern_invalid() {
+
+	collecting_logsink sink;
+	logstreambuf sb( &sink );
+	std::ostream os( &sb );
+
+	sb.setlogmask( priority::mask::info );
+	sb.lpriority( priority::info );
+
+	// assert - invalid patterns are rejected
+	CPPUNIT_ASSERT( sb.lpattern( "[%l] " ) );
+	CPPUNIT_ASSERT(! sb.lpattern( "%q" ) );
+	CPPUNIT_ASSERT(! sb.lpattern( "trailing %" ) );
+	CPPUNIT_ASSERT(! sb.lpattern( "%t%t%t%t%t%t%t%t%t" ) );
+
+	// assert - previous pattern still in use
+	os << "message" << std::endl;
+	CPPUNIT_ASSERT( sink.data == "[info] message\n" );
+
+}
+
+
+void logstreambuf_test::test_record() {
+
+	int fds[2];
+	CPPUNIT_ASSERT( 0 == pipe( fds ) );
+
+	{
+		// log stream buffer
+		logstreambuf sb( fds[1] );
+		std::ostream os( &sb );
+
+		sb.setlogmask( priority::mask::info );
+		sb.lpriority( priority::info );
+		sb.lprefix( "prefix" );
+
+		os << "message " << 42 << std::endl;
+	}
+
+	// a single read returns the whole record
+	char buffer[128];
+	ssize_t n = read( fds[0], buffer, sizeof( buffer ) );
+
+	close( fds[0] );
+	close( fds[1] );
+
+	// assert - "%b %e %T.usec [INFO] prefix message 42\n"
+	std::string record( buffer, ( n > 0 ) ? n : 0 );
+	CPPUNIT_ASSERT( 22 == record.find( " [INFO] prefix message 42\n" ) );
+	CPPUNIT_ASSERT( record.length() == 48 );
+
+}
+
+
+
+void logstreambuf_test::test_lbuffer() {
+
+	// log stream buffer
+	logstreambuf sb;
+
+	// assert
+	CPPUNIT_ASSERT(! sb.lbuffer( 1 ) );
+	CPPUNIT_ASSERT( sb.lbuffer( 64 ) );
+	CPPUNIT_ASSERT( sb.lbuffer( 64, 8192 ) );
+
+	// log stream buffer with a failing destination
+	collecting_logsink sink;
+	logstreambuf fsb( &sink );
+	std::ostream os( &fsb );
+
+	fsb.setlogmask( priority::mask::info );
+	fsb.lpriority( priority::info );
+	fsb.lbuffer( 16, 64 );
+
+	os << "0123456789abcdefghij";
+	sink.failing = true;
+
+	// assert - buffered content kept if it can't be written out
+	CPPUNIT_ASSERT(! fsb.lbuffer( 4 ) );
+
+	char * buffer = new char[8];
+	CPPUNIT_ASSERT( 0 == fsb.pubsetbuf( buffer, 8 ) );
+	delete [] buffer;
+
+	sink.failing = false;
+	os << std::endl;
+
+	CPPUNIT_ASSERT( sink.data.find( " [INFO] 0123456789abcdefghij\n" ) == logstamp::size );
+
+}
+
+
+void logstreambuf_test::test_lbuffer_grow() {
+
+	int fd = open( "/dev/null", O_WRONLY );
+	CPPUNIT_ASSERT( fd != -1 );
+
+	const std::string record( 8000, 'x' );
+
+	{
+		// log stream buffer with a fixed buffer
+		counting_logstreambuf sb( fd );
+		std::ostream os( &sb );
+
+		sb.lbuffer( 64 );
+		os << record << std::endl;
+
+		// assert - record was split into multiple writes
+		CPPUNIT_ASSERT( sb.writes > 1 );
+	}
+
+	{
+		// log stream buffer with a growable buffer
+		counting_logstreambuf sb( fd );
+		std::ostream os( &sb );
+
+		sb.lbuffer( 64, 16384 );
+		os << record << std::endl;
+		os << record << std::endl;
+
+		// assert - each record was written at once
+		CPPUNIT_ASSERT( 2 == sb.writes );
+	}
+
+	{
+		// log stream buffer with a growable buffer smaller than the record
+		counting_logstreambuf sb( fd );
+		std::ostream os( &sb );
+
+		sb.lbuffer( 64, 4096 );
+		os << record << std::endl;
+
+		// assert - record was split at the size limit
+		CPPUNIT_ASSERT( 2 == sb.writes );
+	}
+
+	{
+		// log stream buffer with the default buffer
+		counting_logstreambuf sb( fd );
+		std::ostream os( &sb );
+
+		os << std::string( PIPE_BUF - 64, 'x' ) << std::endl;
+
+		// assert - records up to PIPE_BUF are written at once
+		CPPUNIT_ASSERT( 1 == sb.writes );
+	}
+
+	close( fd );
+
+}
+
+
+void logstreambuf_test::test_lflush_bytes() {
+
+	collecting_logsink sink;
+
+	{
+		logstreambuf sb( &sink );
+		std::ostream os( &sb );
+
+		sb.setlogmask( priority::mask::info );
+		sb.lpriority( priority::info );
+		sb.lflush( logstreambuf::flush_policy_t( 256 ) );
+
+		for ( int i = 0; i < 10; i++ ) {
+			os << "record " << i << std::endl;
+		}
+
+		// assert - records batched
+		CPPUNIT_ASSERT( sink.writes > 0 );
+		CPPUNIT_ASSERT( sink.writes < 10 );
+	}
+
+	// assert - all the records written out in order, as a whole
+	size_t pos = 0;
+	for ( int i = 0; i < 10; i++ ) {
+
+		char record[32];
+		snprintf( record, sizeof( record ), " [INFO] record %d\n", i );
+
+		pos = sink.data.find( record, pos );
+		CPPUNIT_ASSERT( pos != std::string::npos );
+
+	}
+
+	CPPUNIT_ASSERT( sink.data.length() == ( 10 * 39 ) );
+
+}
+
+
+void logstreambuf_test::test_lflush_interval() {
+
+	collecting_logsink sink;
+	logstreambuf sb( &sink );
+	std::ostream os( &sb );
+
+	sb.setlogmask( priority::mask::info );
+	sb.lpriority( priority::info );
+	sb.lflush( logstreambuf::flush_policy_t( 0, 50 ) );
+
+	os << "record 1" << std::endl;
+	os << "record 2" << std::endl;
+
+	// assert - records written out together by the timer thread
+	CPPUNIT_ASSERT( sink.count() == 0 );
+
+	for ( int i = 0; ( i < 200 ) && ( sink.count() == 0 ); i++ ) {
+		usleep( 10000 );
+	}
+
+	CPPUNIT_ASSERT( sink.count() == 1 );
+
+	// back to immediate
+	sb.lflush( logstreambuf::flush_policy_t() );
+	os << "record 3" << std::endl;
+
+	// assert
+	CPPUNIT_ASSERT( sink.count() == 2 );
+	CPPUNIT_ASSERT( sink.data.length() == ( 3 * 39 ) );
+
+}
+
+
+void logstreambuf_test::test_lflush_threshold() {
+
+	collecting_logsink sink;
+	logstreambuf sb( &sink );
+	std::ostream os( &sb );
+
+	sb.setlogmask( priority::mask::info | priority::mask::err );
+	sb.lflush( logstreambuf::flush_policy_t( 1 << 20, 0, priority::err ) );
+
+	sb.lpriority( priority::info );
+	os << "record 1" << std::endl;
+	os << "record 2" << std::endl;
+
+	// assert - batched
+	CPPUNIT_ASSERT( sink.writes == 0 );
+
+	sb.lpriority( priority::err );
+	os << "record 3" << std::endl;
+
+	// assert - batch written out ahead of the error record
+	CPPUNIT_ASSERT( sink.writes == 2 );
+	CPPUNIT_ASSERT( sink.data.find( "record 1" ) < sink.data.find( "record 2" ) );
+	CPPUNIT_ASSERT( sink.data.find( "record 2" ) < sink.data.find( "[EROR] record 3" ) );
+
+}
+
+
+void logstreambuf_test::test_lflush_priorities() {
+
+	collecting_logsink sink;
+	logstreambuf sb( &sink );
+	std::ostream os( &sb );
+
+	sb.setlogmask( priority::mask::info | priority::mask::debug );
+	sb.lflush( logstreambuf::flush_policy_t( 1 << 20 ) );
+
+	const priority::log_priority_t priorities[] = {
+		priority::info, priority::info, priority::debug, priority::info };
+
+	for ( int i = 0; i < 4; i++ ) {
+		sb.lpriority( priorities[i] );
+		os << "record " << i << std::endl;
+	}
+
+	// write out the batch
+	sb.lflush( logstreambuf::flush_policy_t() );
+
+	// assert - a write for each run of records with the same priority
+	CPPUNIT_ASSERT( sink.writes == 3 );
+	CPPUNIT_ASSERT( sink.priorities[0] == priority::info );
+	CPPUNIT_ASSERT( sink.priorities[1] == priority::debug );
+	CPPUNIT_ASSERT( sink.priorities[2] == priority::info );
+	CPPUNIT_ASSERT( sink.data.find( "[DEBG] record 2" ) < sink.data.find( "[INFO] record 3" ) );
+
+}
+
+
+void logstreambuf_test::test_lfield_text() {
+
+	collecting_logsink sink;
+	logstreambuf sb( &sink );
+	std::ostream os( &sb );
+
+	sb.setlogmask( priority::mask::info );
+	sb.lpriority( priority::info );
+
+	os << logfield( "user", "bob" ) << "logged in" << logfield( "id", 42 ) << std::endl;
+	os << "no fields" << std::endl;
+
+	// assert - fields after the log message, not carried over
+	CPPUNIT_ASSERT( sink.writes == 2 );
+	CPPUNIT_ASSERT( sink.data.find( " [INFO] logged in user=bob id=42\n" ) == 22 );
+	CPPUNIT_ASSERT( sink.data.find( " [INFO] no fields\n" ) != std::string::npos );
+
+	// assert - disabled priority, fields dropped
+	sb.lpriority( priority::debug );
+	os << logfield( "dropped", true ) << "debug" << std::endl;
+
+	sb.lpriority( priority::info );
+	os << "last" << std::endl;
+
+	CPPUNIT_ASSERT( sink.data.find( "dropped" ) == std::string::npos );
+	CPPUNIT_ASSERT( sink.data.find( " [INFO] last\n" ) != std::string::npos );
+
+	// assert - last part written out with its new line, the fields
+	// still go in before it
+	sink.data.clear();
+	sb.lbuffer( 8 );
+
+	os << logfield( "k", 1 );
+	os.write( "0123456\n", 8 );
+	os.flush();
+
+	CPPUNIT_ASSERT( sink.data.find( " [INFO] 0123456 k=1\n" ) == logstamp::size );
+	CPPUNIT_ASSERT( sink.data.length() == logstamp::size + 20 );
+
+}
+
+
+void logstreambuf_test::test_lformat_json() {
+
+	collecting_logsink sink;
+	logstreambuf sb( &sink );
+	std::ostream os( &sb );
+
+	sb.setlogmask( priority::mask::warning );
+	sb.lpriority( priority::warning );
+	sb.lprefix( "app[1]" );
+
+	// assert - previous format
+	CPPUNIT_ASSERT( sb.lformat( logstreambuf::json ) == logstreambuf::text );
+
+	os << "disk \"/\" at " << 95 << "%" << logfield( "free", 1.5 ) << logfield( "path", "/" )
+		<< logfield( "ok", false ) << logfield( "n", -3 ) << std::endl;
+
+	// assert
+	CPPUNIT_ASSERT( sink.writes == 1 );
+	CPPUNIT_ASSERT( sink.data.compare( 0, 9, "{\"time\":\"" ) == 0 );
+	CPPUNIT_ASSERT( sink.data.find( "\",\"level\":\"warning\",\"prefix\":\"app[1]\","
+			"\"msg\":\"disk \\\"/\\\" at 95%\",\"free\":1.5,\"path\":\"/\",\"ok\":false,"
+			"\"n\":-3}\n" ) == 9 + logstamp::size );
+
+}
+
+
+void logstreambuf_test::test_lformat_json_overflow() {
+
+	collecting_logsink sink;
+	logstreambuf sb( &sink );
+	std::ostream os( &sb );
+
+	sb.setlogmask( priority::mask::info );
+	sb.lpriority( priority::info );
+	sb.lbuffer( 8 );
+	sb.lformat( logstreambuf::json );
+
+	// log record written out in parts
+	os << "0123456789\tabcdef" << logfield( "k", "v" ) << std::endl;
+
+	// assert - one JSON object
+	CPPUNIT_ASSERT( sink.writes > 1 );
+	CPPUNIT_ASSERT( sink.data.find( "\"msg\":\"0123456789\\tabcdef\",\"k\":\"v\"}\n" ) != std::string::npos );
+	CPPUNIT_ASSERT( sink.data.find( "\"time\"" ) == sink.data.rfind( "\"time\"" ) );
+
+}
+
+
+void logstreambuf_test::test_lformat_json_utf8() {
+
+	collecting_logsink sink;
+	logstreambuf sb( &sink );
+	std::ostream os( &sb );
+
+	sb.setlogmask( priority::mask::info );
+	sb.lpriority( priority::info );
+	sb.lbuffer( 8 );
+	sb.lformat( logstreambuf::json );
+
+	// multi-byte sequences across the buffer boundaries
+	os << "\xe2\x82\xac\xe2\x82\xac\xe2\x82\xac\xf0\x9f\x98\x80 \xff" << std::endl;
+
+	// assert - valid sequences kept, invalid byte replaced
+	CPPUNIT_ASSERT( sink.writes > 1 );
+	CPPUNIT_ASSERT( sink.data.find( "\"msg\":\"\xe2\x82\xac\xe2\x82\xac\xe2\x82\xac\xf0\x9f\x98\x80 \\ufffd\"}\n" )
+			!= std::string::npos );
+
+}
+
+
+void logstreambuf_test::test_lformat_logfmt() {
+
+	collecting_logsink sink;
+	logstreambuf sb( &sink );
+	std::ostream os( &sb );
+
+	sb.setlogmask( priority::mask::err );
+	sb.lpriority( priority::err );
+	sb.lformat( logstreambuf::logfmt );
+
+	os << "request failed" << logfield( "status", 503u ) << logfield( "path", "/a b" )
+		<< logfield( "empty", "" ) << std::endl;
+
+	// assert
+	CPPUNIT_ASSERT( sink.data.compare( 0, 6, "time=\"" ) == 0 );
+	CPPUNIT_ASSERT( sink.data.find( "\" level=err msg=\"request failed\" status=503 path=\"/a b\" empty=\"\"\n" )
+			== 6 + logstamp::size );
+
+	// assert - back to text
+	CPPUNIT_ASSERT( sb.lformat( logstreambuf::text ) == logstreambuf::logfmt );
+	os << "text" << std::endl;
+	CPPUNIT_ASSERT( sink.data.find( " [EROR] text\n" ) != std::string::npos );
+
+}
+
@@ -33,7 +33,22 @@ class logstreambuf_test : public CppUnit::TestFixture {
 	CPPUNIT_TEST( test_lpriority );
 	CPPUNIT_TEST( test_setlogmask );
 	CPPUNIT_TEST( test_setlogmask_complex );
+	CPPUNIT_TEST( test_enabled );
 	CPPUNIT_TEST( test_lprefix );
+	CPPUNIT_TEST( test_lpattern );
+	CPPUNIT_TEST( test_lpattern_invalid );
+	CPPUNIT_TEST( test_record );
+	CPPUNIT_TEST( test_lbuffer );
+	CPPUNIT_TEST( test_lbuffer_grow );
+	CPPUNIT_TEST( test_lflush_bytes );
+	CPPUNIT_TEST( test_lflush_interval );
+	CPPUNIT_TEST( test_lflush_threshold );
+	CPPUNIT_TEST( test_lflush_priorities );
+	CPPUNIT_TEST( test_lfield_text );
+	CPPUNIT_TEST( test_lformat_json );
+	CPPUNIT_TEST( test_lformat_json_overflow );
+	CPPUNIT_TEST( test_lformat_json_utf8 );
+	CPPUNIT_TEST( test_lformat_logfmt );
 	CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -44,7 +59,22 @@ public:
 	void test_lpriority();
 	void test_setlogmask();
 	void test_setlogmask_complex();
+	void test_enabled();
 	void test_lprefix();
+	void test_lpattern();
+	void test_lpattern_invalid();
+	void test_record();
+	void test_lbuffer();
+	void test_lbuffer_grow();
+	void test_lflush_bytes();
+	void test_lflush_interval();
+	void test_lflush_threshold();
+	void test_lflush_priorities();
+	void test_lfield_text();
+	void test_lformat_json();
+	void test_lformat_json_overflow();
+	void test_lformat_json_utf8();
+	void test_lformat_logfmt();
 
 };
 
@@ -0,0 +1,240 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logsyslogsink_test.h"
+#include "testutil.h"
+
+#include <logstreamxx/logsyslogsink.h>
+#include <logstreamxx/logstream.h>
+
+#include <cstdio>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+
+// register the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( logsyslogsink_test );
+
+// use namespace logstreamxx
+using namespace logstreamxx;
+
+
+// write a single part log record to a log sink
+static bool wrecord( logsink &sink, const priority::log_priority_t &p, const char * record ) {
+
+	iovec iov;
+	iov.iov_base = (void *) record;
+	iov.iov_len  = strlen( record );
+
+	return sink.write( p, &iov, 1 );
+
+}
+
+
+void logsyslogsink_test::setUp() {
+
+	// datagram socket pair standing in for the syslog daemon
+	CPPUNIT_ASSERT( socketpair( AF_UNIX, SOCK_DGRAM, 0, _sv ) == 0 );
+
+}
+
+
+void logsyslogsink_test::tearDown() {
+
+	close( _sv[0] );
+	close( _sv[1] );
+
+}
+
+
+std::string logsyslogsink_test::recv_msg( int fd ) {
+
+	char buffer[4096];
+	ssize_t n = recv( fd, buffer, sizeof( buffer ), MSG_DONTWAIT );
+
+	if ( n < 0 ) {
+		return "";
+	}
+
+	return std::string( buffer, n );
+
+}
+
+
+void logsyslogsink_test::test_rfc3164() {
+
+	logsyslogsink sink( _sv[0], "test", logsyslogsink::rfc3164, LOG_LOCAL0 );
+	CPPUNIT_ASSERT( wrecord( sink, priority::info, "line 1\n" ) );
+	CPPUNIT_ASSERT( wrecord( sink, priority::emerg, "line 2\n" ) );
+
+	char tag[32];
+	snprintf( tag, sizeof( tag ), " test[%d]: ", (int) getpid() );
+
+	// assert - "<PRI>Mmm dd hh:mm:ss ident[pid]: msg", PRI = local0 ( 16 * 8 ) + info ( 6 )
+	std::string msg = recv_msg( _sv[1] );
+	CPPUNIT_ASSERT( msg.compare( 0, 5, "<134>" ) == 0 );
+	CPPUNIT_ASSERT( msg.length() == 5 + 15 + strlen( tag ) + 6 );
+	CPPUNIT_ASSERT( msg.compare( 5 + 15, std::string::npos, std::string( tag ) + "line 1" ) == 0 );
+	CPPUNIT_ASSERT( msg[8] == ' ' && msg[14] == ':' && msg[17] == ':' );
+
+	msg = recv_msg( _sv[1] );
+	CPPUNIT_ASSERT( msg.compare( 0, 5, "<128>" ) == 0 );
+
+	// assert - no more messages
+	CPPUNIT_ASSERT( recv_msg( _sv[1] ).empty() );
+
+}
+
+
+void logsyslogsink_test::test_rfc5424() {
+
+	logsyslogsink sink( _sv[0], "test", logsyslogsink::rfc5424 );
+	CPPUNIT_ASSERT( wrecord( sink, priority::err, "line 1\n" ) );
+
+	char hostname[256] = "-";
+	gethostname( hostname, sizeof( hostname ) - 1 );
+
+	char tail[512];
+	snprintf( tail, sizeof( tail ), " %s test %d - - line 1", hostname, (int) getpid() );
+
+	// assert - "<PRI>1 YYYY-MM-DDThh:mm:ss.uuuuuu+hh:mm host ident pid - - msg", PRI = user ( 8 ) + err ( 3 )
+	std::string msg = recv_msg( _sv[1] );
+	CPPUNIT_ASSERT( msg.compare( 0, 6, "<11>1 " ) == 0 );
+	CPPUNIT_ASSERT( msg.length() == 6 + 32 + strlen( tail ) );
+	CPPUNIT_ASSERT( msg[6 + 10] == 'T' && msg[6 + 19] == '.' && msg[6 + 29] == ':' );
+	CPPUNIT_ASSERT( msg[6 + 26] == '+' || msg[6 + 26] == '-' );
+	CPPUNIT_ASSERT( msg.compare( 6 + 32, std::string::npos, tail ) == 0 );
+
+}
+
+
+void logsyslogsink_test::test_truncate() {
+
+	logsyslogsink sink( _sv[0], "test" );
+
+	std::string record( LOGSYSLOGSINK_MSG_SIZE * 2, 'x' );
+	CPPUNIT_ASSERT( wrecord( sink, priority::info, record.c_str() ) );
+
+	// assert
+	CPPUNIT_ASSERT( recv_msg( _sv[1] ).length() == LOGSYSLOGSINK_MSG_SIZE );
+
+	// assert - long ident truncated, the message still fits
+	std::string ident( LOGSYSLOGSINK_MSG_SIZE * 2, 'i' );
+	logsyslogsink long_sink( _sv[0], ident.c_str(), logsyslogsink::rfc5424 );
+	CPPUNIT_ASSERT( wrecord( long_sink, priority::info, "line 1\n" ) );
+
+	std::string msg = recv_msg( _sv[1] );
+	CPPUNIT_ASSERT( msg.find( " " + ident.substr( 0, 48 ) + " " ) != std::string::npos );
+	CPPUNIT_ASSERT( msg.substr( msg.length() - 6 ) == "line 1" );
+
+}
+
+
+void logsyslogsink_test::test_batch() {
+
+	logsyslogsink sink( _sv[0], "test", logsyslogsink::rfc3164, LOG_USER, 3 );
+
+	wrecord( sink, priority::info, "line 1\n" );
+	wrecord( sink, priority::info, "line 2\n" );
+
+	// assert - nothing sent until the batch is full
+	CPPUNIT_ASSERT( recv_msg( _sv[1] ).empty() );
+
+	wrecord( sink, priority::info, "line 3\n" );
+	wrecord( sink, priority::info, "line 4\n" );
+
+	// assert - one datagram per message, in order
+	for ( int i = 1; i <= 3; i++ ) {
+		std::string msg = recv_msg( _sv[1] );
+		CPPUNIT_ASSERT( msg.substr( msg.length() - 6 ) == std::string( "line " ) + (char) ( '0' + i ) );
+	}
+
+	CPPUNIT_ASSERT( recv_msg( _sv[1] ).empty() );
+
+	// flush the rest
+	CPPUNIT_ASSERT( sink.flush() );
+
+	std::string msg = recv_msg( _sv[1] );
+	CPPUNIT_ASSERT( msg.substr( msg.length() - 6 ) == "line 4" );
+	CPPUNIT_ASSERT( sink.dropped() == 0 );
+
+}
+
+
+void logsyslogsink_test::test_path() {
+
+	// syslog daemon socket
+	std::string path = testutil::temppath( "logsyslogsink_test" );
+
+	int fd = socket( AF_UNIX, SOCK_DGRAM, 0 );
+
+	sockaddr_un addr;
+	memset( &addr, 0, sizeof( addr ) );
+	addr.sun_family = AF_UNIX;
+	strcpy( addr.sun_path, path.c_str() );
+	CPPUNIT_ASSERT( bind( fd, (sockaddr *) &addr, sizeof( addr ) ) == 0 );
+
+	{
+		logsyslogsink sink( "test", logsyslogsink::rfc3164, LOG_USER, 1, path.c_str() );
+		CPPUNIT_ASSERT( wrecord( sink, priority::notice, "line 1\n" ) );
+	}
+
+	// assert - PRI = user ( 8 ) + notice ( 5 )
+	std::string msg = recv_msg( fd );
+	CPPUNIT_ASSERT( msg.compare( 0, 4, "<13>" ) == 0 );
+	CPPUNIT_ASSERT( msg.substr( msg.length() - 6 ) == "line 1" );
+
+	close( fd );
+	unlink( path.c_str() );
+
+}
+
+
+void logsyslogsink_test::test_path_fail() {
+
+	// this will throw a system error exception
+	CPPUNIT_ASSERT_THROW( logsyslogsink sink( "test", logsyslogsink::rfc3164, LOG_USER, 1,
+			"/nonexistent/logsyslogsink_test" ), logexception );
+
+	// this will throw an invalid file descriptor exception
+	CPPUNIT_ASSERT_THROW( logsyslogsink sink( -1, "test" ), logexception );
+
+}
+
+
+void logsyslogsink_test::test_logstream() {
+
+	logsyslogsink sink( _sv[0], "test" );
+
+	{
+		logstream logger( &sink );
+		logger.loglevel( priority::info );
+
+		logger << priority::warning << "warning" << std::endl;
+	}
+
+	// assert - PRI = user ( 8 ) + warning ( 4 ), log record as the message
+	std::string msg = recv_msg( _sv[1] );
+	CPPUNIT_ASSERT( msg.compare( 0, 4, "<12>" ) == 0 );
+	CPPUNIT_ASSERT( msg.substr( msg.length() - 14 ) == "[WARN] warning" );
+
+}
+
@@ -0,0 +1,61 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef LOGSYSLOGSINK_TEST_H
+#define LOGSYSLOGSINK_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+
+class logsyslogsink_test : public CppUnit::TestFixture {
+
+	// setup the test suite
+	CPPUNIT_TEST_SUITE( logsyslogsink_test );
+	CPPUNIT_TEST( test_rfc3164 );
+	CPPUNIT_TEST( test_rfc5424 );
+	CPPUNIT_TEST( test_truncate );
+	CPPUNIT_TEST( test_batch );
+	CPPUNIT_TEST( test_path );
+	CPPUNIT_TEST( test_path_fail );
+	CPPUNIT_TEST( test_logstream );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+
+	void setUp();
+	void tearDown();
+
+	void test_rfc3164();
+	void test_rfc5424();
+	void test_truncate();
+	void test_batch();
+	void test_path();
+	void test_path_fail();
+	void test_logstream();
+
+private:
+
+	int _sv[2];
+	std::string recv_msg( int fd );
+
+};
+
+#endif
+
@@ -0,0 +1,172 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "logwriter_test.h"
+#include "testutil.h"
+
+#include <logstreamxx/logwriter.h>
+#include <logstreamxx/logstreambuf.h>
+
+#include <cstdio>
+#include <ostream>
+#include <unistd.h>
+
+
+// register the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( logwriter_test );
+
+// use namespace logstreamxx
+using namespace logstreamxx;
+
+
+void logwriter_test::setUp() {
+
+	// temporary log file
+	_fd = testutil::tempfd( "logwriter_test" );
+
+}
+
+
+void logwriter_test::tearDown() {
+	close( _fd );
+}
+
+
+void logwriter_test::test_constructor_fail() {
+
+	// this will throw an invalid file descriptor exception
+	CPPUNIT_ASSERT_THROW( logwriter w( -1 ), logexception );
+
+	// this will throw an invalid queue capacity exception
+	CPPUNIT_ASSERT_THROW( logwriter w( _fd, logwriter::block, 0 ), logexception );
+
+}
+
+
+void logwriter_test::test_push() {
+
+	{
+		logwriter w( _fd );
+
+		CPPUNIT_ASSERT( w.push( "line 1\n", 7 ) );
+		CPPUNIT_ASSERT( w.push( "line 2\n", 7 ) );
+
+		// destructor writes out the queued records
+	}
+
+	// assert
+	CPPUNIT_ASSERT( "line 1\nline 2\n" == testutil::read_all( _fd ) );
+
+}
+
+
+void logwriter_test::test_push_wrap() {
+
+	// small queue to force wrapping around
+	logwriter w( _fd, logwriter::block, 10 );
+	std::string expected;
+
+	for ( int i = 0; i < 100; i++ ) {
+
+		char line[8];
+		int n = snprintf( line, sizeof( line ), "%03d\n", i );
+
+		CPPUNIT_ASSERT( w.push( line, n ) );
+		expected.append( line, n );
+
+	}
+
+	w.drain();
+
+	// assert
+	CPPUNIT_ASSERT( expected == testutil::read_all( _fd ) );
+	CPPUNIT_ASSERT( 0 == w.dropped() );
+
+}
+
+
+void logwriter_test::test_push_large() {
+
+	logwriter w( _fd, logwriter::block, 8 );
+
+	// larger than the queue capacity
+	CPPUNIT_ASSERT( w.push( "a", 1 ) );
+	CPPUNIT_ASSERT( w.push( "0123456789abcdef\n", 17 ) );
+	w.drain();
+
+	// assert
+	CPPUNIT_ASSERT( "a0123456789abcdef\n" == testutil::read_all( _fd ) );
+
+	// larger records in between queued records, handed over to the
+	// writer thread in order
+	iovec iov[2];
+	iov[0].iov_base = (void *) "0123456789";
+	iov[0].iov_len  = 10;
+	iov[1].iov_base = (void *) "ABCDEF\n";
+	iov[1].iov_len  = 7;
+
+	CPPUNIT_ASSERT( w.push( "b", 1 ) );
+	CPPUNIT_ASSERT( w.push( iov, 2 ) );
+	CPPUNIT_ASSERT( w.push( "c", 1 ) );
+	CPPUNIT_ASSERT( w.push( "fedcba9876543210\n", 17 ) );
+	CPPUNIT_ASSERT( w.push( "d", 1 ) );
+	w.drain();
+
+	// assert
+	CPPUNIT_ASSERT( "a0123456789abcdef\nb0123456789ABCDEF\ncfedcba9876543210\nd" == testutil::read_all( _fd ) );
+
+}
+
+
+void logwriter_test::test_drop() {
+
+	logwriter w( _fd, logwriter::drop, 8 );
+
+	// larger than the queue capacity, will never fit
+	CPPUNIT_ASSERT(! w.push( "0123456789abcdef\n", 17 ) );
+	w.drain();
+
+	// assert
+	CPPUNIT_ASSERT( 1 == w.dropped() );
+	CPPUNIT_ASSERT( 1 == w.overflows() );
+	CPPUNIT_ASSERT( testutil::read_all( _fd ).empty() );
+
+}
+
+
+void logwriter_test::test_logstreambuf() {
+
+	// this will throw an invalid log writer exception
+	CPPUNIT_ASSERT_THROW( logstreambuf sb( (logwriter *) 0 ), logexception );
+
+	{
+		logwriter w( _fd );
+		logstreambuf sb( &w );
+		std::ostream os( &sb );
+
+		sb.setlogmask( priority::mask::debug );
+		os << "async message" << std::endl;
+	}
+
+	// assert
+	std::string content = testutil::read_all( _fd );
+	CPPUNIT_ASSERT( content.find( "[DEBG] async message\n" ) != std::string::npos );
+
+}
+
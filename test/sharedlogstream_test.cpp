@@ -0,0 +1,260 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "sharedlogstream_test.h"
+#include "testutil.h"
+
+#include <logstreamxx/sharedlogstream.h>
+
+#include <sstream>
+#include <pthread.h>
+#include <unistd.h>
+
+
+// register the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( sharedlogstream_test );
+
+// use namespace logstreamxx
+using namespace logstreamxx;
+
+
+// number of threads and log lines per thread
+static const int threads = 8;
+static const int lines   = 500;
+
+
+static void * log_lines( void * arg ) {
+
+	sharedlogstream * logger = (sharedlogstream *) arg;
+
+	for ( int i = 0; i < lines; i++ ) {
+		*logger << priority::info << "thread " << pthread_self() << " line " << i << " of " << lines << std::endl;
+	}
+
+	return 0;
+
+}
+
+
+static void run_threads( sharedlogstream &logger ) {
+
+	pthread_t tids[threads];
+
+	for ( int i = 0; i < threads; i++ ) {
+		pthread_create( &tids[i], 0, &log_lines, &logger );
+	}
+
+	for ( int i = 0; i < threads; i++ ) {
+		pthread_join( tids[i], 0 );
+	}
+
+}
+
+
+static int count_lines( const std::string &content ) {
+
+	std::istringstream iss( content );
+	std::string line;
+	int n = 0;
+
+	while ( std::getline( iss, line ) ) {
+
+		// every line must be a complete record
+		if ( line.find( " [INFO] thread " ) != 22 ) {
+			return -1;
+		}
+
+		if ( line.find( " of 500" ) != line.length() - 7 ) {
+			return -1;
+		}
+
+		n++;
+
+	}
+
+	return n;
+
+}
+
+
+void sharedlogstream_test::setUp() {
+
+	// temporary log file
+	_filename = testutil::tempfile( "sharedlogstream_test" );
+
+}
+
+
+void sharedlogstream_test::tearDown() {
+	unlink( _filename.c_str() );
+}
+
+
+void sharedlogstream_test::test_loglevel() {
+
+	sharedlogstream logger( _filename.c_str() );
+
+	// assert - default mask only enables 'emerg'
+	CPPUNIT_ASSERT(! logger.enabled( priority::info ) );
+
+	logger.loglevel( priority::info );
+
+	// assert
+	CPPUNIT_ASSERT( logger.enabled( priority::info ) );
+	CPPUNIT_ASSERT(! logger.enabled( priority::debug ) );
+
+}
+
+
+void sharedlogstream_test::test_threads() {
+
+	{
+		sharedlogstream logger( _filename.c_str() );
+		logger.loglevel( priority::info );
+
+		run_threads( logger );
+	}
+
+	// assert
+	CPPUNIT_ASSERT_EQUAL( ( threads * lines ), count_lines( testutil::read_all( _filename ) ) );
+
+}
+
+
+void sharedlogstream_test::test_threads_async() {
+
+	{
+		sharedlogstream logger( _filename.c_str(), logwriter::block, 4096 );
+		logger.loglevel( priority::info );
+
+		run_threads( logger );
+	}
+
+	// assert
+	CPPUNIT_ASSERT_EQUAL( ( threads * lines ), count_lines( testutil::read_all( _filename ) ) );
+
+}
+
+
+static void * log_debug( void * arg ) {
+
+	sharedlogstream * logger = (sharedlogstream *) arg;
+	*logger << priority::debug << "other thread" << std::endl;
+
+	return 0;
+
+}
+
+
+void sharedlogstream_test::test_thread_priority() {
+
+	{
+		sharedlogstream logger( _filename.c_str() );
+		logger.loglevel( priority::debug );
+		logger.logprefix( "shared" );
+
+		logger << priority::warning;
+
+		// another thread changing its priority
+		pthread_t tid;
+		pthread_create( &tid, 0, &log_debug, &logger );
+		pthread_join( tid, 0 );
+
+		logger << "this thread" << std::endl;
+	}
+
+	// assert - priority set in one thread doesn't leak into another
+	std::string content = testutil::read_all( _filename );
+	CPPUNIT_ASSERT( content.find( "[DEBG] shared other thread\n" ) != std::string::npos );
+	CPPUNIT_ASSERT( content.find( "[WARN] shared this thread\n" ) != std::string::npos );
+
+}
+
+
+void sharedlogstream_test::test_logpattern() {
+
+	{
+		sharedlogstream logger( _filename.c_str() );
+		logger.loglevel( priority::debug );
+
+		CPPUNIT_ASSERT( logger.logpattern( "<%l> %x" ) );
+		CPPUNIT_ASSERT(! logger.logpattern( "%q" ) );
+
+		pthread_t tid;
+		pthread_create( &tid, 0, &log_debug, &logger );
+		pthread_join( tid, 0 );
+
+		logger << priority::info << "this thread" << std::endl;
+	}
+
+	// assert - pattern applies to all the threads
+	CPPUNIT_ASSERT_EQUAL( std::string( "<debug> other thread\n<info> this thread\n" ), testutil::read_all( _filename ) );
+
+}
+
+
+static void * log_long_lines( void * arg ) {
+
+	sharedlogstream * logger = (sharedlogstream *) arg;
+	const std::string line( 6000, 'x' );
+
+	for ( int i = 0; i < 100; i++ ) {
+		*logger << priority::info << line << std::endl;
+	}
+
+	return 0;
+
+}
+
+
+void sharedlogstream_test::test_logbuffer() {
+
+	{
+		sharedlogstream logger( _filename.c_str() );
+		logger.loglevel( priority::info );
+
+		CPPUNIT_ASSERT(! logger.logbuffer( 1 ) );
+		CPPUNIT_ASSERT( logger.logbuffer( 256, 8192 ) );
+
+		pthread_t tids[4];
+
+		for ( int i = 0; i < 4; i++ ) {
+			pthread_create( &tids[i], 0, &log_long_lines, &logger );
+		}
+
+		for ( int i = 0; i < 4; i++ ) {
+			pthread_join( tids[i], 0 );
+		}
+	}
+
+	// assert - every line is a complete record
+	std::istringstream iss( testutil::read_all( _filename ) );
+	std::string line;
+	int n = 0;
+
+	while ( std::getline( iss, line ) ) {
+		CPPUNIT_ASSERT( line.find( " [INFO] x" ) == 22 );
+		CPPUNIT_ASSERT( line.length() == ( 22 + 8 + 6000 ) );
+		n++;
+	}
+
+	CPPUNIT_ASSERT_EQUAL( 400, n );
+
+}
+
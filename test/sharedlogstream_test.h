@@ -0,0 +1,58 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef SHAREDLOGSTREAM_TEST_H
+#define SHAREDLOGSTREAM_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+
+class sharedlogstream_test : public CppUnit::TestFixture {
+
+	// setup the test suite
+	CPPUNIT_TEST_SUITE( sharedlogstream_test );
+	CPPUNIT_TEST( test_loglevel );
+	CPPUNIT_TEST( test_threads );
+	CPPUNIT_TEST( test_threads_async );
+	CPPUNIT_TEST( test_thread_priority );
+	CPPUNIT_TEST( test_logpattern );
+	CPPUNIT_TEST( test_logbuffer );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+
+	void setUp();
+	void tearDown();
+
+	void test_loglevel();
+	void test_threads();
+	void test_threads_async();
+	void test_thread_priority();
+	void test_logpattern();
+	void test_logbuffer();
+
+private:
+
+	std::string _filename;
+
+};
+
+#endif
+
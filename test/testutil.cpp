@@ -0,0 +1,89 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+#include "testutil.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+
+namespace testutil {
+
+	std::string tempfile( const char * name ) {
+
+		std::string filename = std::string( "/tmp/" ) + name + ".XXXXXX";
+		close( mkstemp( &filename[0] ) );
+
+		return filename;
+
+	}
+
+
+	std::string temppath( const char * name ) {
+
+		std::string path = tempfile( name );
+		unlink( path.c_str() );
+
+		return path;
+
+	}
+
+
+	int tempfd( const char * name ) {
+
+		std::string filename = std::string( "/tmp/" ) + name + ".XXXXXX";
+		int fd = mkstemp( &filename[0] );
+		unlink( filename.c_str() );
+
+		return fd;
+
+	}
+
+
+	std::string read_all( const std::string &filename ) {
+
+		std::ifstream ifs( filename.c_str() );
+		std::stringstream ss;
+		ss << ifs.rdbuf();
+
+		return ss.str();
+
+	}
+
+
+	std::string read_all( int fd ) {
+
+		std::string content;
+		char buffer[512];
+		ssize_t n;
+
+		lseek( fd, 0, SEEK_SET );
+		while ( ( n = read( fd, buffer, sizeof( buffer ) ) ) > 0 ) {
+			content.append( buffer, n );
+		}
+
+		return content;
+
+	}
+
+} /* end of namespace testutil */
+
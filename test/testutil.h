@@ -0,0 +1,67 @@
+/*
+*  logstreamxx - C++ logging library based on standard stream classes
+*  Copyright (C) 2013 Uditha Atukorala
+*
+*  This software library is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This software library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public License
+*  along with this software library. If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+#ifndef TESTUTIL_H
+#define TESTUTIL_H
+
+#include <string>
+
+
+namespace testutil {
+
+	/**
+	*   @brief create an empty temporary file
+	*   @param name file name prefix ( under /tmp )
+	*   @return temporary file name
+	*/
+	std::string tempfile( const char * name );
+
+	/**
+	*   @brief get a unique temporary path which doesn't exist
+	*   @param name file name prefix ( under /tmp )
+	*   @return temporary path ( e.g. for a socket )
+	*/
+	std::string temppath( const char * name );
+
+	/**
+	*   @brief open an unlinked temporary file
+	*   @param name file name prefix ( under /tmp )
+	*   @return file descriptor, open for reading and writing
+	*/
+	int tempfd( const char * name );
+
+	/**
+	*   @brief read a file
+	*   @param filename file name
+	*   @return file content
+	*/
+	std::string read_all( const std::string &filename );
+
+	/**
+	*   @brief read a file from the beginning
+	*   @param fd file descriptor
+	*   @return file content
+	*/
+	std::string read_all( int fd );
+
+} /* end of namespace testutil */
+
+#endif
+